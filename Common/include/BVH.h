@@ -0,0 +1,62 @@
+// Hierarquia de volumes envolventes (AABB) sobre os objetos da cena. A construo usa a heurstica
+// de rea de superfcie (SAH) com binning; os objetos de cada n ficam contguos em objectIds, de
+// forma que um n inteiramente dentro do frustum entrega todos os seus objetos sem descer na rvore.
+// Objetos que se movem so atualizados com update(), que reajusta (refit) s as caixas dos
+// ancestrais da folha; a topologia no muda, ento depois de muito movimento vale reconstruir.
+
+#pragma once
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+
+using namespace std;
+
+struct BVHNode
+{
+	AABB box;
+	int left;   // filho esquerdo (o direito  left + 1); -1 numa folha
+	int parent;
+	int first;  // faixa dos objetos da subrvore em objectIds
+	int count;
+};
+
+class BVH
+{
+public:
+	static const int MAX_LEAF_OBJECTS = 4;
+	static const int SAH_BINS = 16;
+
+	void build(const vector<AABB>& boxes);
+	// Troca a caixa de um objeto e reajusta os ancestrais da folha dele
+	void update(int object, const AABB& box);
+	// Reajusta todas as caixas a partir de objectBoxes (depois de mover muitos objetos)
+	void refit();
+	void refit(const vector<AABB>& boxes);
+
+	// Objetos cuja caixa no est inteiramente fora de algum dos planos (normais para dentro)
+	void queryFrustum(const glm::vec4 planes[6], vector<int>& objects) const;
+	// Objeto mais prximo cuja caixa  atingida pelo raio; devolve -1 se nenhum
+	int raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& distance) const;
+	// Objetos cuja caixa intersecta a esfera
+	void querySphere(const glm::vec3& center, float radius, vector<int>& objects) const;
+
+	int getNbNodes() const { return nodes.size(); }
+	int getNbObjects() const { return objectBoxes.size(); }
+	int getDepth() const;
+	const AABB& getObjectBox(int object) const { return objectBoxes[object]; }
+protected:
+	void subdivide(int node, vector<glm::vec3>& centroids);
+	void fitNode(int node);
+	static float surfaceArea(const AABB& box);
+	static AABB merge(const AABB& a, const AABB& b);
+	static bool raySlab(const AABB& box, const glm::vec3& origin, const glm::vec3& inverse, float maxDistance, float& entry);
+
+	vector<BVHNode> nodes;
+	vector<int> objectIds;  // permutao dos objetos, agrupados por n
+	vector<int> leafOf;     // folha de cada objeto
+	vector<AABB> objectBoxes;
+};
@@ -0,0 +1,72 @@
+// Modo de benchmark: um nmero fixo de quadros de aquecimento seguido dos quadros medidos, com
+// passo de tempo fixo (a animao no depende do relgio). Para cada quadro medido so guardados o
+// tempo de CPU (do incio do quadro at a submisso do ltimo comando), o intervalo entre quadros,
+// o tempo de GPU (par de glQueryCounter com GL_TIMESTAMP, lido alguns quadros depois para no
+// bloquear a CPU), os draw calls e os tringulos. O relatrio tem mdia, p50, p95 e p99 e 
+// gravado em JSON para acompanhar a evoluo entre verses.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <ostream>
+
+//GLAD
+#include <glad/glad.h>
+
+using namespace std;
+
+class Benchmark
+{
+public:
+	struct Summary
+	{
+		double mean, p50, p95, p99, min, max;
+	};
+
+	Benchmark(int warmupFrames, int measuredFrames, double timestep = 1.0 / 60.0);
+	~Benchmark();
+
+	void beginFrame();
+	// triangles < 0 quando a contagem no  conhecida na CPU (por exemplo, descarte na GPU)
+	void endFrame(int drawCalls, long long triangles);
+	// L os tempos de GPU que faltam (espera a GPU terminar)
+	void finish();
+
+	bool isWarmingUp() { return frame < warmupFrames; }
+	bool isDone() { return frame >= warmupFrames + measuredFrames; }
+	int getFrame() { return frame; }
+	// Tempo simulado do quadro atual e progresso (0 a 1) entre os quadros medidos
+	double getTime() { return frame * timestep; }
+	float getProgress();
+
+	// Extras gravados em "config" no JSON (cena, caminho de desenho, etc.)
+	void setConfig(const string& key, const string& value);
+	void setConfig(const string& key, long long value);
+
+	static Summary summarize(vector<double> values);
+	void print();
+	bool writeJSON(const string& path);
+protected:
+	static void writeSummary(ostream& out, const string& name, const vector<double>& values);
+	static string escape(const string& text);
+	// L o par de timestamps do slot, se o resultado j estiver disponvel (ou esperando por ele)
+	bool collectGPU(int slot, bool wait);
+
+	static const int QUERY_FRAMES = 4;
+
+	int warmupFrames, measuredFrames, frame;
+	double timestep;
+	chrono::steady_clock::time_point frameStart, lastFrameStart;
+	bool hasLastFrame;
+
+	vector<double> cpuMs, frameMs, gpuMs, drawCalls, triangles;
+	bool trianglesKnown;
+	vector<pair<string, string> > config;
+
+	// Timestamps do incio e do fim de cada um dos ltimos quadros (um par por quadro em voo)
+	GLuint queries[QUERY_FRAMES][2];
+	int queryFrame[QUERY_FRAMES];   // quadro medido a que o par pertence, -1 se livre
+	bool gpuTiming;
+};
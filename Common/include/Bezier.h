@@ -5,6 +5,8 @@ class Bezier :
 {
 public:
     Bezier();
-    void generateCurve(int pointsPerSegment);
+protected:
+    // Segmento i: pontos de controle P(3i) a P(3i + 3)
+    glm::mat4x3 getGeometry(int first);
 };
 
@@ -0,0 +1,44 @@
+// Volumes envolventes usados no descarte de objetos: caixa alinhada aos eixos (AABB) e esfera.
+// Os dois so calculados uma vez no espao do modelo, a partir dos vrtices da malha, e levados
+// para o espao do mundo com a matriz model de cada objeto.
+
+#pragma once
+
+#include <vector>
+
+//GLAD
+#include <glad/glad.h>
+
+//GLM
+#include <glm/glm.hpp>
+
+using namespace std;
+
+struct AABB
+{
+	glm::vec3 min = glm::vec3(0.0f);
+	glm::vec3 max = glm::vec3(0.0f);
+
+	glm::vec3 center() const { return (min + max) * 0.5f; }
+	glm::vec3 extents() const { return (max - min) * 0.5f; }
+	// Caixa que envolve esta depois de transformada (continua alinhada aos eixos)
+	AABB transformed(const glm::mat4& model) const;
+};
+
+struct BoundingSphere
+{
+	glm::vec3 center = glm::vec3(0.0f);
+	float radius = 0.0f;
+
+	BoundingSphere transformed(const glm::mat4& model) const;
+};
+
+struct MeshBounds
+{
+	AABB box;
+	BoundingSphere sphere;
+
+	// vertices: stride floats por vrtice, com a posio nos trs primeiros
+	static MeshBounds fromVertices(const GLfloat* vertices, size_t nbVertices, int stride);
+	static MeshBounds fromVertices(const vector<GLfloat>& vertices, int stride);
+};
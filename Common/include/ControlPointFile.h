@@ -0,0 +1,109 @@
+// Arquivo binrio de pontos de controle (.cpb), para caminhos gravados (cmera, veculos) com
+// milhes de pontos. Um cabealho de 32 bytes (ControlPointHeader) seguido dos pontos como x, y, z
+// em float (little-endian), sem separadores: o ponto k est no byte 32 + 12 k, ento o arquivo pode
+// ser mapeado na memria e usado direto, sem parse nem cpia.
+//
+// A leitura  por janelas de segmentos (o segmento i usa os pontos 3i a 3i + 3, como em Bezier e
+// Hermite): window() devolve um ponteiro para dentro do mapeamento, e o sistema s carrega as
+// pginas tocadas. Na leitura sequencial (nextWindow) as pginas j percorridas so devolvidas, de
+// forma que a memria residente fica em torno de uma janela, qualquer que seja o tamanho do
+// arquivo. Sem mapeamento (mmap ou CreateFileMapping falharam) as janelas so lidas com fread.
+//
+// importText converte o formato texto antigo (um ponto "x y z" por linha, como curvePoints.txt)
+// lendo em blocos e gravando em blocos, sem guardar o arquivo inteiro na memria.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "CurveEvaluator.h"
+
+using namespace std;
+
+struct ControlPointHeader
+{
+	char magic[4];          // "CPTS"
+	uint32_t version;       // 1
+	uint32_t pointSize;     // bytes por ponto (12)
+	uint32_t flags;         // reservado (0)
+	uint64_t nbPoints;
+	uint64_t reserved;
+};
+
+// Trecho de segmentos consecutivos; os pontos s valem at a prxima chamada de window/nextWindow
+struct SegmentWindow
+{
+	long long firstSegment;
+	int nbSegments;
+	// 3 * nbSegments + 1 pontos; o segmento firstSegment + i usa points[3i] a points[3i + 3]
+	const glm::vec3* points;
+
+	// Coeficientes do segmento i da janela, com a base que leva os pontos aos coeficientes
+	// (Curve::getPointBasis)
+	CurveSegment getSegment(int i, const glm::mat4& pointBasis) const;
+};
+
+class ControlPointFile
+{
+public:
+	static const uint32_t VERSION = 1;
+
+	ControlPointFile() : file(NULL), mapping(NULL), mappingSize(0), nbPoints(0), cursor(0), released(0)
+#ifdef _WIN32
+		, fileHandle(NULL), mappingHandle(NULL)
+#endif
+	{}
+	~ControlPointFile() { close(); }
+	ControlPointFile(const ControlPointFile&) = delete;
+	ControlPointFile& operator=(const ControlPointFile&) = delete;
+
+	static bool write(const string& path, const vector<glm::vec3>& points);
+	// Converte o arquivo texto; devolve o nmero de pontos gravados, ou -1 se no der para ler ou gravar
+	static long long importText(const string& textPath, const string& binaryPath);
+	// S importa se o binrio no existe ou  mais antigo que o texto
+	static bool importIfNewer(const string& textPath, const string& binaryPath);
+
+	bool open(const string& path);
+	void close();
+	bool isOpen() { return mapping != NULL || file != NULL; }
+	bool isMapped() { return mapping != NULL; }
+
+	long long getNbPoints() { return nbPoints; }
+	long long getNbSegments() { return nbPoints < 4 ? 0 : (nbPoints - 1) / 3; }
+
+	// Janela com nbSegments segmentos a partir de firstSegment (menos, no fim do arquivo)
+	bool window(long long firstSegment, int nbSegments, SegmentWindow& out);
+	// Leitura sequencial: cada chamada devolve os prximos nbSegments segmentos
+	void rewind();
+	bool nextWindow(int nbSegments, SegmentWindow& out);
+
+	// Ponto no parmetro global u (segmento + t local), lendo s os 4 pontos do segmento
+	glm::vec3 evaluate(double u, const glm::mat4& pointBasis);
+	// Copia todos os pontos (para curvas que cabem na memria)
+	void readAll(vector<glm::vec3>& points);
+protected:
+	// Devolve ao sistema as pginas do mapeamento antes do ponto dado
+	void releaseBefore(long long point);
+	const glm::vec3* pointsAt(long long first, long long count);
+
+	// Sem mapeamento
+	FILE* file;
+	vector<glm::vec3> windowBuffer;
+
+	const char* mapping;
+	size_t mappingSize;
+	long long nbPoints;
+	// Prximo segmento de nextWindow e primeiro byte ainda no devolvido
+	long long cursor;
+	size_t released;
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#endif
+};
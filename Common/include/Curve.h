@@ -10,23 +10,114 @@
 
 #include "Shader.h"
 
+#include "CurveEvaluator.h"
+
 using namespace std;
 
 class Curve
 {
 public:
-	Curve() {}
-	inline void setControlPoints(vector <glm::vec3> controlPoints) { this->controlPoints = controlPoints; }
+	Curve() : arcIntervals(0), arcLutSize(0), VAO(0), VBO(0), vboCapacity(0), shader(NULL) {}
+	virtual ~Curve() {}
+	// Os coeficientes dos segmentos so recalculados aqui; a avaliao no depende de generateCurve.
+	// A tabela de comprimento de arco, se existir,  refeita com a mesma resoluo; os pontos
+	// amostrados s voltam a valer (e a ser editados por moveControlPoint) depois de gerar a curva
+	void setControlPoints(vector <glm::vec3> controlPoints);
 	void setShader(Shader* shader);
+	// Amostra cada segmento com pointsPerSegment + 1 pontos (t = k / pointsPerSegment), substituindo
+	// os pontos atuais, e envia para o VBO; s  necessrio para desenhar a curva (para animao,
+	// ver evaluate)
 	void generateCurve(int pointsPerSegment);
+	// Tesselao adaptativa (substitui os pontos atuais): cada segmento  dividido at a poligonal
+	// ficar a menos de tolerance da curva, em unidades do mundo, ou a menos de pixelTolerance na
+	// tela para a view-projection e o viewport dados (refazer quando a cmera mudar). Cada chamada
+	// reenvia os pontos ao VBO; para um detalhe que acompanha a cmera a cada quadro, GPUCurve
+	// (backend de tesselao) faz a mesma escolha na GPU sem enviar vrtices
+	void generateCurveAdaptive(float tolerance);
+	void generateCurveAdaptive(float pixelTolerance, const glm::mat4& viewProjection, int width, int height);
+	// Edio interativa: move o ponto de controle k e recalcula s os segmentos que dependem dele
+	// (um, ou dois num ponto de juno), com a mesma tesselao da ltima gerao. Se o nmero de
+	// pontos desses segmentos no mudar, s o trecho deles  reenviado ao VBO; seno, do primeiro
+	// deles at o fim. A tabela de comprimento de arco, se existir, tambm  atualizada
+	void moveControlPoint(int k, const glm::vec3& p);
+	int getNbControlPoints() { return controlPoints.size(); }
+	glm::vec3 getControlPoint(int k) { return controlPoints[k]; }
+	const vector<glm::vec3>& getControlPoints() { return controlPoints; }
+	// Matriz W que leva os 4 pontos de controle do segmento direto aos coeficientes, C = P * W (para
+	// avaliar na GPU s a partir dos pontos); igual a M quando G so os prprios pontos
+	virtual glm::mat4 getPointBasis() { return M; }
 	void drawCurve(glm::vec4 color);
 	int getNbCurvePoints() { return curvePoints.size(); }
+	// Buffer com os pontos amostrados (0 antes da primeira gerao)
+	GLuint getVBO() { return VBO; }
 	glm::vec3 getPointOnCurve(int i) { return curvePoints[i]; }
+	int getNbSegments() { return segments.size(); }
+
+	// Avaliao direta pelos coeficientes, sem os pontos amostrados (memria O(segmentos)). O
+	// parmetro global u vai de 0 a getNbSegments(): a parte inteira  o segmento e a fracionria o
+	// t dentro dele; as derivadas so em relao a u
+	glm::vec3 evaluate(float u);
+	glm::vec3 derivative(float u);
+	glm::vec3 secondDerivative(float u);
+
+	// Tabela de comprimento de arco: cada segmento  dividido em intervalsPerSegment intervalos
+	// de t, cujos comprimentos (Gauss-Legendre) so acumulados. Com lutSize > 0 tambm  montada
+	// uma tabela uniforme em distncia, que troca a busca binria por um acesso direto
+	void buildArcLengthTable(int intervalsPerSegment = 8, int lutSize = 0);
+	float getLength() { return arcLengths.empty() ? 0.0f : arcLengths.back(); }
+	// Parmetro global u (segmento + t local) a uma distncia s do incio, com s em [0, getLength()]
+	float parameterAtDistance(float s);
+	glm::vec3 pointAtDistance(float s);
+	// Posio depois de time segundos a speed unidades por segundo; com loop, volta ao incio
+	glm::vec3 pointAtTime(float time, float speed, bool loop = true);
+	const vector<CurveSegment>& getSegments() { return segments; }
 protected:
+	// Matriz de geometria G do segmento que comea no ponto de controle first
+	virtual glm::mat4x3 getGeometry(int first) = 0;
+	// Recalcula os coeficientes G * M de todos os segmentos
+	void updateSegments();
+	// Como curvePoints foi gerado, para refazer s os segmentos editados
+	struct Tessellation
+	{
+		int pointsPerSegment;       // passo fixo; 0 na tesselao adaptativa
+		float tolerance;
+		bool screen;                // tolerncia em pixels, com a view-projection e o viewport abaixo
+		glm::mat4 viewProjection;
+		glm::vec2 viewport;
+	};
+	// Tessela todos os segmentos com a configurao atual e envia tudo para o VBO
+	void tessellateCurve();
+	// Acrescenta a out os pontos de um segmento (na adaptativa, sem repetir o ponto de juno)
+	void tessellateSegment(int segment, vector<glm::vec3>& out);
+	// Refaz os pontos dos segmentos [first, last] dentro de curvePoints
+	void retessellate(int first, int last);
+	// Envia ao VBO os pontos [first, last) de curvePoints (o VBO e o VAO so criados na primeira vez)
+	void uploadCurve(size_t first, size_t last);
+	// Remede os intervalos dos segmentos [first, last] e desloca as distncias dos seguintes
+	void updateArcLengths(int first, int last);
+	void buildArcLengthLut(int lutSize);
+	// Busca binria na tabela e refinamento por Newton dentro do intervalo
+	float searchArcLength(float s);
+	// Segmento e t local do parmetro global u (limitado ao intervalo da curva)
+	int locate(float u, float& t);
+
 	vector <glm::vec3> controlPoints;
 	vector <glm::vec3> curvePoints;
+	// ndice em curvePoints do primeiro ponto de cada segmento, mais o fim
+	vector <int> segmentStarts;
+	Tessellation tessellation;
+	vector <glm::vec3> editPoints;
+	vector <float> tessellationParams;
+	vector <CurveSegment> segments;
+	// Pares (u, distncia acumulada) da tabela de comprimento de arco, e a tabela uniforme (u por distncia)
+	vector <float> arcParams, arcLengths;
+	vector <float> arcLut;
+	// Resoluo pedida em buildArcLengthTable (0 se nunca foi montada)
+	int arcIntervals, arcLutSize;
 	glm::mat4 M; //Matriz de base
-	GLuint VAO;
+	GLuint VAO, VBO;
+	// Pontos que cabem no VBO sem realocar
+	size_t vboCapacity;
 	Shader* shader;
 };
 
@@ -0,0 +1,98 @@
+// Avaliao em lote de muitas curvas (por exemplo, os caminhos de milhares de objetos animados).
+// Os coeficientes dos segmentos (ver CurveEvaluator) ficam em estrutura de arrays entre curvas:
+// as curvas so agrupadas em blocos de LANES, e cada um dos 12 componentes (a.x, a.y, ..., d.z) de
+// um segmento ocupa LANES floats seguidos, um por curva; o mesmo segmento de todos os blocos fica
+// contguo. Com o mesmo u para todas as curvas (e o mesmo nmero de segmentos num bloco), a
+// memria  lida em sequncia e os LANES pontos saem de um Horner SIMD (um registrador AVX ou
+// dois SSE).
+//
+// Quando cada curva est num segmento diferente (um u por curva), a leitura  aleatria e
+// limitada pela memria, e os 12 componentes de um segmento estariam espalhados por 384 bytes;
+// para esse caso h tambm uma cpia em AoS, curva aps curva, e cada ponto sai dela direto, por
+// Horner escalar. A o lote no ganha de avaliar uma curva por vez ( o mesmo clculo, mais o teste
+// do segmento comum: em Microbench::batch, 1,2 a 1,4 ms contra 1,1 ms), e juntar os segmentos em
+// registradores para um Horner SIMD custa mais do que economiza. O ganho s vem quando as curvas
+// de um bloco caem no mesmo segmento (fases prximas: 0,4 a 0,5 ms contra 0,9 ms). Os
+// valores de u numa mesma curva (evaluateCurve) so avaliados de LANES em LANES, com os
+// coeficientes transpostos em registradores.
+//
+// O parmetro  normalizado: u em [0, 1] percorre a curva inteira, qualquer que seja o nmero de
+// segmentos dela. O trabalho  dividido em faixas, uma por thread, nas threads do WorkerPool
+// compartilhado (como em OcclusionCuller), s quando h blocos suficientes para compensar.
+
+#pragma once
+
+#include <vector>
+#include <functional>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "CurveEvaluator.h"
+
+using namespace std;
+
+class CurveBatch
+{
+public:
+	static const int LANES = 8;
+
+	// nbThreads = 0 usa os ncleos disponveis
+	CurveBatch(int nbThreads = 0);
+	void setThreads(int nbThreads);
+	int getNbThreads() const { return nbThreads; }
+
+	// Adiciona uma curva pelos coeficientes dos segmentos (Curve::getSegments, CurveT::segment);
+	// devolve o ndice dela
+	int addCurve(const vector<CurveSegment>& segments);
+	// Substitui os segmentos de uma curva j adicionada
+	void setCurve(int curve, const vector<CurveSegment>& segments);
+	void clear();
+	int getNbCurves() const { return firstSegments.size() - 1; }
+	int getNbSegments(int curve) const { return firstSegments[curve + 1] - firstSegments[curve]; }
+
+	// Mesmo u para todas as curvas: out[i]  o ponto da curva i
+	void evaluate(float u, glm::vec3* out) const;
+	// Um u por curva (objetos em fases diferentes do caminho): out[i]  a curva i em us[i]
+	void evaluate(const float* us, glm::vec3* out) const;
+	// n valores de u numa mesma curva
+	void evaluateCurve(int curve, const float* us, int n, glm::vec3* out) const;
+
+	static int getSimdWidth();
+protected:
+	// Componentes por segmento (a, b, c e d, com x, y e z cada)
+	static const int COMPONENTS = 12;
+
+	// Avalia as curvas dos blocos [firstBlock, lastBlock), com u[i] = us[i * usStride]
+	void evaluateBlocks(int firstBlock, int lastBlock, const float* us, int usStride, glm::vec3* out) const;
+	// Avalia os grupos [firstGroup, lastGroup) de LANES valores de us numa curva
+	void evaluateGroups(int curve, int firstGroup, int lastGroup, const float* us, int n, glm::vec3* out) const;
+	// Segmento e t de u para uma curva de nbSegments segmentos
+	static int locate(float u, int nbSegments, float& t);
+	// Escreve os 12 componentes do segmento na lane de um bloco
+	static void gatherLane(const CurveSegment& segment, int lane, float* lanes);
+	// Horner de LANES pontos; coefficients tem os 12 componentes, LANES floats cada
+	static void hornerLanes(const float* coefficients, const float* t, float* x, float* y, float* z);
+	// Horner de LANES pontos, cada um de um segmento da cpia em AoS
+	static void hornerSegments(const CurveSegment* const* segments, const float* t, float* x, float* y, float* z);
+	// Divide [0, count) em faixas contguas, uma por thread
+	void parallelFor(int count, function<void(int, int)> work) const;
+
+	// Garante espao para nbBlocks blocos de nbSegments segmentos, reorganizando o array se preciso
+	void reserve(int nbBlocks, int nbSegments);
+	float* blockAt(int segment, int block) { return &coefficients[((size_t)segment * blockCapacity + block) * COMPONENTS * LANES]; }
+	const float* blockAt(int segment, int block) const { return &coefficients[((size_t)segment * blockCapacity + block) * COMPONENTS * LANES]; }
+
+	int nbThreads;
+	// [segmento][bloco][componente][lane]: o mesmo segmento de todos os blocos fica contguo, ento
+	// avaliar todas as curvas no mesmo u l a memria em sequncia; segmentos alm do fim de uma
+	// curva so zeros
+	vector<float> coefficients;
+	int blockCapacity, maxSegments;
+	// Cpia em AoS, curva aps curva (a curva i comea em firstSegments[i])
+	vector<CurveSegment> segments;
+	vector<int> firstSegments;
+	CurveSegment zero;
+	// Por bloco: nmero de segmentos comum a todas as curvas dele, ou 0 se elas diferem
+	vector<int> uniformCounts;
+};
@@ -0,0 +1,92 @@
+// Avaliao de segmentos cbicos a partir dos coeficientes do polinmio: G * M  calculado uma vez
+// por segmento (em vez de montar G e multiplicar G * M * T a cada amostra) e o ponto sai por
+// Horner, p(t) = ((a t + b) t + c) t + d. O parmetro de cada amostra vem do ndice inteiro,
+// t = k / n, ento no h erro acumulado e o fim do segmento (t = 1)  sempre includo.
+//
+// H trs formas de gerar as n + 1 amostras de um segmento: Horner escalar, diferenas
+// progressivas (trs somas por amostra, em double para no acumular erro) e SIMD, que avalia 8
+// amostras por vez com AVX (FMA quando o compilador gera FMA: /arch:AVX2, -mavx2 -mfma) ou 4 com
+// SSE. No SIMD a sada  tratada como um array de floats: um bloco de 8 amostras so 24 floats,
+// exatamente 3 registradores, cada um com o padro de componentes (x, y, z) e de t j montado,
+// de forma que os pontos so gravados direto no formato do VBO, sem transposio.
+//
+// A tesselao adaptativa converte o segmento para a forma de Bezier e o divide ao meio (de
+// Casteljau) at os dois pontos de controle internos ficarem a menos da tolerncia da corda; como
+// a curva fica dentro do fecho convexo dos pontos de controle, a poligonal tambm fica a menos da
+// tolerncia da curva. A tolerncia pode ser em unidades do mundo ou em pixels, medida depois de
+// projetar os pontos de controle com a view-projection e o viewport (aproximao: a projeo
+// perspectiva de uma cbica no  exatamente uma cbica, mas o erro some com a subdiviso). Na
+// tela, um trecho com os quatro pontos de controle fora de um mesmo plano do frustum (ou atrs do
+// olho) vira uma aresta s, e um trecho que cruza o plano do olho  dividido s at
+// NEAR_PLANE_DEPTH.
+
+#pragma once
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+using namespace std;
+
+struct CurveSegment
+{
+	// Coeficientes de t^3, t^2, t e 1
+	glm::vec3 a, b, c, d;
+};
+
+class CurveEvaluator
+{
+public:
+	// G * M, com M na conveno de Curve (T = (t^3, t^2, t, 1))
+	static CurveSegment coefficients(const glm::mat4x3& G, const glm::mat4& M);
+
+	static glm::vec3 point(const CurveSegment& s, float t) { return ((s.a * t + s.b) * t + s.c) * t + s.d; }
+	static glm::vec3 derivative(const CurveSegment& s, float t) { return (s.a * (3.0f * t) + s.b * 2.0f) * t + s.c; }
+	static glm::vec3 secondDerivative(const CurveSegment& s, float t) { return s.a * (6.0f * t) + s.b * 2.0f; }
+	// Comprimento do trecho [t0, t1] por Gauss-Legendre de 5 pontos (exato at grau 9 no integrando)
+	static float arcLength(const CurveSegment& s, float t0, float t1);
+
+	// Grava n + 1 amostras (t = 0, 1/n, ..., 1) em out; evaluate() usa o caminho mais rpido para a
+	// largura compilada: SIMD com AVX, diferenas progressivas com SSE ou sem SIMD
+	static void evaluate(const CurveSegment& s, int n, glm::vec3* out);
+	static void evaluateHorner(const CurveSegment& s, int n, glm::vec3* out);
+	static void evaluateForward(const CurveSegment& s, int n, glm::vec3* out);
+	static void evaluateSimd(const CurveSegment& s, int n, glm::vec3* out);
+
+	// Amostras por iterao do caminho SIMD (8, 4 ou 1)
+	static int getSimdWidth();
+
+	// Limite de divises: no mximo 2^MAX_DEPTH arestas por segmento
+	static const int MAX_DEPTH = 16;
+	// Limite para os trechos que cruzam o plano do olho (w = 0), que no podem ser medidos em pixels
+	static const int NEAR_PLANE_DEPTH = 6;
+
+	// Acrescenta a params os parmetros t dos vrtices da tesselao adaptativa, de 0 a 1
+	static void tessellate(const CurveSegment& s, float tolerance, vector<float>& params);
+	static void tessellate(const CurveSegment& s, float pixelTolerance, const glm::mat4& viewProjection, const glm::vec2& viewport,
+		vector<float>& params);
+	// Maior distncia entre a curva e a poligonal dada pelos parmetros (em pixels, na segunda forma,
+	// s nos pontos da curva dentro do frustum)
+	static float chordError(const CurveSegment& s, const vector<float>& params);
+	static float chordError(const CurveSegment& s, const vector<float>& params, const glm::mat4& viewProjection, const glm::vec2& viewport);
+protected:
+	struct Projection
+	{
+		bool enabled;
+		glm::mat4 viewProjection;
+		glm::vec2 viewport;
+	};
+
+	// Bit de clipCode para w <= 0 (atrs do olho); os demais so os seis planos do frustum
+	static const int BEHIND = 64;
+
+	// Planos de recorte de que o ponto (coordenadas de recorte) est do lado de fora, um bit cada
+	static int clipCode(const glm::vec4& clip);
+	// Posio usada para medir distncias; false se o ponto est atrs da cmera
+	static bool measured(const Projection& projection, const glm::vec3& p, glm::vec3& out);
+	static float distanceToSegment(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b);
+	static void subdivide(const glm::vec3 B[4], float t0, float t1, int depth, float tolerance, const Projection& projection,
+		vector<float>& params);
+	static float chordError(const CurveSegment& s, const vector<float>& params, const Projection& projection);
+};
@@ -0,0 +1,208 @@
+// Curvas cbicas com a base fixada em tempo de compilao: CurveT<Base> guarda s os pontos de
+// controle, e os pesos da base so funes constexpr, de forma que o compilador dobra as
+// constantes e cada avaliao vira poucas multiplicaes sem lao, sem chamadas virtuais e sem
+// montar G nem multiplicar por uma matriz M em tempo de execuo (como em Curve).
+//
+// Cada base d weight(potncia, ponto): o coeficiente de t^(3 - potncia) para o ponto de controle
+// i do segmento, na mesma conveno de Curve (T = (t^3, t^2, t, 1)), e STEP, o avano entre
+// segmentos: 3 em Bezier e Hermite (segmentos que compartilham s o ponto de juno), 1 nas
+// splines (Catmull-Rom, cardinal, B-spline uniforme). Na Hermite as tangentes vm dos pontos como
+// em Hermite.cpp (P1 - P0 e P2 - P3), j embutidas nos pesos. Cardinal<N, D> usa tenso
+// s = N / D (parmetros inteiros: C++14 no aceita float como parmetro de template).
+//
+// AnyCurve apaga o tipo da base para quando a escolha s  conhecida em tempo de execuo.
+
+#pragma once
+
+#include <vector>
+#include <memory>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "CurveEvaluator.h"
+
+using namespace std;
+
+struct BezierBasis
+{
+	static const int STEP = 3;
+	static constexpr float weight(int power, int point)
+	{
+		constexpr float w[16] = { -1, 3, -3, 1,   3, -6, 3, 0,   -3, 3, 0, 0,   1, 0, 0, 0 };
+		return w[power * 4 + point];
+	}
+};
+
+struct HermiteBasis
+{
+	static const int STEP = 3;
+	static constexpr float weight(int power, int point)
+	{
+		constexpr float w[16] = { 1, 1, 1, -3,   -1, -2, -1, 4,   -1, 1, 0, 0,   1, 0, 0, 0 };
+		return w[power * 4 + point];
+	}
+};
+
+template <int Numerator, int Denominator>
+struct CardinalBasis
+{
+	static const int STEP = 1;
+	static constexpr float weight(int power, int point)
+	{
+		constexpr float s = (float)Numerator / Denominator;
+		constexpr float w[16] = { -s, 2 - s, s - 2, s,   2 * s, s - 3, 3 - 2 * s, -s,   -s, 0, s, 0,   0, 1, 0, 0 };
+		return w[power * 4 + point];
+	}
+};
+
+// Catmull-Rom  a cardinal com s = 1/2
+typedef CardinalBasis<1, 2> CatmullRomBasis;
+
+struct BSplineBasis
+{
+	static const int STEP = 1;
+	static constexpr float weight(int power, int point)
+	{
+		constexpr float w[16] = { -1, 3, -3, 1,   3, -6, 3, 0,   -3, 0, 3, 0,   1, 4, 1, 0 };
+		return w[power * 4 + point] / 6.0f;
+	}
+};
+
+template <class Basis>
+class CurveT
+{
+public:
+	CurveT() {}
+	CurveT(const vector<glm::vec3>& controlPoints) : controlPoints(controlPoints) {}
+
+	void setControlPoints(const vector<glm::vec3>& controlPoints) { this->controlPoints = controlPoints; }
+	const vector<glm::vec3>& getControlPoints() const { return controlPoints; }
+
+	int getNbSegments() const
+	{
+		int n = controlPoints.size();
+		return n >= 4 ? (n - 4) / Basis::STEP + 1 : 0;
+	}
+
+	// Coeficientes do segmento (para usar com CurveEvaluator)
+	CurveSegment segment(int i) const
+	{
+		const glm::vec3* p = &controlPoints[i * Basis::STEP];
+		CurveSegment s;
+		s.a = combine<0>(p);
+		s.b = combine<1>(p);
+		s.c = combine<2>(p);
+		s.d = combine<3>(p);
+		return s;
+	}
+
+	// Parmetro global u de 0 a getNbSegments(), como em Curve
+	glm::vec3 evaluate(float u) const
+	{
+		float t;
+		const glm::vec3* p = locate(u, t);
+
+		float t2 = t * t, t3 = t2 * t;
+		return p[0] * blend<0>(t, t2, t3) + p[1] * blend<1>(t, t2, t3) + p[2] * blend<2>(t, t2, t3) + p[3] * blend<3>(t, t2, t3);
+	}
+
+	glm::vec3 derivative(float u) const
+	{
+		float t;
+		const glm::vec3* p = locate(u, t);
+
+		float t2 = t * t;
+		return p[0] * slope<0>(t, t2) + p[1] * slope<1>(t, t2) + p[2] * slope<2>(t, t2) + p[3] * slope<3>(t, t2);
+	}
+
+	// pointsPerSegment + 1 pontos por segmento (t = k / pointsPerSegment), acrescentados a out
+	void sample(int pointsPerSegment, vector<glm::vec3>& out) const
+	{
+		int nbSegments = getNbSegments();
+		size_t first = out.size();
+		out.resize(first + (size_t)nbSegments * (pointsPerSegment + 1));
+
+		// Muitas amostras por segmento: vale calcular os coeficientes e usar CurveEvaluator::evaluate
+		for (int s = 0; s < nbSegments; s++)
+			CurveEvaluator::evaluate(segment(s), pointsPerSegment, &out[first + (size_t)s * (pointsPerSegment + 1)]);
+	}
+protected:
+	template <int Power>
+	static glm::vec3 combine(const glm::vec3* p)
+	{
+		return p[0] * Basis::weight(Power, 0) + p[1] * Basis::weight(Power, 1) + p[2] * Basis::weight(Power, 2) + p[3] * Basis::weight(Power, 3);
+	}
+
+	// Funo de base do ponto Point e sua derivada
+	template <int Point>
+	static float blend(float t, float t2, float t3)
+	{
+		return Basis::weight(0, Point) * t3 + Basis::weight(1, Point) * t2 + Basis::weight(2, Point) * t + Basis::weight(3, Point);
+	}
+
+	template <int Point>
+	static float slope(float t, float t2)
+	{
+		return 3.0f * Basis::weight(0, Point) * t2 + 2.0f * Basis::weight(1, Point) * t + Basis::weight(2, Point);
+	}
+
+	const glm::vec3* locate(float u, float& t) const
+	{
+		int nbSegments = getNbSegments();
+		int segment = glm::clamp((int)glm::floor(u), 0, nbSegments - 1);
+		t = glm::clamp(u - segment, 0.0f, 1.0f);
+		return &controlPoints[segment * Basis::STEP];
+	}
+
+	vector<glm::vec3> controlPoints;
+};
+
+// Curva de base escolhida em tempo de execuo (uma chamada virtual por operao)
+class AnyCurve
+{
+public:
+	AnyCurve() {}
+	template <class Basis>
+	AnyCurve(const CurveT<Basis>& curve) : curve(new Model<Basis>(curve)) {}
+	AnyCurve(const AnyCurve& other) : curve(other.curve ? other.curve->clone() : NULL) {}
+	AnyCurve& operator=(const AnyCurve& other)
+	{
+		curve.reset(other.curve ? other.curve->clone() : NULL);
+		return *this;
+	}
+
+	bool isEmpty() const { return !curve; }
+	int getNbSegments() const { return curve ? curve->getNbSegments() : 0; }
+	glm::vec3 evaluate(float u) const { return curve->evaluate(u); }
+	glm::vec3 derivative(float u) const { return curve->derivative(u); }
+	CurveSegment segment(int i) const { return curve->segment(i); }
+	void sample(int pointsPerSegment, vector<glm::vec3>& out) const { curve->sample(pointsPerSegment, out); }
+protected:
+	struct Concept
+	{
+		virtual ~Concept() {}
+		virtual Concept* clone() const = 0;
+		virtual int getNbSegments() const = 0;
+		virtual glm::vec3 evaluate(float u) const = 0;
+		virtual glm::vec3 derivative(float u) const = 0;
+		virtual CurveSegment segment(int i) const = 0;
+		virtual void sample(int pointsPerSegment, vector<glm::vec3>& out) const = 0;
+	};
+
+	template <class Basis>
+	struct Model : Concept
+	{
+		Model(const CurveT<Basis>& curve) : curve(curve) {}
+		Concept* clone() const { return new Model(curve); }
+		int getNbSegments() const { return curve.getNbSegments(); }
+		glm::vec3 evaluate(float u) const { return curve.evaluate(u); }
+		glm::vec3 derivative(float u) const { return curve.derivative(u); }
+		CurveSegment segment(int i) const { return curve.segment(i); }
+		void sample(int pointsPerSegment, vector<glm::vec3>& out) const { curve.sample(pointsPerSegment, out); }
+
+		CurveT<Basis> curve;
+	};
+
+	unique_ptr<Concept> curve;
+};
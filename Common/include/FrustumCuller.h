@@ -0,0 +1,47 @@
+// Descarte por frustum na CPU. Os seis planos so extrados da matriz projection * view
+// (Gribb/Hartmann) e os volumes de todos os objetos do quadro ficam em arrays separados por
+// componente (SoA), de forma que cada plano  testado contra 4 objetos por vez com SSE, ou 8 com
+// AVX quando o compilador gera AVX (/arch:AVX, -mavx). Um objeto  descartado quando sua esfera
+// ou sua AABB esto inteiramente atrs de algum plano; o teste  conservador (nunca descarta algo
+// visvel, mas pode manter objetos perto dos cantos do frustum).
+
+#pragma once
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+
+using namespace std;
+
+class FrustumCuller
+{
+public:
+	FrustumCuller() : nbVisible(0), lastCullMs(0.0) {}
+	void setFrustum(const glm::mat4& viewProjection);
+	// Inicia um quadro (remove os objetos do anterior)
+	void begin();
+	// Adiciona um objeto com os volumes da malha no espao do modelo; devolve o ndice dele
+	int add(const MeshBounds& bounds, const glm::mat4& model);
+	void cull();
+
+	bool isVisible(int object) { return visible[object] != 0; }
+	int getNbObjects() { return visible.size(); }
+	int getNbVisible() { return nbVisible; }
+	int getNbCulled() { return visible.size() - nbVisible; }
+	double getLastCullMs() { return lastCullMs; }
+	static int getSimdWidth();
+	const glm::vec4* getPlanes() { return planes; }
+protected:
+	void cullScalar(size_t first, size_t last);
+	void cullSimd(size_t& first);
+
+	glm::vec4 planes[6]; // normal (xyz, apontando para dentro) e distncia (w)
+	vector<float> sphereX, sphereY, sphereZ, sphereR;
+	vector<float> boxX, boxY, boxZ, extentX, extentY, extentZ;
+	vector<unsigned char> visible;
+	int nbVisible;
+	double lastCullMs;
+};
@@ -0,0 +1,86 @@
+// O GLAD do repositrio foi gerado para OpenGL 3.3 core. As funes de verses mais novas usadas
+// pelos mdulos em Common so carregadas aqui, em tempo de execuo, via glfwGetProcAddress.
+// Quem usa uma delas deve testar se o ponteiro  nulo e ter um caminho alternativo em 3.3.
+
+#pragma once
+
+//GLAD
+#include <glad/glad.h>
+
+// OpenGL 4.4 - ARB_buffer_storage
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+
+// OpenGL 4.0 - ARB_tessellation_shader
+#ifndef GL_PATCHES
+#define GL_PATCHES 0x000E
+#define GL_PATCH_VERTICES 0x8E72
+#define GL_MAX_TESS_GEN_LEVEL 0x8E7E
+#define GL_TESS_EVALUATION_SHADER 0x8E87
+#define GL_TESS_CONTROL_SHADER 0x8E88
+#endif
+
+// OpenGL 4.0 - ARB_draw_indirect
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+// OpenGL 4.2 - ARB_shader_atomic_counters, ARB_shader_image_load_store
+#ifndef GL_ATOMIC_COUNTER_BUFFER
+#define GL_ATOMIC_COUNTER_BUFFER 0x92C0
+#define GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT 0x00000001
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+#define GL_BUFFER_UPDATE_BARRIER_BIT 0x00000200
+#define GL_ATOMIC_COUNTER_BARRIER_BIT 0x00001000
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#endif
+
+// OpenGL 4.3 - ARB_compute_shader, ARB_shader_storage_buffer_object
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+
+// OpenGL 4.6 - ARB_indirect_parameters
+#ifndef GL_PARAMETER_BUFFER
+#define GL_PARAMETER_BUFFER 0x80EE
+#endif
+
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+typedef void (APIENTRYP PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC)(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex, GLuint baseinstance);
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC)(GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride);
+typedef void (APIENTRYP PFNGLDISPATCHCOMPUTEPROC)(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+typedef void (APIENTRYP PFNGLMEMORYBARRIERPROC)(GLbitfield barriers);
+typedef void (APIENTRYP PFNGLPATCHPARAMETERIPROC)(GLenum pname, GLint value);
+
+// Formato dos comandos lidos por glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+class GLExtensions
+{
+public:
+	// Deve ser chamado depois de gladLoadGLLoader, com o contexto atual. Sem getProcAddress, as
+	// funes so buscadas pela GLFW (ver HeadlessContext::getProcAddress para contextos sem janela)
+	static void load(GLADloadproc getProcAddress = NULL);
+	static void printSupport();
+
+	static PFNGLBUFFERSTORAGEPROC bufferStorage;
+	static PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC drawElementsInstancedBaseVertexBaseInstance;
+	static PFNGLMULTIDRAWELEMENTSINDIRECTPROC multiDrawElementsIndirect;
+	static PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC multiDrawElementsIndirectCount;
+	static PFNGLDISPATCHCOMPUTEPROC dispatchCompute;
+	static PFNGLMEMORYBARRIERPROC memoryBarrier;
+	static PFNGLPATCHPARAMETERIPROC patchParameteri;
+};
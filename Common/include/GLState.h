@@ -0,0 +1,64 @@
+// Cache do estado da OpenGL: guarda o programa, o VAO, as texturas de cada unidade, os
+// enables (depth/blend/cull), o blending e os tamanhos de linha e ponto atuais, e s repassa
+// para a OpenGL as chamadas que realmente mudam alguma coisa. As chamadas filtradas so contadas.
+// Cdigo que mexer no estado diretamente (sem passar por aqui) deve chamar invalidate().
+
+#pragma once
+
+#include <iostream>
+
+//GLAD
+#include <glad/glad.h>
+
+using namespace std;
+
+class GLState
+{
+public:
+	static const int MAX_TEXTURE_UNITS = 16;
+
+	static void useProgram(GLuint program);
+	static void bindVertexArray(GLuint vao);
+	static void activeTexture(GLenum unit);
+	// Vincula a textura na unidade ativa
+	static void bindTexture(GLenum target, GLuint texture);
+	// Ativa a unidade (GL_TEXTURE0 + unit) e vincula a textura nela
+	static void bindTextureUnit(GLuint unit, GLenum target, GLuint texture);
+	static void enable(GLenum cap);
+	static void disable(GLenum cap);
+	static void blendFunc(GLenum sfactor, GLenum dfactor);
+	static void depthMask(GLboolean flag);
+	static void lineWidth(GLfloat width);
+	static void pointSize(GLfloat size);
+
+	// Esquece todo o estado conhecido (a prxima chamada de cada tipo sempre  repassada)
+	static void invalidate();
+	// Deve ser chamado antes de apagar um programa/VAO/textura que possa estar vinculado
+	static void forgetProgram(GLuint program);
+	static void forgetVertexArray(GLuint vao);
+	static void forgetTexture(GLuint texture);
+
+	static unsigned long long getFilteredCalls() { return filteredCalls; }
+	static unsigned long long getForwardedCalls() { return forwardedCalls; }
+	static void resetCounters() { filteredCalls = forwardedCalls = 0; }
+	static void printStats();
+protected:
+	static bool changed(bool differs);
+	static int targetIndex(GLenum target);
+	static int capIndex(GLenum cap);
+
+	static const GLuint UNKNOWN = 0xFFFFFFFF;
+	static const int TEXTURE_TARGETS = 4; // GL_TEXTURE_2D, GL_TEXTURE_BUFFER, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_2D_ARRAY
+	static const int TRACKED_CAPS = 3;    // GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE
+
+	static GLuint program;
+	static GLuint vertexArray;
+	static GLenum activeUnit;
+	static GLuint textures[MAX_TEXTURE_UNITS][TEXTURE_TARGETS];
+	static int caps[TRACKED_CAPS]; // -1 desconhecido, 0 desligado, 1 ligado
+	static GLenum blendSrc, blendDst;
+	static int depthWrite;
+	static GLfloat currentLineWidth, currentPointSize;
+
+	static unsigned long long filteredCalls, forwardedCalls;
+};
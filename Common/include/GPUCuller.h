@@ -0,0 +1,87 @@
+// Descarte feito inteiramente na GPU. Os objetos (matriz model, material, camada, malha e volumes
+// no espao do mundo) ficam num SSBO; um compute shader testa cada um contra o frustum e,
+// opcionalmente, contra a pirmide Hi-Z do OcclusionCuller, e escreve os dados de instncia e um
+// DrawElementsIndirectCommand por objeto visvel. Um contador atmico conta os visveis.
+//
+// Com glMultiDrawElementsIndirectCount (OpenGL 4.6 ou ARB_indirect_parameters) os comandos so
+// compactados e o prprio contador  o nmero de draws, sem leitura pela CPU. Sem ele, cada objeto
+// tem um comando fixo (instanceCount 0 quando descartado) e tudo vai num glMultiDrawElementsIndirect.
+// Exige OpenGL 4.3 (compute shaders e SSBOs); funciona no llvmpipe do Mesa.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "InstanceData.h"
+#include "MeshPool.h"
+#include "OcclusionCuller.h"
+#include "Shader.h"
+
+using namespace std;
+
+// Layout std430 do objeto no SSBO (ver cull.cs)
+struct GPUObject
+{
+	glm::mat4 model;
+	glm::vec4 params;   // material, camada da textura, malha
+	glm::vec4 sphere;   // centro e raio no espao do mundo
+	glm::vec4 boxMin;
+	glm::vec4 boxMax;
+};
+
+class GPUCuller
+{
+public:
+	static const int GROUP_SIZE = 64; // local_size_x do compute shader
+
+	GPUCuller() : pool(NULL), program(0), objectBuffer(0), meshBuffer(0), instanceBuffer(0), commandBuffer(0),
+		counterBuffer(0), hiZTexture(0), hiZLevels(0), hiZWidth(0), hiZHeight(0), occlusion(false), compact(true) {}
+	static bool isSupported();
+	// Compila o compute shader e envia a tabela de malhas do pool
+	bool create(const string& computePath, MeshPool& pool);
+	void destroy();
+
+	// Objetos so adicionados antes de upload(); depois s podem ser movidos com updateObject()
+	int addObject(int mesh, const glm::mat4& model, int material, int layer);
+	void upload();
+	void updateObject(int object, const glm::mat4& model);
+
+	// Envia a pirmide Hi-Z do quadro (o OcclusionCuller precisa usar a mesma viewProjection)
+	void setHiZ(const OcclusionCuller& occlusionCuller);
+	void setOcclusion(bool occlusion) { this->occlusion = occlusion; }
+	// Desliga a compactao mesmo com glMultiDrawElementsIndirectCount disponvel
+	void setCompact(bool compact) { this->compact = compact; }
+	bool isCompacting() { return compact && GLExtensions::multiDrawElementsIndirectCount != NULL; }
+
+	// Executa o compute shader (troca o programa vinculado)
+	void cull(const glm::mat4& viewProjection, const glm::vec4 planes[6]);
+	// Desenha os visveis com o VAO do pool; o programa e as texturas j devem estar vinculados
+	void draw();
+
+	int getNbObjects() { return objects.size(); }
+	// L o contador atmico; fora a CPU a esperar a GPU, ento  s para estatsticas
+	int readVisibleCount();
+protected:
+	// Guarda a matriz e calcula os volumes no espao do mundo
+	void place(GPUObject& object, const glm::mat4& model);
+
+	MeshPool* pool;
+	vector<GPUObject> objects;
+	GLuint program;
+	GLuint objectBuffer, meshBuffer, instanceBuffer, commandBuffer, counterBuffer;
+	GLuint hiZTexture;
+	int hiZLevels, hiZWidth, hiZHeight;
+	bool occlusion, compact;
+
+	struct Locations
+	{
+		GLint nbObjects, planes, viewProjection, compact, occlusion, hiZ, hiZLevels, hiZSize;
+	} locations;
+};
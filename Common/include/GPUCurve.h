@@ -0,0 +1,102 @@
+// Desenho de curvas avaliadas na GPU (vertex pulling). S os pontos de controle so enviados, num
+// texture buffer (GL_RGB32F); o vertex shader (curve.vs) busca os 4 pontos do segmento com
+// texelFetch e aplica a matriz de base, sem nenhum atributo de vrtice. Cada segmento  uma
+// instncia de um GL_TRIANGLE_STRIP com 2 (n + 1) vrtices: o vrtice v  a amostra t = (v / 2) / n,
+// deslocada para um lado ou para o outro da curva (v % 2) ao longo da normal na tela. Assim a
+// espessura  em pixels e funciona em perfis core, em que glLineWidth maior que 1  ignorado.
+//
+// O envio cai de O(amostras) para O(pontos de controle) e o nmero de amostras por segmento  s
+// um uniform: mudar a densidade (ou mover um ponto, com updateControlPoint) no regera nada na
+// CPU. A base vem de Curve::getPointBasis, que leva os pontos de controle direto aos coeficientes,
+// ento Bezier e Hermite usam o mesmo shader. Exige OpenGL 4.0 (texture buffer com GL_RGB32F) e
+// o bloco de uniforms "Camera" vinculado ao ponto 0.
+//
+// O backend de tesselao (OpenGL 4.0, createTessellation) desenha os segmentos como GL_PATCHES de 4
+// pontos, puxados do mesmo texture buffer. O control shader (curve.tcs) escolhe a densidade das
+// isolinhas pelo comprimento do segmento na tela (o da poligonal de Bezier equivalente, para
+// pixelsPerSample pixels por trecho) e descarta os segmentos fora do frustum; o evaluation shader
+// (curve.tes) aplica a matriz de base e o geometry shader (curve.gs) d a espessura em pixels. O
+// detalhe passa a depender da cmera sem nenhuma tesselao na CPU.
+
+#pragma once
+
+#include <string>
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "Shader.h"
+#include "Curve.h"
+
+using namespace std;
+
+class GPUCurve
+{
+public:
+	enum Backend
+	{
+		VERTEX_PULLING,   // amostras fixas por segmento (samplesPerSegment)
+		TESSELLATION      // amostras pelo tamanho na tela (pixelsPerSample)
+	};
+
+	GPUCurve() : program(0), tessellationProgram(0), VAO(0), pointBuffer(0), pointTexture(0), nbControlPoints(0), nbSegments(0),
+		samplesPerSegment(100), pixelsPerSample(8.0f), maxTessellationLevel(64), lineWidth(10.0f), viewport(1.0f),
+		backend(VERTEX_PULLING), uploadedBytes(0) {}
+	static bool isTessellationSupported() { return GLExtensions::patchParameteri != NULL; }
+	// Compila curve.vs e curve.fs
+	bool create(const string& vertexPath, const string& fragmentPath);
+	// Compila o programa do backend de tesselao (chamar depois de create)
+	bool createTessellation(const string& vertexPath, const string& controlPath, const string& evaluationPath,
+		const string& geometryPath, const string& fragmentPath);
+	void destroy();
+
+	// TESSELLATION s  aceito se createTessellation deu certo
+	void setBackend(Backend backend) { this->backend = backend == TESSELLATION && tessellationProgram == 0 ? VERTEX_PULLING : backend; }
+	Backend getBackend() { return backend; }
+
+	// Envia os pontos de controle e a base da curva (refazer quando o nmero de pontos mudar)
+	void upload(Curve& curve);
+	// Reenvia s o ponto k (12 bytes)
+	void updateControlPoint(int k, const glm::vec3& p);
+
+	void setSamplesPerSegment(int samplesPerSegment) { this->samplesPerSegment = glm::max(1, samplesPerSegment); }
+	int getSamplesPerSegment() { return samplesPerSegment; }
+	// Distncia desejada entre amostras na tela, em pixels (backend de tesselao)
+	void setPixelsPerSample(float pixelsPerSample) { this->pixelsPerSample = glm::max(0.5f, pixelsPerSample); }
+	// Espessura em pixels
+	void setLineWidth(float lineWidth) { this->lineWidth = lineWidth; }
+	void setViewport(int width, int height) { viewport = glm::vec2(width, height); }
+
+	// Desenha com a cmera do bloco "Camera" (troca o programa e o VAO vinculados)
+	void draw(const glm::vec4& color);
+
+	int getNbSegments() { return nbSegments; }
+	// Bytes enviados  GPU desde a criao (pontos de controle)
+	size_t getUploadedBytes() { return uploadedBytes; }
+protected:
+	struct Locations
+	{
+		GLint controlPoints, basis, samplesPerSegment, pixelsPerSample, maxLevel, lineWidth, viewport, color;
+	};
+	// Busca os uniforms e liga o bloco "Camera" ao ponto 0
+	static Locations findLocations(GLuint program);
+
+	GLuint program, tessellationProgram;
+	// VAO sem atributos: o perfil core exige um VAO vinculado para desenhar
+	GLuint VAO;
+	GLuint pointBuffer, pointTexture;
+	int nbControlPoints, nbSegments;
+	int samplesPerSegment;
+	float pixelsPerSample;
+	int maxTessellationLevel;
+	float lineWidth;
+	glm::vec2 viewport;
+	glm::mat4 basis;
+	Backend backend;
+	size_t uploadedBytes;
+
+	Locations locations, tessellationLocations;
+};
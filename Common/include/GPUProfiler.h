@@ -0,0 +1,96 @@
+// Profiler de GPU por trechos nomeados: cada begin()/end() grava um par de glQueryCounter com
+// GL_TIMESTAMP (ao contrrio do GL_TIME_ELAPSED, pares de timestamps podem ser aninhados), e os
+// trechos formam uma rvore sob o trecho "quadro", aberto por beginFrame(). Cada quadro usa o seu
+// prprio conjunto de queries num anel de LATENCY_FRAMES quadros; os resultados so lidos quando o
+// conjunto volta a ser usado, alguns quadros depois, e s se a GPU j os tiver produzido (um quadro
+// ainda no terminado  descartado em vez de fazer a CPU esperar).
+//
+// O tempo de cada trecho  somado dentro do quadro (um trecho pode ser aberto mais de uma vez) e
+// entra numa janela mvel dos ltimos N quadros, da qual saem mdia, mnimo e mximo. O resumo pode
+// ser impresso no console ou gravado em JSON. Desligado, begin() e end() no fazem nada.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <iostream>
+
+//GLAD
+#include <glad/glad.h>
+
+using namespace std;
+
+class GPUProfiler
+{
+public:
+	// Quadros em voo antes de um conjunto de queries ser reaproveitado (buffer triplo)
+	static const int LATENCY_FRAMES = 3;
+
+	// Trecho aberto enquanto o objeto existir
+	class Scope
+	{
+	public:
+		Scope(GPUProfiler& profiler, const string& name) : profiler(profiler) { profiler.begin(name); }
+		~Scope() { profiler.end(); }
+	private:
+		GPUProfiler& profiler;
+	};
+
+	GPUProfiler(int window = 120);
+	~GPUProfiler();
+
+	// Passa a valer no prximo beginFrame()
+	void setEnabled(bool enabled) { this->enabled = enabled; }
+	bool isEnabled() { return enabled; }
+
+	void beginFrame();
+	void endFrame();
+	void begin(const string& name);
+	void end();
+
+	// Mdia, em ms, do trecho na janela (caminho completo, ex.: "quadro/cena/suzanne"); -1 se desconhecido
+	double getAverageMs(const string& path);
+	int getNbFrames() { return collectedFrames; }
+	int getNbDropped() { return droppedFrames; }
+	void reset();
+
+	void print(ostream& out = cout);
+	bool writeJSON(const string& path);
+protected:
+	struct ScopeStats
+	{
+		string name, path;
+		int parent, depth;
+		vector<double> history;   // janela mvel, em ms
+		int next;                 // prxima posio da janela
+		double frameMs;           // soma do quadro sendo lido, -1 se o trecho no apareceu nele
+	};
+	struct Marker
+	{
+		int scope;
+		int startQuery, endQuery; // ndices em FrameQueries::queries
+	};
+	struct FrameQueries
+	{
+		vector<GLuint> queries;
+		int used;
+		vector<Marker> markers;
+		bool pending;
+	};
+
+	int findScope(int parent, const string& name);
+	int nextQuery();
+	// L os resultados do conjunto, se disponveis; seno o quadro  descartado
+	void collect(FrameQueries& frame);
+	static void statsOf(const ScopeStats& scope, double& average, double& minimum, double& maximum);
+	static string escape(const string& text);
+
+	int window;
+	bool enabled, active;
+	int frameIndex;
+	FrameQueries frames[LATENCY_FRAMES];
+	vector<ScopeStats> scopes;
+	vector<int> openMarkers;      // pilha de marcadores abertos no quadro atual
+	int collectedFrames, droppedFrames;
+};
@@ -0,0 +1,57 @@
+// Contexto OpenGL sem janela, para rodar os programas em mquinas sem display nem GPU (CI).
+// No Linux tenta primeiro EGL com a plataforma surfaceless da Mesa e, se ela no existir, OSMesa;
+// com a Mesa ambos caem no llvmpipe quando no h GPU. As bibliotecas so abertas com dlopen, ento
+// nada muda na linkagem de quem no usa o modo headless. Nos demais sistemas create() falha e o
+// programa pode usar uma janela invisvel da GLFW no lugar.
+//
+// O desenho vai para um framebuffer prprio (cor RGBA8 + profundidade/stencil), criado com
+// createFramebuffer() em qualquer contexto, e saveFrame() grava o quadro atual em PNG ou PPM.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+//GLAD
+#include <glad/glad.h>
+
+using namespace std;
+
+class HeadlessContext
+{
+public:
+	HeadlessContext();
+	~HeadlessContext();
+
+	// Cria o contexto (OpenGL 3.3 core ou mais novo), o torna atual e carrega a GLAD
+	bool create(int width, int height);
+	// Framebuffer offscreen do tamanho dado, deixado vinculado (requer um contexto atual)
+	bool createFramebuffer(int width, int height);
+	void destroy();
+
+	// Espera a GPU terminar o quadro (o equivalente a trocar os buffers de uma janela)
+	void finishFrame();
+	// L o framebuffer offscreen e grava em path; a extenso escolhe o formato (.png ou .ppm)
+	bool saveFrame(const string& path);
+
+	// Para gladLoadGLLoader/GLExtensions::load enquanto o contexto headless estiver atual
+	static void* getProcAddress(const char* name);
+
+	const string& getBackend() { return backend; }
+	GLuint getFramebuffer() { return framebuffer; }
+	int getWidth() { return width; }
+	int getHeight() { return height; }
+protected:
+	bool createEGL();
+	bool createOSMesa(int width, int height);
+
+	string backend;
+	int width, height;
+	GLuint framebuffer, colorBuffer, depthBuffer;
+	vector<unsigned char> pixels, osmesaBuffer;
+
+	// Handles das bibliotecas e do contexto (tipos opacos, para no exigir os headers)
+	void* library;
+	void* display;
+	void* context;
+};
@@ -5,6 +5,10 @@ class Hermite :
 {
 public:
     Hermite();
-    void generateCurve(int pointsPerSegment);
+    // G = P * H, com as tangentes tiradas dos pontos; W = H * M
+    glm::mat4 getPointBasis();
+protected:
+    // Segmento i: extremos P(3i) e P(3i + 3), tangentes dadas por P(3i + 1) e P(3i + 2)
+    glm::mat4x3 getGeometry(int first);
 };
 
@@ -0,0 +1,21 @@
+// Grava imagens RGBA de 8 bits em PPM (binrio, P6) ou PNG. O PNG  escrito sem compresso
+// (blocos "stored" do deflate), o que dispensa uma biblioteca externa: os arquivos ficam maiores,
+// mas so lidos por qualquer visualizador e comparveis byte a byte entre execues.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class ImageWriter
+{
+public:
+	// Escolhe o formato pela extenso (.png ou .ppm); as linhas vm de cima para baixo
+	static bool write(const string& path, int width, int height, const vector<unsigned char>& rgba);
+	static bool writePPM(const string& path, int width, int height, const vector<unsigned char>& rgba);
+	static bool writePNG(const string& path, int width, int height, const vector<unsigned char>& rgba);
+protected:
+	static unsigned int crc32(const unsigned char* data, size_t size, unsigned int crc = 0);
+};
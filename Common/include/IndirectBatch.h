@@ -0,0 +1,65 @@
+// Desenha a cena inteira (malhas de um MeshPool) com um nico glMultiDrawElementsIndirect.
+// A cada quadro as instncias submetidas so agrupadas por malha e viram um array de
+// DrawElementsIndirectCommand; cada comando aponta para suas instncias pelo baseInstance, e o
+// shader l a matriz model, o material e a camada da textura pelos atributos por instncia.
+// Sem OpenGL 4.3 (ou com setMultiDraw(false)) cada comando vira um draw call separado.
+
+#pragma once
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "InstanceData.h"
+#include "MeshPool.h"
+#include "StreamBuffer.h"
+
+using namespace std;
+
+class IndirectBatch
+{
+public:
+	IndirectBatch() : stream(NULL), multiDraw(true), instanceVBO(0), indirectVBO(0), drawCalls(0), triangles(0) {}
+	void setStreamBuffer(StreamBuffer* stream) { this->stream = stream; }
+	void setMultiDraw(bool multiDraw) { this->multiDraw = multiDraw; }
+	bool getMultiDraw() { return multiDraw && isMultiDrawSupported(); }
+	static bool isMultiDrawSupported() { return GLExtensions::multiDrawElementsIndirect != NULL; }
+
+	void begin();
+	void add(int mesh, const glm::mat4& model, int material, int layer);
+	// Instncia desenhada s por alguns meshlets da malha (ndices em MeshPool::getMeshlets()),
+	// um comando por meshlet
+	void addMeshlets(int mesh, const glm::mat4& model, int material, int layer, const vector<int>& meshlets);
+	// Monta os comandos e desenha; o programa e as texturas j devem estar vinculados
+	void draw(MeshPool& pool);
+
+	int getDrawCalls() { return drawCalls; }
+	int getNbCommands() { return commands.size(); }
+	int getNbInstances() { return items.size() + meshletItems.size(); }
+	long long getNbTriangles() { return triangles; }
+protected:
+	void buildCommands(MeshPool& pool);
+	void drawSeparately(GLuint instanceBuffer, size_t instanceOffset);
+
+	StreamBuffer* stream;
+	bool multiDraw;
+	vector<int> itemMeshes;
+	vector<InstanceData> items;
+	struct MeshletItem
+	{
+		int mesh;
+		InstanceData instance;
+		size_t first, count;   // faixa em meshletIds
+	};
+	vector<MeshletItem> meshletItems;
+	vector<int> meshletIds;
+	vector<InstanceData> sorted;
+	vector<DrawElementsIndirectCommand> commands;
+	vector<GLuint> meshCounts;
+	GLuint instanceVBO, indirectVBO;
+	int drawCalls;
+	long long triangles;
+};
@@ -0,0 +1,50 @@
+// Dados por instncia compartilhados pelos caminhos de desenho instanciado (RenderQueue e
+// IndirectBatch): matriz model nos atributos 4 a 7 e (material, camada da textura) no atributo 8.
+
+#pragma once
+
+//GLAD
+#include <glad/glad.h>
+
+//GLM
+#include <glm/glm.hpp>
+
+struct InstanceData
+{
+	static const GLuint MODEL_LOCATION = 4;
+	static const GLuint PARAMS_LOCATION = 8;
+
+	glm::mat4 model;
+	GLfloat material;
+	GLfloat layer;     // camada no array de texturas
+	GLfloat padding[2]; // mantm o tamanho mltiplo de 16 bytes
+
+	// Liga os atributos por instncia no VAO vinculado (divisor 1)
+	static void enableAttributes()
+	{
+		for (GLuint c = 0; c < 4; c++)
+		{
+			glEnableVertexAttribArray(MODEL_LOCATION + c);
+			glVertexAttribDivisor(MODEL_LOCATION + c, 1);
+		}
+
+		glEnableVertexAttribArray(PARAMS_LOCATION);
+		glVertexAttribDivisor(PARAMS_LOCATION, 1);
+	}
+
+	// Aponta os atributos do VAO vinculado para as instncias que comeam em offset no buffer
+	static void pointAttributes(GLuint buffer, size_t offset)
+	{
+		GLsizei stride = sizeof(InstanceData);
+
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+		// mat4 ocupa 4 atributos consecutivos (uma coluna em cada)
+		for (GLuint c = 0; c < 4; c++)
+			glVertexAttribPointer(MODEL_LOCATION + c, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(offset + c * sizeof(glm::vec4)));
+
+		glVertexAttribPointer(PARAMS_LOCATION, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(offset + sizeof(glm::mat4)));
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+};
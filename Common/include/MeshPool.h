@@ -0,0 +1,57 @@
+// Buffer nico de vrtices e ndices compartilhado por todas as malhas estticas da cena. Cada
+// malha adicionada  indexada (vrtices repetidos so unidos) e ocupa uma faixa dos buffers;
+// todas so desenhadas com o mesmo VAO, o que permite junt-las num nico glMultiDrawElementsIndirect.
+// O layout dos vrtices  o mesmo do setupGeometry dos exerccios: x y z r g b s t nx ny nz.
+
+#pragma once
+
+#include <vector>
+
+//GLAD
+#include <glad/glad.h>
+
+#include "Bounds.h"
+#include "GLState.h"
+#include "InstanceData.h"
+#include "Meshlet.h"
+
+using namespace std;
+
+struct MeshRange
+{
+	GLuint firstIndex;
+	GLuint indexCount;
+	GLint baseVertex;
+	GLuint vertexCount;
+	MeshBounds bounds;       // no espao do modelo
+	int firstMeshlet;        // meshlets da malha em MeshPool::getMeshlets() (0 se no foram gerados)
+	int meshletCount;
+};
+
+class MeshPool
+{
+public:
+	static const int FLOATS_PER_VERTEX = 11;
+
+	MeshPool() : VAO(0), VBO(0), EBO(0) {}
+	// Recebe os vrtices j expandidos (3 por tringulo); devolve o identificador da malha. Com
+	// meshlets, os tringulos so reordenados em meshlets (ver MeshletBuilder)
+	int addMesh(const vector<GLfloat>& vertices, bool meshlets = false);
+	// Envia tudo para a OpenGL e cria o VAO (com os atributos por instncia ligados)
+	void upload();
+
+	GLuint getVAO() { return VAO; }
+	const MeshRange& getMesh(int mesh) { return meshes[mesh]; }
+	int getNbMeshes() { return meshes.size(); }
+	size_t getNbVertices() { return vertices.size() / FLOATS_PER_VERTEX; }
+	size_t getNbIndices() { return indices.size(); }
+	const vector<GLfloat>& getVertices() { return vertices; }
+	const vector<GLuint>& getIndices() { return indices; }
+	const vector<Meshlet>& getMeshlets() { return meshlets; }
+protected:
+	vector<GLfloat> vertices;
+	vector<GLuint> indices;
+	vector<MeshRange> meshes;
+	vector<Meshlet> meshlets;
+	GLuint VAO, VBO, EBO;
+};
@@ -0,0 +1,42 @@
+// Meshlets (clusters): a malha indexada  dividida em grupos de at 64 vrtices e 124 tringulos,
+// escolhidos de forma gulosa entre os tringulos vizinhos dos que j esto no grupo. Os ndices de
+// cada meshlet ficam contguos no index buffer, ento um meshlet pode ser desenhado com um comando
+// indireto prprio. Cada um guarda uma esfera envolvente e um cone de normais (eixo e limite),
+// usados para descartar grupos fora do frustum ou com todas as faces de costas para a cmera.
+
+#pragma once
+
+#include <vector>
+
+//GLAD
+#include <glad/glad.h>
+
+//GLM
+#include <glm/glm.hpp>
+
+using namespace std;
+
+struct Meshlet
+{
+	GLuint firstIndex;       // no index buffer completo
+	GLuint indexCount;
+	GLuint vertexCount;
+	glm::vec3 center;        // esfera envolvente, no espao do modelo
+	float radius;
+	glm::vec3 coneAxis;      // direo mdia das normais dos tringulos
+	float coneCutoff;        // 1 quando as normais se espalham demais para o teste de costas
+};
+
+class MeshletBuilder
+{
+public:
+	static const int MAX_VERTICES = 64;
+	static const int MAX_TRIANGLES = 124;
+
+	// Reordena indices[firstIndex, firstIndex + indexCount) em meshlets e os acrescenta a meshlets.
+	// vertices: stride floats por vrtice com a posio nos trs primeiros; ndices relativos a vertices
+	static void build(const GLfloat* vertices, int stride, vector<GLuint>& indices, size_t firstIndex, size_t indexCount,
+		vector<Meshlet>& meshlets);
+protected:
+	static void computeBounds(const GLfloat* vertices, int stride, const GLuint* indices, size_t indexCount, Meshlet& meshlet);
+};
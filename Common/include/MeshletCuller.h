@@ -0,0 +1,45 @@
+// Descarte de meshlets na CPU, por frustum (esfera do meshlet) e por cone de normais. O teste do
+// cone  feito no espao do modelo, levando a cmera para l, o que continua correto com escalas
+// no uniformes. Os meshlets que sobram so desenhados pelo IndirectBatch, um comando cada.
+// As estatsticas acumulam at resetStats(), para medir taxas ao longo de um percurso da cmera.
+
+#pragma once
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Meshlet.h"
+#include "MeshPool.h"
+
+using namespace std;
+
+class MeshletCuller
+{
+public:
+	MeshletCuller() : coneCulling(true) { resetStats(); }
+	// Planos com a normal apontando para dentro (ver FrustumCuller::getPlanes)
+	void setFrustum(const glm::vec4 planes[6]);
+	void setCameraPosition(const glm::vec3& cameraPosition) { this->cameraPosition = cameraPosition; }
+	void setConeCulling(bool coneCulling) { this->coneCulling = coneCulling; }
+
+	// Acrescenta a visible os meshlets da malha que sobrevivem; devolve quantos
+	int cull(MeshPool& pool, int mesh, const glm::mat4& model, vector<int>& visible);
+	// Mesmo teste sobre meshlets[first, first + count), sem precisar de um MeshPool
+	int cull(const vector<Meshlet>& meshlets, int first, int count, const glm::mat4& model, vector<int>& visible);
+
+	void resetStats();
+	long long getNbMeshlets() { return nbMeshlets; }
+	long long getFrustumCulled() { return frustumCulled; }
+	long long getConeCulled() { return coneCulled; }
+	long long getNbTriangles() { return nbTriangles; }
+	long long getRejectedTriangles() { return rejectedTriangles; }
+	// Frao dos tringulos descartados desde o ltimo resetStats()
+	double getRejectionRate() { return nbTriangles > 0 ? (double)rejectedTriangles / nbTriangles : 0.0; }
+protected:
+	glm::vec4 planes[6];
+	glm::vec3 cameraPosition;
+	bool coneCulling;
+	long long nbMeshlets, frustumCulled, coneCulled, nbTriangles, rejectedTriangles;
+};
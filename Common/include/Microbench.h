@@ -0,0 +1,45 @@
+// Benchmarks dos mdulos de Common que rodam s na CPU, sem janela nem contexto OpenGL, para
+// poderem ser executados em qualquer mquina (por exemplo: Trabalho Final --microbench bvh). A
+// exceo  edit, que confere o VBO da curva e por isso cria um contexto headless (EGL/OSMesa);
+// controlpoints grava e apaga dois arquivos temporrios no diretrio atual.
+
+#pragma once
+
+#include <string>
+#include <functional>
+
+using namespace std;
+
+class Microbench
+{
+public:
+	// Executa o benchmark pelo nome; devolve false se ele no existir
+	static bool run(const string& name);
+
+	// BVH contra testes lineares por objeto, com 1k, 100k e 1M objetos
+	static void bvh();
+	// Rasterizador de ocluso: verificaes simples, tempo por nmero de threads e objetos ocultos
+	static void occlusion();
+	// Meshlets de uma esfera densa: descarte por frustum e por cone com a cmera em rbita
+	static void meshlets();
+	// Amostragem de curvas: G * M * T por amostra (caminho antigo) contra Horner, diferenas
+	// progressivas e SIMD sobre os coeficientes, de 10^3 a 10^7 amostras
+	static void curves();
+	// Tesselao adaptativa (mundo e tela) contra o passo fixo: vrtices e erro da poligonal
+	static void tessellation();
+	// Tabela de comprimento de arco: erro da distncia e custo da busca binria e da tabela uniforme
+	static void arclength();
+	// Bases em tempo de compilao (CurveT) contra Curve e contra a base apagada (AnyCurve)
+	static void bases();
+	// CurveBatch: 100k caminhos avaliados por quadro contra uma curva por vez, por nmero de threads
+	static void batch();
+	// Edio de pontos de controle (Curve::moveControlPoint) contra gerar a curva de novo, no passo
+	// fixo e na tesselao adaptativa: tempo, pontos, VBO e tabela de comprimento de arco
+	static void edit();
+	// Arquivo de pontos de controle: importao do texto (com linhas invlidas e uma maior que o
+	// bloco de leitura) e leitura por janelas e por u contra os pontos na memria
+	static void controlpoints();
+protected:
+	// Menor tempo, em ms, entre algumas repeties
+	static double bestOf(int repetitions, function<void()> work);
+};
@@ -0,0 +1,74 @@
+// Descarte por ocluso na CPU. Os oclusores (malhas grandes e simples) so rasterizados num
+// buffer de profundidade pequeno, sem OpenGL: a tela  dividida em faixas horizontais, uma por
+// thread (do WorkerPool compartilhado), e cada faixa preenche 4 pixels por vez com SSE. Em seguida  montada uma pirmide Hi-Z
+// (cada nvel guarda a profundidade mais distante de 2x2 texels do anterior). A AABB de um objeto 
+// projetada, e ele  considerado oculto se estiver atrs de todos os texels que cobre no nvel em
+// que o retngulo dela ocupa no mximo 2x2 texels.
+//
+// Como no depende de contexto OpenGL, pode ser testado e medido em mquinas sem GPU
+// (ver Microbench::occlusion).
+
+#pragma once
+
+#include <vector>
+
+//GLAD
+#include <glad/glad.h>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+
+using namespace std;
+
+class OcclusionCuller
+{
+public:
+	// A largura  arredondada para mltiplo de 4; nbThreads = 0 usa os ncleos disponveis
+	OcclusionCuller(int width = 256, int height = 128, int nbThreads = 0);
+	void setViewProjection(const glm::mat4& viewProjection) { this->viewProjection = viewProjection; }
+	void setThreads(int nbThreads);
+	// Inicia um quadro (remove os oclusores do anterior)
+	void begin();
+	// vertices: stride floats por vrtice com a posio nos trs primeiros; ndices relativos a vertices
+	void addOccluder(const GLfloat* vertices, int stride, const GLuint* indices, size_t nbIndices, const glm::mat4& model);
+	// Rasteriza os oclusores e monta a pirmide Hi-Z
+	void render();
+
+	bool isOccluded(const AABB& box) const;
+	// Testa os objetos ainda marcados como visveis e zera os que esto ocultos; devolve quantos
+	int test(const vector<AABB>& boxes, vector<unsigned char>& visible);
+
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+	int getNbThreads() const { return nbThreads; }
+	int getNbLevels() const { return levels.size(); }
+	// Profundidade em [0, 1] (0 = plano prximo); o nvel 0  o buffer rasterizado
+	const vector<float>& getLevel(int level) const { return levels[level]; }
+	int getLevelWidth(int level) const { return levelWidth[level]; }
+	int getLevelHeight(int level) const { return levelHeight[level]; }
+	int getNbTriangles() const { return triangles.size(); }
+	int getNbOccluded() const { return nbOccluded; }
+	double getLastRasterMs() const { return lastRasterMs; }
+	double getLastTestMs() const { return lastTestMs; }
+	static int getSimdWidth();
+protected:
+	struct Triangle
+	{
+		int minX, maxX, minY, maxY;   // retngulo em pixels, j limitado  tela
+		float a[3], b[3], c[3];       // funes de aresta a*x + b*y + c (>= 0 dentro)
+		float z0, dzdx, dzdy;         // plano da profundidade: z0 + dzdx*x + dzdy*y
+	};
+	void setupTriangle(const glm::vec4& p0, const glm::vec4& p1, const glm::vec4& p2);
+	void rasterizeBand(int firstRow, int lastRow);
+	void buildHiZ();
+
+	int width, height, nbThreads;
+	glm::mat4 viewProjection;
+	vector<Triangle> triangles;
+	vector<vector<float> > levels;
+	vector<int> levelWidth, levelHeight;
+	int nbOccluded;
+	double lastRasterMs, lastTestMs;
+};
@@ -0,0 +1,99 @@
+// Instrumentao de CPU por zonas: PROFILE_ZONE("nome") abre uma zona que dura at o fim do bloco
+// (RAII) e, ao fechar, grava um evento com os instantes de incio e fim em nanossegundos
+// (steady_clock). Cada thread escreve no seu prprio buffer, sem trava: s a dona escreve, e o
+// contador de eventos  publicado com release, de forma que a exportao pode ler os eventos j
+// completos a qualquer momento. Os eventos so exportados no formato JSON do Chrome trace
+// (chrome://tracing, Perfetto), uma "complete event" por zona; o aninhamento sai dos tempos.
+//
+// As macros s existem com PROFILER_ENABLED definido (Trabalho Final o define no projeto); sem
+// ele viram nada e o custo  zero. Compiladas, as zonas ainda precisam de setEnabled(true) para
+// gravar; desligadas custam uma leitura atmica. O nome precisa durar at a exportao (literal).
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+using namespace std;
+
+#ifdef PROFILER_ENABLED
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(name) Profiler::Zone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_ZONE(__FUNCTION__)
+// Zona com nome de varivel, para poder ser fechada antes do fim do bloco com PROFILE_ZONE_END
+#define PROFILE_ZONE_NAMED(variable, name) Profiler::Zone variable(name)
+#define PROFILE_ZONE_END(variable) variable.end()
+#define PROFILE_THREAD_NAME(name) Profiler::setThreadName(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_ZONE_NAMED(variable, name) ((void)0)
+#define PROFILE_ZONE_END(variable) ((void)0)
+#define PROFILE_THREAD_NAME(name) ((void)0)
+#endif
+
+class Profiler
+{
+public:
+	struct Event
+	{
+		const char* name;
+		uint64_t start, end;   // ns desde o incio do programa
+	};
+
+	class Zone
+	{
+	public:
+		Zone(const char* name) : name(Profiler::isEnabled() ? name : NULL), start(this->name ? Profiler::now() : 0) {}
+		~Zone() { end(); }
+		void end()
+		{
+			if (name)
+				Profiler::record(name, start, Profiler::now());
+			name = NULL;
+		}
+	private:
+		const char* name;
+		uint64_t start;
+	};
+
+	static void setEnabled(bool enabled) { Profiler::enabled.store(enabled, memory_order_relaxed); }
+	static bool isEnabled() { return enabled.load(memory_order_relaxed); }
+
+	static uint64_t now();
+	static void record(const char* name, uint64_t start, uint64_t end);
+	// Nome da thread que chama, mostrado na linha dela no trace
+	static void setThreadName(const string& name);
+
+	static size_t getNbEvents();
+	// Eventos perdidos por buffer cheio
+	static size_t getNbDropped();
+	static bool writeChromeTrace(const string& path);
+protected:
+	// Blocos alocados sob demanda pela prpria thread; um bloco nunca muda de lugar depois de publicado
+	static const size_t CHUNK_EVENTS = 4096;
+	static const size_t MAX_CHUNKS = 256;
+
+	struct ThreadBuffer
+	{
+		Event* chunks[MAX_CHUNKS];
+		atomic<size_t> count;
+		atomic<size_t> dropped;
+		int id;
+		string name;
+	};
+
+	static ThreadBuffer* threadBuffer();
+	static string escape(const char* text);
+
+	static atomic<bool> enabled;
+	// S o registro das threads (uma vez por thread) e a exportao usam a trava
+	static mutex registryMutex;
+	static vector<ThreadBuffer*> buffers;
+	// Buffer da thread atual; os buffers ficam vivos depois que a thread termina, para a exportao
+	static thread_local ThreadBuffer* currentBuffer;
+};
@@ -0,0 +1,114 @@
+// Fila de desenho ordenada: cada objeto submete um pacote (programa, VAO, textura, material,
+// profundidade) que  codificado numa chave de 64 bits. A cada quadro as chaves so ordenadas com
+// radix sort, de forma que os opacos fiquem agrupados por estado e de frente para trs (early-Z) e
+// os transparentes de trs para frente. Na execuo, programa, VAO e textura s so trocados
+// quando mudam de um pacote para o seguinte, e pacotes consecutivos da mesma malha so agrupados
+// num nico glDrawArraysInstanced.
+//
+// Os dados por instncia (matriz model, ndice do material e camada da textura) vo num VBO de
+// instncias (ver InstanceData); os materiais so enviados como o array de uniforms "materials"
+// (vec4: ka, kd, ks, q). Cada VAO desenhado pela fila precisa
+// ser preparado com enableInstancing(). Com setStreamBuffer() os dados por instncia so escritos
+// direto no ring buffer do quadro em vez de num VBO prprio.
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "GLState.h"
+#include "StreamBuffer.h"
+#include "InstanceData.h"
+
+using namespace std;
+
+// Propriedades da superfcie usadas pelo modelo de iluminao (uniforms ka, kd, ks e q)
+struct Material
+{
+	GLfloat ka = 0.2f, kd = 0.2f, ks = 0.5f, q = 10.0f;
+};
+
+struct DrawPacket
+{
+	GLuint program = 0;
+	GLuint vao = 0;
+	GLuint texture = 0;
+	int material = 0;        // ndice retornado por RenderQueue::addMaterial
+	int layer = 0;           // camada da textura, quando ela  um GL_TEXTURE_2D_ARRAY
+	GLenum mode = GL_TRIANGLES;
+	GLint first = 0;
+	GLsizei count = 0;       // nmero de vrtices
+	glm::mat4 model = glm::mat4(1);
+	bool transparent = false;
+};
+
+class RenderQueue
+{
+public:
+	static const int MAX_MATERIALS = 16; // tamanho do array "materials" no shader
+
+	RenderQueue() : farPlane(100.0f), batching(true), textureTarget(GL_TEXTURE_2D), instanceVBO(0), stream(NULL),
+		instanceBuffer(0), instanceBase(0), drawCalls(0), stateChanges(0), skippedBinds(0), triangles(0) {}
+	int addMaterial(const Material& material);
+	// Liga os atributos por instncia no VAO (chamar uma vez, depois de configurar os vrtices)
+	void enableInstancing(GLuint vao);
+	// Com batching desligado cada pacote vira um draw call (til para comparar desempenho)
+	void setBatching(bool batching) { this->batching = batching; }
+	bool getBatching() { return batching; }
+	void setStreamBuffer(StreamBuffer* stream) { this->stream = stream; }
+	// GL_TEXTURE_2D (padro) ou GL_TEXTURE_2D_ARRAY
+	void setTextureTarget(GLenum target) { textureTarget = target; }
+	const vector<Material>& getMaterials() { return materials; }
+	// Envia o array "materials" para o programa vinculado
+	static void uploadMaterials(GLint location, const vector<Material>& materials);
+	void setFarPlane(float farPlane) { this->farPlane = farPlane; }
+	// Inicia um quadro; a view  usada para calcular a profundidade de cada pacote
+	void begin(const glm::mat4& view);
+	void submit(const DrawPacket& packet);
+	void sort();
+	void execute();
+
+	int getNbPackets() { return packets.size(); }
+	int getDrawCalls() { return drawCalls; }
+	int getStateChanges() { return stateChanges; }
+	int getSkippedBinds() { return skippedBinds; }
+	long long getNbTriangles() { return triangles; }
+protected:
+	struct ProgramLocations
+	{
+		GLuint program;
+		GLint materials;
+	};
+	static bool sameMesh(const DrawPacket& a, const DrawPacket& b);
+	void uploadInstances();
+	void pointInstanceAttributes(size_t firstInstance);
+	uint64_t makeKey(const DrawPacket& packet, float depth);
+	static uint32_t denseId(vector<GLuint>& ids, GLuint id);
+	static void radixSort(vector<uint64_t>& keys, vector<uint32_t>& order, vector<uint64_t>& tmpKeys, vector<uint32_t>& tmpOrder);
+	const ProgramLocations& locationsOf(GLuint program);
+
+	vector<DrawPacket> packets;
+	vector<uint64_t> keys, tmpKeys;
+	vector<uint32_t> order, tmpOrder;
+	vector<Material> materials;
+	vector<InstanceData> instances;
+	// Mapeiam os nomes da OpenGL para ndices pequenos que cabem na chave
+	vector<GLuint> programIds, vaoIds, textureIds;
+	vector<ProgramLocations> locations;
+	glm::mat4 view;
+	float farPlane;
+	bool batching;
+	GLenum textureTarget;
+	GLuint instanceVBO;
+	StreamBuffer* stream;
+	// Buffer e offset onde esto os dados por instncia do quadro atual
+	GLuint instanceBuffer;
+	size_t instanceBase;
+
+	int drawCalls, stateChanges, skippedBinds;
+	long long triangles;
+};
@@ -14,6 +14,9 @@
 // GLFW
 #include <GLFW/glfw3.h>
 
+#include "GLState.h"
+#include "Profiler.h"
+
 using namespace std;
 
 class Shader
@@ -23,37 +26,49 @@ public:
 	// Constructor generates the shader on the fly
 	Shader(const GLchar* vertexPath, const GLchar* fragmentPath)
 	{
+		PROFILE_ZONE("Shader::Shader");
 		// 1. Retrieve the vertex/fragment source code from filePath
 		std::string vertexCode;
 		std::string fragmentCode;
-		std::ifstream vShaderFile;
-		std::ifstream fShaderFile;
+		if (!readSource(vertexPath, vertexCode) || !readSource(fragmentPath, fragmentCode))
+		{
+			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+		}
+		// 2. Compile shaders
+		bool linked;
+		this->ID = buildProgram(vertexCode, fragmentCode, linked);
+	}
+	// Reads the whole file into code; returns false if it could not be read
+	static bool readSource(const std::string& path, std::string& code)
+	{
+		std::ifstream shaderFile;
 		// ensures ifstream objects can throw exceptions:
-		vShaderFile.exceptions(std::ifstream::badbit);
-		fShaderFile.exceptions(std::ifstream::badbit);
+		shaderFile.exceptions(std::ifstream::badbit);
 		try
 		{
-			// Open files
-			vShaderFile.open(vertexPath);
-			fShaderFile.open(fragmentPath);
-			std::stringstream vShaderStream, fShaderStream;
-			// Read file's buffer contents into streams
-			vShaderStream << vShaderFile.rdbuf();
-			fShaderStream << fShaderFile.rdbuf();
-			// close file handlers
-			vShaderFile.close();
-			fShaderFile.close();
+			// Open file
+			shaderFile.open(path);
+			if (!shaderFile.is_open())
+				return false;
+			std::stringstream shaderStream;
+			// Read file's buffer contents into stream
+			shaderStream << shaderFile.rdbuf();
+			// close file handler
+			shaderFile.close();
 			// Convert stream into string
-			vertexCode = vShaderStream.str();
-			fragmentCode = fShaderStream.str();
+			code = shaderStream.str();
 		}
 		catch (std::ifstream::failure e)
 		{
-			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+			return false;
 		}
+		return true;
+	}
+	// Compiles and links a program from source; linked tells whether it can be used
+	static GLuint buildProgram(const std::string& vertexCode, const std::string& fragmentCode, bool& linked)
+	{
 		const GLchar* vShaderCode = vertexCode.c_str();
 		const GLchar * fShaderCode = fragmentCode.c_str();
-		// 2. Compile shaders
 		GLuint vertex, fragment;
 		GLint success;
 		GLchar infoLog[512];
@@ -80,26 +95,117 @@ public:
 			std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
 		}
 		// Shader Program
-		this->ID = glCreateProgram();
-		glAttachShader(this->ID, vertex);
-		glAttachShader(this->ID, fragment);
-		glLinkProgram(this->ID);
+		GLuint program = glCreateProgram();
+		glAttachShader(program, vertex);
+		glAttachShader(program, fragment);
+		glLinkProgram(program);
 		// Print linking errors if any
-		glGetProgramiv(this->ID, GL_LINK_STATUS, &success);
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
 		if (!success)
 		{
-			glGetProgramInfoLog(this->ID, 512, NULL, infoLog);
+			glGetProgramInfoLog(program, 512, NULL, infoLog);
 			std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
 		}
+		linked = success != 0;
 		// Delete the shaders as they're linked into our program now and no longer necessery
 		glDeleteShader(vertex);
 		glDeleteShader(fragment);
-
+		return program;
+	}
+	// Compiles and links a compute shader program (OpenGL 4.3); linked tells whether it can be used
+	static GLuint buildComputeProgram(const std::string& computeCode, bool& linked)
+	{
+		const GLchar* cShaderCode = computeCode.c_str();
+		GLint success;
+		GLchar infoLog[512];
+		// Compute Shader (GL_COMPUTE_SHADER is not in the 3.3 headers, see GLExtensions.h)
+		GLuint compute = glCreateShader(0x91B9);
+		glShaderSource(compute, 1, &cShaderCode, NULL);
+		glCompileShader(compute);
+		// Print compile errors if any
+		glGetShaderiv(compute, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			glGetShaderInfoLog(compute, 512, NULL, infoLog);
+			std::cout << "ERROR::SHADER::COMPUTE::COMPILATION_FAILED\n" << infoLog << std::endl;
+		}
+		// Shader Program
+		GLuint program = glCreateProgram();
+		glAttachShader(program, compute);
+		glLinkProgram(program);
+		// Print linking errors if any
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		if (!success)
+		{
+			glGetProgramInfoLog(program, 512, NULL, infoLog);
+			std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+		}
+		linked = success != 0;
+		glDeleteShader(compute);
+		return program;
+	}
+	// Compiles and links vertex, tessellation control, tessellation evaluation, geometry and
+	// fragment shaders (OpenGL 4.0); an empty geometryCode skips that stage
+	static GLuint buildTessellationProgram(const std::string& vertexCode, const std::string& controlCode, const std::string& evaluationCode,
+		const std::string& geometryCode, const std::string& fragmentCode, bool& linked)
+	{
+		GLint success;
+		GLchar infoLog[512];
+		// GL_TESS_CONTROL_SHADER and GL_TESS_EVALUATION_SHADER are not in the 3.3 headers, see GLExtensions.h
+		GLuint shaders[5];
+		int nbShaders = 0;
+		shaders[nbShaders++] = compileStage(GL_VERTEX_SHADER, vertexCode, "VERTEX");
+		shaders[nbShaders++] = compileStage(0x8E88, controlCode, "TESS_CONTROL");
+		shaders[nbShaders++] = compileStage(0x8E87, evaluationCode, "TESS_EVALUATION");
+		if (!geometryCode.empty())
+			shaders[nbShaders++] = compileStage(GL_GEOMETRY_SHADER, geometryCode, "GEOMETRY");
+		shaders[nbShaders++] = compileStage(GL_FRAGMENT_SHADER, fragmentCode, "FRAGMENT");
+		// Shader Program
+		GLuint program = glCreateProgram();
+		for (int i = 0; i < nbShaders; i++)
+			glAttachShader(program, shaders[i]);
+		glLinkProgram(program);
+		// Print linking errors if any
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		if (!success)
+		{
+			glGetProgramInfoLog(program, 512, NULL, infoLog);
+			std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+		}
+		linked = success != 0;
+		for (int i = 0; i < nbShaders; i++)
+			glDeleteShader(shaders[i]);
+		return program;
+	}
+	// Compiles one stage, printing the errors with the stage name
+	static GLuint compileStage(GLenum type, const std::string& code, const char* stageName)
+	{
+		const GLchar* shaderCode = code.c_str();
+		GLint success;
+		GLchar infoLog[512];
+		GLuint shader = glCreateShader(type);
+		glShaderSource(shader, 1, &shaderCode, NULL);
+		glCompileShader(shader);
+		// Print compile errors if any
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			glGetShaderInfoLog(shader, 512, NULL, infoLog);
+			std::cout << "ERROR::SHADER::" << stageName << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+		}
+		return shader;
+	}
+	// Replaces the program by an already linked one (used by the hot-reload)
+	void swapProgram(GLuint program)
+	{
+		GLState::forgetProgram(this->ID);
+		glDeleteProgram(this->ID);
+		this->ID = program;
 	}
 	// Uses the current shader
 	void Use()
 	{
-		glUseProgram(this->ID);
+		GLState::useProgram(this->ID);
 	}
 
 	void setBool(const std::string& name, bool value) const
@@ -0,0 +1,55 @@
+// Observa os arquivos de shader em disco e recarrega o programa quando eles mudam (hot-reload).
+// No Linux usa inotify sobre os diretrios dos shaders; nos demais sistemas compara a data de
+// modificao dos arquivos periodicamente. A leitura dos fontes acontece numa thread separada e a
+// compilao/linkagem acontece em update(), que deve ser chamado na thread do contexto OpenGL no
+// incio de cada quadro: o programa s  trocado se a linkagem der certo.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+#include "Shader.h"
+
+using namespace std;
+
+class ShaderWatcher
+{
+public:
+	ShaderWatcher() : running(false) {}
+	~ShaderWatcher() { stop(); }
+	// Deve ser chamado antes de start(); onReload  chamado logo aps a troca, para reenviar
+	// os uniforms que s so setados uma vez
+	void watch(Shader* shader, string vertexPath, string fragmentPath, function<void(Shader*)> onReload = nullptr);
+	void start();
+	void stop();
+	// Troca os programas pendentes; retorna quantos foram recarregados neste quadro
+	int update();
+protected:
+	struct WatchedShader
+	{
+		Shader* shader;
+		string vertexPath, fragmentPath;
+		function<void(Shader*)> onReload;
+		long long vertexStamp, fragmentStamp;
+		// Preenchidos pela thread de observao e consumidos em update()
+		bool pending;
+		string vertexCode, fragmentCode;
+		chrono::steady_clock::time_point changedAt, readAt;
+	};
+	void run();
+	void reloadSources(WatchedShader& watched, chrono::steady_clock::time_point changedAt);
+	static long long modificationStamp(const string& path);
+	static string directoryOf(const string& path);
+	static string fileNameOf(const string& path);
+
+	vector<WatchedShader> watched;
+	mutex pendingMutex;
+	thread worker;
+	atomic<bool> running;
+};
@@ -0,0 +1,53 @@
+// Ring buffer para dados que mudam a cada quadro (instncias, uniform buffers, vrtices de curvas).
+// O buffer  dividido em uma regio por quadro em voo; cada regio  protegida por um fence
+// (glFenceSync) e s  reescrita depois que a GPU terminou de ler o quadro que a usou.
+// Com OpenGL 4.4 o buffer fica mapeado de forma persistente e coerente, e os dados so escritos
+// direto na memria vista pela GPU, sem cpias do driver. Sem 4.4, allocate() devolve memria de
+// uma cpia local que  enviada com glBufferSubData em commit().
+
+#pragma once
+
+#include <vector>
+
+#include "GLExtensions.h"
+
+using namespace std;
+
+class StreamBuffer
+{
+public:
+	StreamBuffer();
+	~StreamBuffer();
+	void create(size_t frameSize, int framesInFlight = 3);
+	void destroy();
+	// Espera a GPU liberar a regio do quadro atual (o tempo de espera  medido)
+	void beginFrame();
+	// Reserva size bytes alinhados; devolve onde escrever e o offset no buffer, ou NULL se a
+	// regio do quadro estiver cheia (nesse caso ela cresce no prximo beginFrame)
+	void* allocate(size_t size, size_t alignment, size_t& offset);
+	// Torna visvel para a GPU o que foi escrito (s faz algo sem mapeamento persistente)
+	void commit();
+	// Coloca o fence da regio atual e avana para a prxima
+	void endFrame();
+
+	GLuint getBuffer() { return buffer; }
+	bool isPersistent() { return mapped != NULL; }
+	size_t getFrameSize() { return frameSize; }
+	double getLastWaitMs() { return lastWaitMs; }
+	double getTotalWaitMs() { return totalWaitMs; }
+	void resetWaitTime() { totalWaitMs = 0.0; }
+protected:
+	size_t regionStart() { return (size_t)frame * frameSize; }
+
+	GLuint buffer;
+	size_t frameSize;
+	int framesInFlight;
+	int frame;
+	size_t head;          // prximo byte livre na regio atual (relativo ao incio da regio)
+	size_t committed;     // at onde a regio atual j foi enviada (sem mapeamento persistente)
+	size_t requestedSize; // tamanho pedido por uma alocao que no coube
+	unsigned char* mapped;
+	vector<unsigned char> staging;
+	vector<GLsync> fences;
+	double lastWaitMs, totalWaitMs;
+};
@@ -0,0 +1,52 @@
+// Threads de trabalho persistentes, criadas uma vez e reaproveitadas a cada quadro (OcclusionCuller,
+// CurveBatch): criar e juntar uma thread por faixa a cada chamada custa dezenas de microssegundos,
+// o que numa chamada de poucos milissegundos no  desprezvel. run(n, task) executa task(0) a
+// task(n - 1) e s retorna quando todas terminaram; a thread que chamou tambm executa tarefas, e
+// cada uma pega a prxima livre (contador atmico), ento n pode ser maior ou menor que o nmero
+// de threads. Uma chamada de cada vez: chamadas de threads diferentes esperam a anterior terminar.
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+using namespace std;
+
+class WorkerPool
+{
+public:
+	// nbThreads conta a thread que chama run(); 0 usa os ncleos disponveis
+	WorkerPool(int nbThreads = 0);
+	~WorkerPool();
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	// Pool compartilhado pelo programa, criado no primeiro uso
+	static WorkerPool& shared();
+
+	void run(int nbTasks, const function<void(int)>& task);
+	int getNbThreads() const { return workers.size() + 1; }
+protected:
+	void workerLoop();
+	void execute(const function<void(int)>& task, int nbTasks);
+
+	vector<thread> workers;
+	// Uma chamada de run() por vez
+	mutex runMutex;
+	// Protege task, nbTasks, generation, busy e stopping
+	mutex stateMutex;
+	condition_variable wake, done;
+	const function<void(int)>* task;
+	int nbTasks;
+	atomic<int> next;
+	// Incrementado a cada chamada, para as threads saberem que h trabalho novo
+	uint64_t generation;
+	// Threads de trabalho executando a chamada atual
+	int busy;
+	bool stopping;
+};
@@ -0,0 +1,410 @@
+#include "BVH.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+void BVH::build(const vector<AABB>& boxes)
+{
+	objectBoxes = boxes;
+	nodes.clear();
+	objectIds.resize(boxes.size());
+	leafOf.assign(boxes.size(), 0);
+
+	if (boxes.empty())
+		return;
+
+	vector<glm::vec3> centroids(boxes.size());
+	for (size_t i = 0; i < boxes.size(); i++)
+	{
+		objectIds[i] = i;
+		centroids[i] = boxes[i].center();
+	}
+
+	// No pior caso uma rvore binria com folhas de 1 objeto tem 2n - 1 ns
+	nodes.reserve(2 * boxes.size());
+
+	BVHNode root;
+	root.left = -1;
+	root.parent = -1;
+	root.first = 0;
+	root.count = boxes.size();
+	nodes.push_back(root);
+
+	subdivide(0, centroids);
+}
+
+float BVH::surfaceArea(const AABB& box)
+{
+	glm::vec3 d = box.max - box.min;
+	return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+AABB BVH::merge(const AABB& a, const AABB& b)
+{
+	AABB box;
+	box.min = glm::min(a.min, b.min);
+	box.max = glm::max(a.max, b.max);
+	return box;
+}
+
+void BVH::fitNode(int n)
+{
+	BVHNode& node = nodes[n];
+
+	if (node.left >= 0)
+	{
+		node.box = merge(nodes[node.left].box, nodes[node.left + 1].box);
+		return;
+	}
+
+	node.box = objectBoxes[objectIds[node.first]];
+	for (int i = 1; i < node.count; i++)
+		node.box = merge(node.box, objectBoxes[objectIds[node.first + i]]);
+}
+
+void BVH::subdivide(int n, vector<glm::vec3>& centroids)
+{
+	int first = nodes[n].first, count = nodes[n].count;
+
+	nodes[n].box = objectBoxes[objectIds[first]];
+	AABB centroidBox;
+	centroidBox.min = centroidBox.max = centroids[objectIds[first]];
+
+	for (int i = 1; i < count; i++)
+	{
+		int object = objectIds[first + i];
+		nodes[n].box = merge(nodes[n].box, objectBoxes[object]);
+		centroidBox.min = glm::min(centroidBox.min, centroids[object]);
+		centroidBox.max = glm::max(centroidBox.max, centroids[object]);
+	}
+
+	if (count <= MAX_LEAF_OBJECTS)
+	{
+		for (int i = 0; i < count; i++)
+			leafOf[objectIds[first + i]] = n;
+		return;
+	}
+
+	// Divide no eixo em que os centrides esto mais espalhados
+	glm::vec3 extent = centroidBox.max - centroidBox.min;
+	int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+	float minCentroid = centroidBox.min[axis];
+	float range = extent[axis];
+
+	int mid;
+
+	if (range <= 0.0f)
+	{
+		// Todos os centrides coincidem: no h diviso espacial, corta a faixa ao meio
+		mid = first + count / 2;
+	}
+	else
+	{
+		// SAH com binning: distribui os centrides em SAH_BINS faixas e avalia os cortes entre elas
+		int binCount[SAH_BINS] = { 0 };
+		AABB binBox[SAH_BINS];
+		float scale = SAH_BINS / range;
+
+		for (int i = 0; i < count; i++)
+		{
+			int object = objectIds[first + i];
+			int b = min(SAH_BINS - 1, (int)((centroids[object][axis] - minCentroid) * scale));
+			binBox[b] = binCount[b] == 0 ? objectBoxes[object] : merge(binBox[b], objectBoxes[object]);
+			binCount[b]++;
+		}
+
+		float leftArea[SAH_BINS - 1], rightArea[SAH_BINS - 1];
+		int leftCount[SAH_BINS - 1], rightCount[SAH_BINS - 1];
+		AABB accumulated;
+		int accumulatedCount = 0;
+
+		for (int b = 0; b < SAH_BINS - 1; b++)
+		{
+			if (binCount[b] > 0)
+				accumulated = accumulatedCount == 0 ? binBox[b] : merge(accumulated, binBox[b]);
+			accumulatedCount += binCount[b];
+			leftCount[b] = accumulatedCount;
+			leftArea[b] = accumulatedCount > 0 ? surfaceArea(accumulated) : 0.0f;
+		}
+
+		accumulatedCount = 0;
+		for (int b = SAH_BINS - 1; b > 0; b--)
+		{
+			if (binCount[b] > 0)
+				accumulated = accumulatedCount == 0 ? binBox[b] : merge(accumulated, binBox[b]);
+			accumulatedCount += binCount[b];
+			rightCount[b - 1] = accumulatedCount;
+			rightArea[b - 1] = accumulatedCount > 0 ? surfaceArea(accumulated) : 0.0f;
+		}
+
+		int bestSplit = -1;
+		float bestCost = FLT_MAX;
+
+		for (int b = 0; b < SAH_BINS - 1; b++)
+		{
+			if (leftCount[b] == 0 || rightCount[b] == 0)
+				continue;
+
+			float cost = leftArea[b] * leftCount[b] + rightArea[b] * rightCount[b];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestSplit = b;
+			}
+		}
+
+		// Custo de manter como folha (mesma unidade: rea * objetos); s vale para ns pequenos
+		float leafCost = surfaceArea(nodes[n].box) * count;
+		if (count <= 4 * MAX_LEAF_OBJECTS && bestCost >= leafCost)
+		{
+			for (int i = 0; i < count; i++)
+				leafOf[objectIds[first + i]] = n;
+			return;
+		}
+
+		if (bestSplit < 0)
+		{
+			mid = first + count / 2;
+		}
+		else
+		{
+			int* middle = partition(&objectIds[first], &objectIds[first] + count, [&](int object)
+			{
+				return min(SAH_BINS - 1, (int)((centroids[object][axis] - minCentroid) * scale)) <= bestSplit;
+			});
+			mid = middle - &objectIds[0];
+		}
+	}
+
+	int left = nodes.size();
+	nodes[n].left = left;
+
+	BVHNode child;
+	child.left = -1;
+	child.parent = n;
+	child.first = first;
+	child.count = mid - first;
+	nodes.push_back(child);
+
+	child.first = mid;
+	child.count = first + count - mid;
+	nodes.push_back(child);
+
+	subdivide(left, centroids);
+	subdivide(left + 1, centroids);
+}
+
+void BVH::update(int object, const AABB& box)
+{
+	objectBoxes[object] = box;
+
+	for (int n = leafOf[object]; n >= 0; n = nodes[n].parent)
+		fitNode(n);
+}
+
+void BVH::refit()
+{
+	// Filhos sempre tm ndice maior que o pai: percorrer de trs para frente  ps-ordem
+	for (int n = (int)nodes.size() - 1; n >= 0; n--)
+		fitNode(n);
+}
+
+void BVH::refit(const vector<AABB>& boxes)
+{
+	objectBoxes = boxes;
+	refit();
+}
+
+int BVH::getDepth() const
+{
+	int depth = 0;
+
+	for (size_t n = 0; n < nodes.size(); n++)
+	{
+		if (nodes[n].left >= 0)
+			continue;
+
+		int d = 0;
+		for (int p = n; p >= 0; p = nodes[p].parent)
+			d++;
+		depth = max(depth, d);
+	}
+
+	return depth;
+}
+
+void BVH::queryFrustum(const glm::vec4 planes[6], vector<int>& objects) const
+{
+	if (nodes.empty())
+		return;
+
+	// Pilha de (n, mscara dos planos que ainda precisam ser testados)
+	vector<pair<int, int> > stack;
+	stack.reserve(64);
+	stack.push_back(make_pair(0, 0x3F));
+
+	while (!stack.empty())
+	{
+		const BVHNode& node = nodes[stack.back().first];
+		int mask = stack.back().second;
+		stack.pop_back();
+
+		glm::vec3 center = node.box.center(), extents = node.box.extents();
+		bool outside = false;
+
+		for (int p = 0; p < 6 && !outside; p++)
+		{
+			if (!(mask & (1 << p)))
+				continue;
+
+			float distance = glm::dot(glm::vec3(planes[p]), center) + planes[p].w;
+			float radius = glm::dot(glm::abs(glm::vec3(planes[p])), extents);
+
+			if (distance + radius < 0.0f)
+				outside = true;
+			else if (distance - radius >= 0.0f)
+				mask &= ~(1 << p); // inteiramente do lado de dentro deste plano
+		}
+
+		if (outside)
+			continue;
+
+		if (mask == 0 || node.left < 0)
+		{
+			// Dentro de todos os planos (ou folha): entrega a faixa inteira, testando s nas folhas parciais
+			for (int i = 0; i < node.count; i++)
+			{
+				int object = objectIds[node.first + i];
+
+				if (mask != 0)
+				{
+					const AABB& box = objectBoxes[object];
+					glm::vec3 c = box.center(), e = box.extents();
+					bool objectOutside = false;
+
+					for (int p = 0; p < 6 && !objectOutside; p++)
+						if (mask & (1 << p))
+							objectOutside = glm::dot(glm::vec3(planes[p]), c) + planes[p].w + glm::dot(glm::abs(glm::vec3(planes[p])), e) < 0.0f;
+
+					if (objectOutside)
+						continue;
+				}
+
+				objects.push_back(object);
+			}
+			continue;
+		}
+
+		stack.push_back(make_pair(node.left, mask));
+		stack.push_back(make_pair(node.left + 1, mask));
+	}
+}
+
+bool BVH::raySlab(const AABB& box, const glm::vec3& origin, const glm::vec3& inverse, float maxDistance, float& entry)
+{
+	glm::vec3 t0 = (box.min - origin) * inverse;
+	glm::vec3 t1 = (box.max - origin) * inverse;
+	glm::vec3 tMin = glm::min(t0, t1), tMax = glm::max(t0, t1);
+
+	entry = max(max(tMin.x, tMin.y), max(tMin.z, 0.0f));
+	float exit = min(min(tMax.x, tMax.y), min(tMax.z, maxDistance));
+
+	return entry <= exit;
+}
+
+int BVH::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& distance) const
+{
+	int hit = -1;
+	distance = maxDistance;
+
+	if (nodes.empty())
+		return hit;
+
+	glm::vec3 inverse = 1.0f / direction;
+	vector<int> stack;
+	stack.reserve(64);
+	stack.push_back(0);
+
+	while (!stack.empty())
+	{
+		const BVHNode& node = nodes[stack.back()];
+		stack.pop_back();
+		float entry;
+
+		if (!raySlab(node.box, origin, inverse, distance, entry))
+			continue;
+
+		if (node.left < 0)
+		{
+			for (int i = 0; i < node.count; i++)
+			{
+				int object = objectIds[node.first + i];
+
+				if (raySlab(objectBoxes[object], origin, inverse, distance, entry) && entry < distance)
+				{
+					distance = entry;
+					hit = object;
+				}
+			}
+			continue;
+		}
+
+		// O filho mais prximo vai por ltimo na pilha, para ser visitado primeiro
+		float leftEntry, rightEntry;
+		bool leftHit = raySlab(nodes[node.left].box, origin, inverse, distance, leftEntry);
+		bool rightHit = raySlab(nodes[node.left + 1].box, origin, inverse, distance, rightEntry);
+
+		if (leftHit && rightHit)
+		{
+			bool leftFirst = leftEntry <= rightEntry;
+			stack.push_back(leftFirst ? node.left + 1 : node.left);
+			stack.push_back(leftFirst ? node.left : node.left + 1);
+		}
+		else if (leftHit)
+			stack.push_back(node.left);
+		else if (rightHit)
+			stack.push_back(node.left + 1);
+	}
+
+	return hit;
+}
+
+void BVH::querySphere(const glm::vec3& center, float radius, vector<int>& objects) const
+{
+	if (nodes.empty())
+		return;
+
+	float radius2 = radius * radius;
+	vector<int> stack;
+	stack.reserve(64);
+	stack.push_back(0);
+
+	while (!stack.empty())
+	{
+		const BVHNode& node = nodes[stack.back()];
+		stack.pop_back();
+
+		// Distncia ao quadrado do centro at o ponto mais prximo da caixa
+		glm::vec3 closest = glm::clamp(center, node.box.min, node.box.max);
+		glm::vec3 d = closest - center;
+		if (glm::dot(d, d) > radius2)
+			continue;
+
+		if (node.left < 0)
+		{
+			for (int i = 0; i < node.count; i++)
+			{
+				int object = objectIds[node.first + i];
+				glm::vec3 c = glm::clamp(center, objectBoxes[object].min, objectBoxes[object].max) - center;
+
+				if (glm::dot(c, c) <= radius2)
+					objects.push_back(object);
+			}
+			continue;
+		}
+
+		stack.push_back(node.left);
+		stack.push_back(node.left + 1);
+	}
+}
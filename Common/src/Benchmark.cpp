@@ -0,0 +1,251 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+Benchmark::Benchmark(int warmupFrames, int measuredFrames, double timestep)
+	: warmupFrames(warmupFrames), measuredFrames(max(1, measuredFrames)), frame(0), timestep(timestep),
+	hasLastFrame(false), trianglesKnown(true), gpuTiming(false)
+{
+	cpuMs.reserve(this->measuredFrames);
+	frameMs.reserve(this->measuredFrames);
+	gpuMs.assign(this->measuredFrames, -1.0);
+
+	for (int q = 0; q < QUERY_FRAMES; q++)
+	{
+		queries[q][0] = queries[q][1] = 0;
+		queryFrame[q] = -1;
+	}
+}
+
+Benchmark::~Benchmark()
+{
+	if (gpuTiming)
+		glDeleteQueries(QUERY_FRAMES * 2, &queries[0][0]);
+}
+
+float Benchmark::getProgress()
+{
+	if (isWarmingUp() || measuredFrames < 2)
+		return 0.0f;
+
+	return min(1.0f, (float)(frame - warmupFrames) / (measuredFrames - 1));
+}
+
+void Benchmark::setConfig(const string& key, const string& value)
+{
+	config.push_back(make_pair(key, "\"" + escape(value) + "\""));
+}
+
+void Benchmark::setConfig(const string& key, long long value)
+{
+	config.push_back(make_pair(key, to_string(value)));
+}
+
+void Benchmark::beginFrame()
+{
+	if (!gpuTiming && frame == 0)
+	{
+		// GL_TIMESTAMP faz parte do ncleo desde a 3.3
+		glGenQueries(QUERY_FRAMES * 2, &queries[0][0]);
+		gpuTiming = true;
+	}
+
+	frameStart = chrono::steady_clock::now();
+
+	if (!isWarmingUp() && hasLastFrame)
+		frameMs.push_back(chrono::duration<double, milli>(frameStart - lastFrameStart).count());
+
+	lastFrameStart = frameStart;
+	hasLastFrame = true;
+
+	if (isWarmingUp())
+		return;
+
+	// O par deste quadro  o mais antigo do anel: o resultado dele precisa ser lido antes
+	int slot = (frame - warmupFrames) % QUERY_FRAMES;
+	collectGPU(slot, true);
+
+	queryFrame[slot] = frame - warmupFrames;
+	glQueryCounter(queries[slot][0], GL_TIMESTAMP);
+}
+
+void Benchmark::endFrame(int drawCalls, long long triangles)
+{
+	if (!isWarmingUp())
+	{
+		int slot = (frame - warmupFrames) % QUERY_FRAMES;
+		glQueryCounter(queries[slot][1], GL_TIMESTAMP);
+
+		cpuMs.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - frameStart).count());
+		this->drawCalls.push_back(drawCalls);
+
+		if (triangles < 0)
+			trianglesKnown = false;
+		this->triangles.push_back((double)max(0LL, triangles));
+
+		for (int q = 0; q < QUERY_FRAMES; q++)
+			collectGPU(q, false);
+	}
+
+	frame++;
+}
+
+bool Benchmark::collectGPU(int slot, bool wait)
+{
+	if (queryFrame[slot] < 0)
+		return false;
+
+	GLint available = 1;
+	if (!wait)
+		glGetQueryObjectiv(queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+	if (!available)
+		return false;
+
+	GLuint64 start, end;
+	glGetQueryObjectui64v(queries[slot][0], GL_QUERY_RESULT, &start);
+	glGetQueryObjectui64v(queries[slot][1], GL_QUERY_RESULT, &end);
+
+	gpuMs[queryFrame[slot]] = (end - start) / 1.0e6;
+	queryFrame[slot] = -1;
+
+	return true;
+}
+
+void Benchmark::finish()
+{
+	if (gpuTiming)
+		for (int q = 0; q < QUERY_FRAMES; q++)
+			collectGPU(q, true);
+}
+
+Benchmark::Summary Benchmark::summarize(vector<double> values)
+{
+	Summary s = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+	if (values.empty())
+		return s;
+
+	sort(values.begin(), values.end());
+
+	// Percentil pelo posto mais prximo
+	auto percentile = [&](double p)
+	{
+		size_t rank = (size_t)ceil(p / 100.0 * values.size());
+		return values[min(values.size() - 1, rank > 0 ? rank - 1 : 0)];
+	};
+
+	double sum = 0.0;
+	for (size_t i = 0; i < values.size(); i++)
+		sum += values[i];
+
+	s.mean = sum / values.size();
+	s.p50 = percentile(50.0);
+	s.p95 = percentile(95.0);
+	s.p99 = percentile(99.0);
+	s.min = values.front();
+	s.max = values.back();
+
+	return s;
+}
+
+void Benchmark::print()
+{
+	auto line = [](const string& name, const vector<double>& values)
+	{
+		Summary s = summarize(values);
+		cout << "  " << name << ": media " << s.mean << ", p50 " << s.p50 << ", p95 " << s.p95 << ", p99 " << s.p99
+			<< " (min " << s.min << ", max " << s.max << ")" << endl;
+	};
+
+	vector<double> gpu;
+	for (size_t i = 0; i < gpuMs.size(); i++)
+		if (gpuMs[i] >= 0.0)
+			gpu.push_back(gpuMs[i]);
+
+	cout << fixed << setprecision(3);
+	cout << "Benchmark: " << cpuMs.size() << " quadros medidos depois de " << warmupFrames << " de aquecimento" << endl;
+	line("CPU (ms)", cpuMs);
+	line("quadro (ms)", frameMs);
+	if (!gpu.empty())
+		line("GPU (ms)", gpu);
+	line("draw calls", drawCalls);
+	if (trianglesKnown)
+		line("triangulos", triangles);
+	cout.unsetf(ios::fixed);
+	cout << setprecision(6);
+}
+
+string Benchmark::escape(const string& text)
+{
+	string out;
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		char c = text[i];
+		if (c == '"' || c == '\\')
+			out += '\\';
+		if ((unsigned char)c < 0x20)
+			continue;
+		out += c;
+	}
+	return out;
+}
+
+void Benchmark::writeSummary(ostream& out, const string& name, const vector<double>& values)
+{
+	Summary s = summarize(values);
+	out << "  \"" << name << "\": { \"mean\": " << s.mean << ", \"p50\": " << s.p50 << ", \"p95\": " << s.p95
+		<< ", \"p99\": " << s.p99 << ", \"min\": " << s.min << ", \"max\": " << s.max << " }";
+}
+
+bool Benchmark::writeJSON(const string& path)
+{
+	vector<double> gpu;
+	for (size_t i = 0; i < gpuMs.size(); i++)
+		if (gpuMs[i] >= 0.0)
+			gpu.push_back(gpuMs[i]);
+
+	ostringstream out;
+	out << setprecision(6);
+	out << "{" << endl;
+	out << "  \"warmup_frames\": " << warmupFrames << "," << endl;
+	out << "  \"measured_frames\": " << cpuMs.size() << "," << endl;
+	out << "  \"timestep\": " << timestep << "," << endl;
+
+	out << "  \"config\": {";
+	for (size_t i = 0; i < config.size(); i++)
+		out << (i > 0 ? ", " : " ") << "\"" << escape(config[i].first) << "\": " << config[i].second;
+	out << (config.empty() ? "}," : " },") << endl;
+
+	writeSummary(out, "cpu_ms", cpuMs);
+	out << "," << endl;
+	writeSummary(out, "frame_ms", frameMs);
+	out << "," << endl;
+	if (!gpu.empty())
+		writeSummary(out, "gpu_ms", gpu);
+	else
+		out << "  \"gpu_ms\": null";
+	out << "," << endl;
+	writeSummary(out, "draw_calls", drawCalls);
+	out << "," << endl;
+	if (trianglesKnown)
+		writeSummary(out, "triangles", triangles);
+	else
+		out << "  \"triangles\": null";
+	out << endl << "}" << endl;
+
+	ofstream file(path.c_str());
+	if (!file)
+	{
+		cout << "Nao foi possivel gravar " << path << endl;
+		return false;
+	}
+
+	file << out.str();
+	return (bool)file;
+}
@@ -0,0 +1,67 @@
+#include "Bounds.h"
+
+#include <cfloat>
+#include <cmath>
+
+AABB AABB::transformed(const glm::mat4& model) const
+{
+	glm::vec3 c = glm::vec3(model * glm::vec4(center(), 1.0f));
+	glm::vec3 e = extents();
+
+	// Cada eixo da caixa nova recebe a projeo dos trs eixos transformados (Arvo)
+	glm::vec3 newExtents;
+	for (int row = 0; row < 3; row++)
+		newExtents[row] = fabs(model[0][row]) * e.x + fabs(model[1][row]) * e.y + fabs(model[2][row]) * e.z;
+
+	AABB box;
+	box.min = c - newExtents;
+	box.max = c + newExtents;
+	return box;
+}
+
+BoundingSphere BoundingSphere::transformed(const glm::mat4& model) const
+{
+	// O raio cresce com a maior escala entre os trs eixos
+	float scale = glm::max(glm::length(glm::vec3(model[0])), glm::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+
+	BoundingSphere sphere;
+	sphere.center = glm::vec3(model * glm::vec4(center, 1.0f));
+	sphere.radius = radius * scale;
+	return sphere;
+}
+
+MeshBounds MeshBounds::fromVertices(const GLfloat* vertices, size_t nbVertices, int stride)
+{
+	MeshBounds bounds;
+
+	if (nbVertices == 0)
+		return bounds;
+
+	bounds.box.min = glm::vec3(FLT_MAX);
+	bounds.box.max = glm::vec3(-FLT_MAX);
+
+	for (size_t v = 0; v < nbVertices; v++)
+	{
+		glm::vec3 p(vertices[v * stride], vertices[v * stride + 1], vertices[v * stride + 2]);
+		bounds.box.min = glm::min(bounds.box.min, p);
+		bounds.box.max = glm::max(bounds.box.max, p);
+	}
+
+	// Esfera centrada na caixa, com o raio at o vrtice mais distante (mais justa que a diagonal)
+	bounds.sphere.center = bounds.box.center();
+
+	float radius2 = 0.0f;
+	for (size_t v = 0; v < nbVertices; v++)
+	{
+		glm::vec3 d = glm::vec3(vertices[v * stride], vertices[v * stride + 1], vertices[v * stride + 2]) - bounds.sphere.center;
+		radius2 = glm::max(radius2, glm::dot(d, d));
+	}
+	bounds.sphere.radius = sqrt(radius2);
+
+	return bounds;
+}
+
+MeshBounds MeshBounds::fromVertices(const vector<GLfloat>& vertices, int stride)
+{
+	return fromVertices(vertices.data(), vertices.size() / stride, stride);
+}
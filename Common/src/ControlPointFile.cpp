@@ -0,0 +1,408 @@
+#include "ControlPointFile.h"
+#include "Profiler.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char MAGIC[4] = { 'C', 'P', 'T', 'S' };
+static const size_t HEADER_SIZE = sizeof(ControlPointHeader);
+static_assert(sizeof(ControlPointHeader) == 32, "cabecalho do .cpb deve ter 32 bytes");
+static_assert(sizeof(glm::vec3) == 12, "pontos do .cpb sao 3 floats sem preenchimento");
+
+// Blocos da importao: bytes lidos do texto e pontos gravados por vez
+static const size_t TEXT_BLOCK = 1 << 20;
+static const size_t POINT_BLOCK = 1 << 16;
+
+static bool seekTo(FILE* file, long long offset)
+{
+#ifdef _WIN32
+	return _fseeki64(file, offset, SEEK_SET) == 0;
+#else
+	return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+static long long fileSize(const string& path)
+{
+#ifdef _WIN32
+	struct _stat64 info;
+	return _stat64(path.c_str(), &info) == 0 ? (long long)info.st_size : -1;
+#else
+	struct stat info;
+	return stat(path.c_str(), &info) == 0 ? (long long)info.st_size : -1;
+#endif
+}
+
+static ControlPointHeader makeHeader(uint64_t nbPoints)
+{
+	ControlPointHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = ControlPointFile::VERSION;
+	header.pointSize = sizeof(glm::vec3);
+	header.nbPoints = nbPoints;
+	return header;
+}
+
+CurveSegment SegmentWindow::getSegment(int i, const glm::mat4& pointBasis) const
+{
+	const glm::vec3* p = points + 3 * i;
+	return CurveEvaluator::coefficients(glm::mat4x3(p[0], p[1], p[2], p[3]), pointBasis);
+}
+
+bool ControlPointFile::write(const string& path, const vector<glm::vec3>& points)
+{
+	FILE* out = fopen(path.c_str(), "wb");
+	if (!out)
+		return false;
+
+	ControlPointHeader header = makeHeader(points.size());
+	bool ok = fwrite(&header, HEADER_SIZE, 1, out) == 1;
+	if (ok && !points.empty())
+		ok = fwrite(points.data(), sizeof(glm::vec3), points.size(), out) == points.size();
+
+	return fclose(out) == 0 && ok;
+}
+
+long long ControlPointFile::importText(const string& textPath, const string& binaryPath)
+{
+	PROFILE_ZONE("ControlPointFile::importText");
+
+	FILE* in = fopen(textPath.c_str(), "rb");
+	if (!in)
+		return -1;
+
+	FILE* out = fopen(binaryPath.c_str(), "wb");
+	if (!out)
+	{
+		fclose(in);
+		return -1;
+	}
+
+	// O nmero de pontos s  conhecido no fim: o cabealho  reescrito depois
+	ControlPointHeader header = makeHeader(0);
+	bool ok = fwrite(&header, HEADER_SIZE, 1, out) == 1;
+
+	vector<char> text(TEXT_BLOCK + 1);
+	vector<glm::vec3> points;
+	points.reserve(POINT_BLOCK);
+	uint64_t nbPoints = 0;
+	size_t pending = 0;    // bytes de uma linha incompleta, no incio de text
+	bool skipping = false; // descartando o resto de uma linha maior que o bloco
+	bool end = false;
+
+	while (ok && !end)
+	{
+		size_t read = fread(&text[pending], 1, TEXT_BLOCK - pending, in);
+		size_t size = pending + read;
+		end = read == 0 || feof(in);
+
+		size_t lineStart = 0;
+		if (skipping)
+		{
+			char* newline = (char*)memchr(text.data(), '\n', size);
+			if (!newline)
+			{
+				pending = 0;
+				continue;
+			}
+
+			// A linha seguinte comea depois da quebra
+			lineStart = newline - text.data() + 1;
+			skipping = false;
+		}
+
+		// Uma linha maior que o bloco inteiro no  um ponto: descarta at a prxima quebra (sem ler o
+		// fim dela como uma linha nova)
+		if (!end && size == TEXT_BLOCK && !memchr(text.data(), '\n', size))
+		{
+			pending = 0;
+			skipping = true;
+			continue;
+		}
+
+		while (lineStart < size)
+		{
+			char* newline = (char*)memchr(&text[lineStart], '\n', size - lineStart);
+			if (!newline && !end)
+				break;
+
+			size_t lineEnd = newline ? newline - text.data() : size;
+			text[lineEnd] = '\0';
+
+			// Uma linha vale se tiver trs nmeros ("x y z"); as demais so ignoradas
+			char* cursor = &text[lineStart];
+			char* next;
+			float coordinates[3];
+			int parsed = 0;
+			for (; parsed < 3; parsed++)
+			{
+				coordinates[parsed] = strtof(cursor, &next);
+				if (next == cursor)
+					break;
+				cursor = next;
+			}
+
+			if (parsed == 3)
+			{
+				points.push_back(glm::vec3(coordinates[0], coordinates[1], coordinates[2]));
+				if (points.size() == POINT_BLOCK)
+				{
+					ok = fwrite(points.data(), sizeof(glm::vec3), points.size(), out) == points.size();
+					nbPoints += points.size();
+					points.clear();
+				}
+			}
+
+			lineStart = lineEnd + 1;
+		}
+
+		pending = lineStart < size ? size - lineStart : 0;
+		if (pending > 0)
+			memmove(text.data(), &text[lineStart], pending);
+	}
+
+	if (ok && !points.empty())
+	{
+		ok = fwrite(points.data(), sizeof(glm::vec3), points.size(), out) == points.size();
+		nbPoints += points.size();
+	}
+
+	header.nbPoints = nbPoints;
+	ok = ok && seekTo(out, 0) && fwrite(&header, HEADER_SIZE, 1, out) == 1;
+
+	fclose(in);
+	ok = fclose(out) == 0 && ok;
+
+	if (!ok)
+	{
+		remove(binaryPath.c_str());
+		return -1;
+	}
+
+	return (long long)nbPoints;
+}
+
+bool ControlPointFile::importIfNewer(const string& textPath, const string& binaryPath)
+{
+	struct stat text, binary;
+
+	if (stat(textPath.c_str(), &text) != 0)
+		return stat(binaryPath.c_str(), &binary) == 0;
+
+	if (stat(binaryPath.c_str(), &binary) == 0 && binary.st_mtime >= text.st_mtime)
+		return true;
+
+	return importText(textPath, binaryPath) >= 0;
+}
+
+bool ControlPointFile::open(const string& path)
+{
+	PROFILE_ZONE("ControlPointFile::open");
+
+	close();
+
+	ControlPointHeader header;
+	FILE* in = fopen(path.c_str(), "rb");
+	if (!in)
+		return false;
+
+	// Um arquivo truncado derrubaria o programa ao ler o mapeamento alm do fim. nbPoints  comparado
+	// com o que cabe no arquivo, e no o contrrio: HEADER_SIZE + nbPoints * 12 pode estourar
+	long long bytes = fileSize(path);
+	bool valid = bytes >= (long long)HEADER_SIZE && fread(&header, HEADER_SIZE, 1, in) == 1 &&
+		memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION && header.pointSize == sizeof(glm::vec3) &&
+		header.nbPoints <= (unsigned long long)(bytes - HEADER_SIZE) / sizeof(glm::vec3);
+
+	if (!valid)
+	{
+		cout << "ControlPointFile: " << path << " nao e um arquivo de pontos de controle valido" << endl;
+		fclose(in);
+		return false;
+	}
+
+	nbPoints = (long long)header.nbPoints;
+	size_t size = HEADER_SIZE + (size_t)nbPoints * sizeof(glm::vec3);
+
+#ifdef _WIN32
+	HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (handle != INVALID_HANDLE_VALUE)
+	{
+		HANDLE map = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+		void* view = map ? MapViewOfFile(map, FILE_MAP_READ, 0, 0, size) : NULL;
+
+		if (view)
+		{
+			fileHandle = handle;
+			mappingHandle = map;
+			mapping = (const char*)view;
+		}
+		else
+		{
+			if (map)
+				CloseHandle(map);
+			CloseHandle(handle);
+		}
+	}
+#else
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd >= 0)
+	{
+		void* view = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+		// O mapeamento continua vlido depois de fechar o descritor
+		::close(fd);
+
+		if (view != MAP_FAILED)
+		{
+			mapping = (const char*)view;
+			madvise(view, size, MADV_SEQUENTIAL);
+		}
+	}
+#endif
+
+	if (mapping)
+	{
+		mappingSize = size;
+		fclose(in);
+	}
+	else
+		file = in;
+
+	rewind();
+	return true;
+}
+
+void ControlPointFile::close()
+{
+	if (mapping)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(mapping);
+		CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+		mappingHandle = fileHandle = NULL;
+#else
+		munmap((void*)mapping, mappingSize);
+#endif
+		mapping = NULL;
+		mappingSize = 0;
+	}
+
+	if (file)
+	{
+		fclose(file);
+		file = NULL;
+	}
+
+	windowBuffer.clear();
+	windowBuffer.shrink_to_fit();
+	nbPoints = 0;
+	cursor = 0;
+	released = 0;
+}
+
+const glm::vec3* ControlPointFile::pointsAt(long long first, long long count)
+{
+	if (mapping)
+		return (const glm::vec3*)(mapping + HEADER_SIZE + first * sizeof(glm::vec3));
+
+	windowBuffer.resize(count);
+	if (!seekTo(file, HEADER_SIZE + first * sizeof(glm::vec3)) ||
+		fread(windowBuffer.data(), sizeof(glm::vec3), count, file) != (size_t)count)
+		return NULL;
+
+	return windowBuffer.data();
+}
+
+bool ControlPointFile::window(long long firstSegment, int nbSegments, SegmentWindow& out)
+{
+	long long total = getNbSegments();
+	if (firstSegment < 0 || firstSegment >= total || nbSegments <= 0)
+		return false;
+
+	out.firstSegment = firstSegment;
+	out.nbSegments = (int)min((long long)nbSegments, total - firstSegment);
+	out.points = pointsAt(3 * firstSegment, 3 * (long long)out.nbSegments + 1);
+
+	return out.points != NULL;
+}
+
+void ControlPointFile::rewind()
+{
+	cursor = 0;
+	released = 0;
+}
+
+bool ControlPointFile::nextWindow(int nbSegments, SegmentWindow& out)
+{
+	if (!window(cursor, nbSegments, out))
+		return false;
+
+	// A janela anterior j foi usada: suas pginas podem sair da memria
+	releaseBefore(3 * cursor);
+	cursor += out.nbSegments;
+	return true;
+}
+
+void ControlPointFile::releaseBefore(long long point)
+{
+#ifndef _WIN32
+	if (!mapping)
+		return;
+
+	static const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+	size_t end = (HEADER_SIZE + point * sizeof(glm::vec3)) / pageSize * pageSize;
+
+	if (end > released)
+	{
+		madvise((void*)(mapping + released), end - released, MADV_DONTNEED);
+		released = end;
+	}
+#else
+	// No Windows o gerenciador de memria tira as pginas do working set sozinho
+	(void)point;
+#endif
+}
+
+glm::vec3 ControlPointFile::evaluate(double u, const glm::mat4& pointBasis)
+{
+	long long total = getNbSegments();
+	if (total == 0)
+		return glm::vec3(0.0f);
+
+	long long segment = (long long)glm::clamp(floor(u), 0.0, (double)(total - 1));
+	float t = (float)glm::clamp(u - segment, 0.0, 1.0);
+
+	SegmentWindow w;
+	if (!window(segment, 1, w))
+		return glm::vec3(0.0f);
+
+	return CurveEvaluator::point(w.getSegment(0, pointBasis), t);
+}
+
+void ControlPointFile::readAll(vector<glm::vec3>& points)
+{
+	points.clear();
+
+	if (nbPoints == 0)
+		return;
+
+	const glm::vec3* data = pointsAt(0, nbPoints);
+	if (data)
+		points.assign(data, data + nbPoints);
+}
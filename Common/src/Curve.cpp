@@ -1,20 +1,382 @@
 #include "Curve.h"
 
+#include <cmath>
+#include <algorithm>
+
+#include "Profiler.h"
+
 void Curve::setShader(Shader* shader)
 {
 	this->shader = shader;
 	shader->Use();
 }
 
+void Curve::setControlPoints(vector <glm::vec3> controlPoints)
+{
+	this->controlPoints = controlPoints;
+	updateSegments();
+
+	// O nmero de segmentos pode ter mudado: segmentStarts se referia aos pontos da gerao anterior
+	segmentStarts.clear();
+
+	if (arcIntervals > 0)
+		buildArcLengthTable(arcIntervals, arcLutSize);
+}
+
+void Curve::updateSegments()
+{
+	segments.clear();
+
+	int nControlPoints = controlPoints.size();
+
+	for (int i = 0; i < nControlPoints - 3; i += 3)
+		segments.push_back(CurveEvaluator::coefficients(getGeometry(i), M));
+}
+
+void Curve::buildArcLengthTable(int intervalsPerSegment, int lutSize)
+{
+	PROFILE_ZONE("Curve::buildArcLengthTable");
+
+	arcParams.clear();
+	arcLengths.clear();
+	arcLut.clear();
+
+	intervalsPerSegment = max(1, intervalsPerSegment);
+	arcIntervals = intervalsPerSegment;
+	arcLutSize = lutSize;
+
+	if (segments.empty())
+		return;
+
+	arcParams.push_back(0.0f);
+	arcLengths.push_back(0.0f);
+
+	for (size_t s = 0; s < segments.size(); s++)
+		for (int k = 0; k < intervalsPerSegment; k++)
+		{
+			float t0 = (float)k / intervalsPerSegment, t1 = (float)(k + 1) / intervalsPerSegment;
+			arcParams.push_back(s + t1);
+			arcLengths.push_back(arcLengths.back() + CurveEvaluator::arcLength(segments[s], t0, t1));
+		}
+
+	buildArcLengthLut(lutSize);
+}
+
+void Curve::buildArcLengthLut(int lutSize)
+{
+	arcLut.clear();
+
+	for (int i = 0; i < lutSize; i++)
+		arcLut.push_back(searchArcLength(getLength() * i / max(1, lutSize - 1)));
+}
+
+void Curve::updateArcLengths(int first, int last)
+{
+	int intervals = arcIntervals;
+	size_t end = (size_t)(last + 1) * intervals;
+	float oldEnd = arcLengths[end];
+
+	for (int s = first; s <= last; s++)
+		for (int k = 0; k < intervals; k++)
+		{
+			size_t i = (size_t)s * intervals + k + 1;
+			float t0 = (float)k / intervals, t1 = (float)(k + 1) / intervals;
+			arcLengths[i] = arcLengths[i - 1] + CurveEvaluator::arcLength(segments[s], t0, t1);
+		}
+
+	float delta = arcLengths[end] - oldEnd;
+	for (size_t i = end + 1; i < arcLengths.size(); i++)
+		arcLengths[i] += delta;
+
+	if (!arcLut.empty())
+		buildArcLengthLut(arcLut.size());
+}
+
+float Curve::searchArcLength(float s)
+{
+	s = glm::clamp(s, 0.0f, getLength());
+
+	// Intervalo [i, i + 1] que contm s
+	size_t i = upper_bound(arcLengths.begin(), arcLengths.end(), s) - arcLengths.begin();
+	i = glm::clamp(i, (size_t)1, arcLengths.size() - 1) - 1;
+
+	float u0 = arcParams[i], u1 = arcParams[i + 1];
+	float s0 = arcLengths[i], s1 = arcLengths[i + 1];
+
+	int segment = min((int)u0, (int)segments.size() - 1);
+	float t0 = u0 - segment, t1 = u1 - segment;
+
+	// Chute linear e duas iteraes de Newton: f(t) = comprimento de t0 a t - (s - s0), f'(t) = |p'(t)|
+	float t = s1 > s0 ? t0 + (t1 - t0) * (s - s0) / (s1 - s0) : t0;
+	for (int n = 0; n < 2; n++)
+	{
+		float speed = glm::length(CurveEvaluator::derivative(segments[segment], t));
+		if (speed < 1e-6f)
+			break;
+
+		t -= (CurveEvaluator::arcLength(segments[segment], t0, t) - (s - s0)) / speed;
+		t = glm::clamp(t, t0, t1);
+	}
+
+	return segment + t;
+}
+
+float Curve::parameterAtDistance(float s)
+{
+	if (arcLengths.empty())
+		return 0.0f;
+
+	if (arcLut.size() < 2)
+		return searchArcLength(s);
+
+	// Tabela uniforme: acesso direto e interpolao linear entre as duas entradas vizinhas
+	float position = glm::clamp(s / getLength(), 0.0f, 1.0f) * (arcLut.size() - 1);
+	size_t i = min((size_t)position, arcLut.size() - 2);
+	float f = position - i;
+
+	return arcLut[i] + (arcLut[i + 1] - arcLut[i]) * f;
+}
+
+int Curve::locate(float u, float& t)
+{
+	int segment = glm::clamp((int)floor(u), 0, (int)segments.size() - 1);
+	t = glm::clamp(u - segment, 0.0f, 1.0f);
+	return segment;
+}
+
+glm::vec3 Curve::evaluate(float u)
+{
+	if (segments.empty())
+		return glm::vec3(0.0f);
+
+	float t;
+	int segment = locate(u, t);
+	return CurveEvaluator::point(segments[segment], t);
+}
+
+glm::vec3 Curve::derivative(float u)
+{
+	if (segments.empty())
+		return glm::vec3(0.0f);
+
+	float t;
+	int segment = locate(u, t);
+	return CurveEvaluator::derivative(segments[segment], t);
+}
+
+glm::vec3 Curve::secondDerivative(float u)
+{
+	if (segments.empty())
+		return glm::vec3(0.0f);
+
+	float t;
+	int segment = locate(u, t);
+	return CurveEvaluator::secondDerivative(segments[segment], t);
+}
+
+glm::vec3 Curve::pointAtDistance(float s)
+{
+	return evaluate(parameterAtDistance(s));
+}
+
+glm::vec3 Curve::pointAtTime(float time, float speed, bool loop)
+{
+	float s = time * speed;
+
+	if (loop && getLength() > 0.0f)
+	{
+		s = fmod(s, getLength());
+		if (s < 0.0f)
+			s += getLength();
+	}
+
+	return pointAtDistance(s);
+}
+
+void Curve::generateCurve(int pointsPerSegment)
+{
+	PROFILE_ZONE("Curve::generateCurve");
+
+	tessellation.pointsPerSegment = pointsPerSegment;
+	tessellateCurve();
+}
+
+void Curve::generateCurveAdaptive(float tolerance)
+{
+	PROFILE_ZONE("Curve::generateCurveAdaptive");
+
+	tessellation.pointsPerSegment = 0;
+	tessellation.tolerance = tolerance;
+	tessellation.screen = false;
+	tessellateCurve();
+}
+
+void Curve::generateCurveAdaptive(float pixelTolerance, const glm::mat4& viewProjection, int width, int height)
+{
+	PROFILE_ZONE("Curve::generateCurveAdaptive");
+
+	tessellation.pointsPerSegment = 0;
+	tessellation.tolerance = pixelTolerance;
+	tessellation.screen = true;
+	tessellation.viewProjection = viewProjection;
+	tessellation.viewport = glm::vec2(width, height);
+	tessellateCurve();
+}
+
+void Curve::tessellateSegment(int segment, vector<glm::vec3>& out)
+{
+	// Passo fixo: pointsPerSegment + 1 pontos por segmento, com o ponto de juno repetido
+	if (tessellation.pointsPerSegment > 0)
+	{
+		size_t first = out.size();
+		out.resize(first + tessellation.pointsPerSegment + 1);
+		CurveEvaluator::evaluate(segments[segment], tessellation.pointsPerSegment, &out[first]);
+		return;
+	}
+
+	tessellationParams.clear();
+	if (tessellation.screen)
+		CurveEvaluator::tessellate(segments[segment], tessellation.tolerance, tessellation.viewProjection, tessellation.viewport, tessellationParams);
+	else
+		CurveEvaluator::tessellate(segments[segment], tessellation.tolerance, tessellationParams);
+
+	for (size_t k = segment > 0 ? 1 : 0; k < tessellationParams.size(); k++)
+		out.push_back(CurveEvaluator::point(segments[segment], tessellationParams[k]));
+}
+
+void Curve::tessellateCurve()
+{
+	curvePoints.clear();
+	segmentStarts.assign(1, 0);
+
+	for (size_t s = 0; s < segments.size(); s++)
+	{
+		tessellateSegment(s, curvePoints);
+		segmentStarts.push_back(curvePoints.size());
+	}
+
+	uploadCurve(0, curvePoints.size());
+}
+
+void Curve::moveControlPoint(int k, const glm::vec3& p)
+{
+	PROFILE_ZONE("Curve::moveControlPoint");
+
+	if (k < 0 || k >= (int)controlPoints.size())
+		return;
+
+	controlPoints[k] = p;
+
+	// O segmento s usa os pontos de controle 3s a 3s + 3
+	int first = max(0, (k - 1) / 3);
+	int last = min((int)segments.size() - 1, k / 3);
+
+	if (first > last)
+		return;
+
+	for (int s = first; s <= last; s++)
+		segments[s] = CurveEvaluator::coefficients(getGeometry(s * 3), M);
+
+	if (!arcLengths.empty())
+		updateArcLengths(first, last);
+
+	// Curva ainda no gerada (ou gerada antes de mudar o nmero de pontos de controle)
+	if (segmentStarts.size() == segments.size() + 1)
+		retessellate(first, last);
+}
+
+void Curve::retessellate(int first, int last)
+{
+	size_t begin = segmentStarts[first], end = segmentStarts[last + 1];
+
+	editPoints.clear();
+	vector<int> sizes;
+	for (int s = first; s <= last; s++)
+	{
+		size_t before = editPoints.size();
+		tessellateSegment(s, editPoints);
+		sizes.push_back(editPoints.size() - before);
+	}
+
+	// Mesmo nmero de pontos (sempre, no passo fixo): s o trecho dos segmentos muda
+	if (editPoints.size() == end - begin)
+	{
+		copy(editPoints.begin(), editPoints.end(), curvePoints.begin() + begin);
+		uploadCurve(begin, end);
+		return;
+	}
+
+	curvePoints.erase(curvePoints.begin() + begin, curvePoints.begin() + end);
+	curvePoints.insert(curvePoints.begin() + begin, editPoints.begin(), editPoints.end());
+
+	int delta = (int)editPoints.size() - (int)(end - begin);
+	for (int s = first; s <= last; s++)
+		segmentStarts[s + 1] = segmentStarts[s] + sizes[s - first];
+	for (size_t s = last + 2; s < segmentStarts.size(); s++)
+		segmentStarts[s] += delta;
+
+	// Os pontos seguintes foram deslocados: reenvia do primeiro segmento editado at o fim
+	uploadCurve(begin, curvePoints.size());
+}
+
+void Curve::uploadCurve(size_t first, size_t last)
+{
+	if (VBO != 0)
+	{
+		// Uma nova tesselao ou edio reaproveita o VBO (o VAO j aponta para ele)
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+		// Uma edio que cabe no VBO atual s atualiza o trecho alterado
+		if ((first > 0 || last < curvePoints.size()) && curvePoints.size() <= vboCapacity)
+			glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(glm::vec3), (last - first) * sizeof(glm::vec3), &curvePoints[first]);
+		else
+		{
+			glBufferData(GL_ARRAY_BUFFER, curvePoints.size() * sizeof(GLfloat) * 3, curvePoints.data(), GL_STATIC_DRAW);
+			vboCapacity = curvePoints.size();
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		return;
+	}
+
+	//Gerao do identificador do VBO
+	glGenBuffers(1, &VBO);
+
+	//Faz a conexo (vincula) do buffer como um buffer de array
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+	//Envia os dados do array de floats para o buffer da OpenGl
+	glBufferData(GL_ARRAY_BUFFER, curvePoints.size() * sizeof(GLfloat) * 3, curvePoints.data(), GL_STATIC_DRAW);
+	vboCapacity = curvePoints.size();
+
+	//Gerao do identificador do VAO (Vertex Array Object)
+	glGenVertexArrays(1, &VAO);
+
+	// Vincula (bind) o VAO primeiro, e em seguida  conecta e seta o(s) buffer(s) de vrtices
+	// e os ponteiros para os atributos 
+	GLState::bindVertexArray(VAO);
+
+	//Atributo posio (x, y, z)
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
+	glEnableVertexAttribArray(0);
+
+	// Observe que isso  permitido, a chamada para glVertexAttribPointer registrou o VBO como o objeto de buffer de vrtice 
+	// atualmente vinculado - para que depois possamos desvincular com segurana
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// Desvincula o VAO ( uma boa prtica desvincular qualquer buffer ou array para evitar bugs medonhos)
+	GLState::bindVertexArray(0);
+}
+
 void Curve::drawCurve(glm::vec4 color)
 {
+	shader->Use();
 	shader->setVec4("finalColor", color.r, color.g, color.b, color.a);
 
-	glBindVertexArray(VAO);
+	GLState::bindVertexArray(VAO);
 	// Chamada de desenho - drawcall
 	// CONTORNO e PONTOS - GL_LINE_LOOP e GL_POINTS
 	glDrawArrays(GL_LINE_STRIP, 0, curvePoints.size());
 	//glDrawArrays(GL_POINTS, 0, curvePoints.size());
-	glBindVertexArray(0);
 
 }
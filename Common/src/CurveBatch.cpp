@@ -0,0 +1,388 @@
+#include "CurveBatch.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <thread>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define BATCH_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BATCH_WIDTH 4
+#else
+#define BATCH_WIDTH 1
+#endif
+
+#if BATCH_WIDTH > 1
+
+// Os 12 floats de cada um de 4 segmentos (a, b, c e d seguidos) viram 12 registradores, um por
+// componente, com uma lane por segmento: trs transposies 4x4
+static inline void transposeSegments(const CurveSegment* const* segments, __m128* components)
+{
+	for (int k = 0; k < 3; k++)
+	{
+		__m128 r0 = _mm_loadu_ps(&segments[0]->a.x + k * 4);
+		__m128 r1 = _mm_loadu_ps(&segments[1]->a.x + k * 4);
+		__m128 r2 = _mm_loadu_ps(&segments[2]->a.x + k * 4);
+		__m128 r3 = _mm_loadu_ps(&segments[3]->a.x + k * 4);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		components[k * 4 + 0] = r0;
+		components[k * 4 + 1] = r1;
+		components[k * 4 + 2] = r2;
+		components[k * 4 + 3] = r3;
+	}
+}
+
+#endif
+
+// Blocos (ou grupos de LANES valores) por thread abaixo dos quais dividir o trabalho custa mais do
+// que economiza
+static const int MIN_BLOCKS_PER_THREAD = 512;
+
+CurveBatch::CurveBatch(int nbThreads) : blockCapacity(0), maxSegments(0)
+{
+	zero.a = zero.b = zero.c = zero.d = glm::vec3(0.0f);
+	firstSegments.assign(1, 0);
+	setThreads(nbThreads);
+}
+
+void CurveBatch::setThreads(int nbThreads)
+{
+	if (nbThreads <= 0)
+		nbThreads = max(1, (int)thread::hardware_concurrency());
+
+	this->nbThreads = nbThreads;
+}
+
+int CurveBatch::getSimdWidth()
+{
+	return BATCH_WIDTH;
+}
+
+int CurveBatch::addCurve(const vector<CurveSegment>& segments)
+{
+	int curve = getNbCurves();
+
+	if (curve % LANES == 0)
+		uniformCounts.push_back(0);
+
+	firstSegments.push_back(firstSegments.back());
+	setCurve(curve, segments);
+	return curve;
+}
+
+void CurveBatch::reserve(int nbBlocks, int nbSegments)
+{
+	if (nbBlocks <= blockCapacity && nbSegments <= maxSegments)
+		return;
+
+	// Capacidade dobrada, para que adicionar curvas uma a uma no reorganize tudo a cada bloco
+	int newCapacity = nbBlocks > blockCapacity ? max(nbBlocks, blockCapacity * 2) : blockCapacity;
+	int newSegments = max(nbSegments, maxSegments);
+	vector<float> grown((size_t)newSegments * newCapacity * COMPONENTS * LANES, 0.0f);
+
+	for (int s = 0; s < maxSegments; s++)
+		for (int b = 0; b < blockCapacity; b++)
+			copy(blockAt(s, b), blockAt(s, b) + COMPONENTS * LANES, &grown[((size_t)s * newCapacity + b) * COMPONENTS * LANES]);
+
+	coefficients.swap(grown);
+	blockCapacity = newCapacity;
+	maxSegments = newSegments;
+}
+
+void CurveBatch::setCurve(int curve, const vector<CurveSegment>& segments)
+{
+	int block = curve / LANES, lane = curve % LANES;
+	int nbSegments = segments.size();
+
+	reserve(block + 1, nbSegments);
+
+	// Segmentos alm do fim da curva ficam zerados (caso ela tenha encolhido)
+	for (int s = 0; s < maxSegments; s++)
+	{
+		gatherLane(s < nbSegments ? segments[s] : zero, lane, blockAt(s, block));
+	}
+
+	// Cpia por curva, contgua: se o nmero de segmentos mudou, as curvas seguintes so deslocadas
+	int delta = nbSegments - getNbSegments(curve);
+	if (delta > 0)
+		this->segments.insert(this->segments.begin() + firstSegments[curve + 1], delta, zero);
+	else if (delta < 0)
+		this->segments.erase(this->segments.begin() + firstSegments[curve + 1] + delta, this->segments.begin() + firstSegments[curve + 1]);
+	for (size_t c = curve + 1; c < firstSegments.size(); c++)
+		firstSegments[c] += delta;
+	copy(segments.begin(), segments.end(), this->segments.begin() + firstSegments[curve]);
+
+	// Nmero de segmentos comum s curvas do bloco, ou 0 se elas diferem
+	int first = block * LANES;
+	int last = min(getNbCurves(), first + LANES);
+	int common = getNbSegments(first);
+	for (int c = first; c < last; c++)
+		if (getNbSegments(c) != common)
+			common = 0;
+
+	uniformCounts[block] = common;
+}
+
+void CurveBatch::clear()
+{
+	coefficients.clear();
+	uniformCounts.clear();
+	segments.clear();
+	firstSegments.assign(1, 0);
+	blockCapacity = maxSegments = 0;
+}
+
+int CurveBatch::locate(float u, int nbSegments, float& t)
+{
+	float x = glm::clamp(u, 0.0f, 1.0f) * nbSegments;
+	int segment = min((int)x, nbSegments - 1);
+	t = x - segment;
+	return segment;
+}
+
+#if BATCH_WIDTH == 8
+
+static inline __m256 madd(__m256 x, __m256 y, __m256 z)
+{
+#if defined(__FMA__)
+	return _mm256_fmadd_ps(x, y, z);
+#else
+	return _mm256_add_ps(_mm256_mul_ps(x, y), z);
+#endif
+}
+
+void CurveBatch::hornerLanes(const float* coefficients, const float* t, float* x, float* y, float* z)
+{
+	__m256 vt = _mm256_loadu_ps(t);
+	float* out[3] = { x, y, z };
+
+	for (int r = 0; r < 3; r++)
+	{
+		__m256 a = _mm256_loadu_ps(coefficients + r * LANES);
+		__m256 b = _mm256_loadu_ps(coefficients + (3 + r) * LANES);
+		__m256 c = _mm256_loadu_ps(coefficients + (6 + r) * LANES);
+		__m256 d = _mm256_loadu_ps(coefficients + (9 + r) * LANES);
+		_mm256_storeu_ps(out[r], madd(madd(madd(a, vt, b), vt, c), vt, d));
+	}
+}
+
+void CurveBatch::hornerSegments(const CurveSegment* const* segments, const float* t, float* x, float* y, float* z)
+{
+	__m128 low[COMPONENTS], high[COMPONENTS];
+	transposeSegments(segments, low);
+	transposeSegments(segments + 4, high);
+
+	__m256 vt = _mm256_loadu_ps(t);
+	float* out[3] = { x, y, z };
+
+	for (int r = 0; r < 3; r++)
+	{
+		__m256 c[4];
+		for (int k = 0; k < 4; k++)
+			c[k] = _mm256_insertf128_ps(_mm256_castps128_ps256(low[k * 3 + r]), high[k * 3 + r], 1);
+		_mm256_storeu_ps(out[r], madd(madd(madd(c[0], vt, c[1]), vt, c[2]), vt, c[3]));
+	}
+}
+
+#elif BATCH_WIDTH == 4
+
+void CurveBatch::hornerLanes(const float* coefficients, const float* t, float* x, float* y, float* z)
+{
+	float* out[3] = { x, y, z };
+
+	for (int h = 0; h < LANES; h += 4)
+	{
+		__m128 vt = _mm_loadu_ps(t + h);
+
+		for (int r = 0; r < 3; r++)
+		{
+			__m128 a = _mm_loadu_ps(coefficients + r * LANES + h);
+			__m128 b = _mm_loadu_ps(coefficients + (3 + r) * LANES + h);
+			__m128 c = _mm_loadu_ps(coefficients + (6 + r) * LANES + h);
+			__m128 d = _mm_loadu_ps(coefficients + (9 + r) * LANES + h);
+			_mm_storeu_ps(out[r] + h, _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(a, vt), b), vt), c), vt), d));
+		}
+	}
+}
+
+void CurveBatch::hornerSegments(const CurveSegment* const* segments, const float* t, float* x, float* y, float* z)
+{
+	float* out[3] = { x, y, z };
+
+	for (int h = 0; h < LANES; h += 4)
+	{
+		__m128 c[COMPONENTS];
+		transposeSegments(segments + h, c);
+		__m128 vt = _mm_loadu_ps(t + h);
+
+		for (int r = 0; r < 3; r++)
+			_mm_storeu_ps(out[r] + h, _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(c[r], vt), c[3 + r]), vt), c[6 + r]), vt), c[9 + r]));
+	}
+}
+
+#else
+
+void CurveBatch::hornerLanes(const float* coefficients, const float* t, float* x, float* y, float* z)
+{
+	// Sem SSE: Horner escalar
+	float* out[3] = { x, y, z };
+
+	for (int r = 0; r < 3; r++)
+		for (int l = 0; l < LANES; l++)
+		{
+			const float* c = coefficients + l;
+			out[r][l] = ((c[r * LANES] * t[l] + c[(3 + r) * LANES]) * t[l] + c[(6 + r) * LANES]) * t[l] + c[(9 + r) * LANES];
+		}
+}
+
+void CurveBatch::hornerSegments(const CurveSegment* const* segments, const float* t, float* x, float* y, float* z)
+{
+	for (int l = 0; l < LANES; l++)
+	{
+		glm::vec3 p = CurveEvaluator::point(*segments[l], t[l]);
+		x[l] = p.x;
+		y[l] = p.y;
+		z[l] = p.z;
+	}
+}
+
+#endif
+
+void CurveBatch::gatherLane(const CurveSegment& segment, int lane, float* lanes)
+{
+	// a, b, c e d so 4 vec3 seguidos: 12 floats na ordem dos componentes
+	const float* src = &segment.a.x;
+	for (int c = 0; c < COMPONENTS; c++)
+		lanes[c * LANES + lane] = src[c];
+}
+
+void CurveBatch::evaluateBlocks(int firstBlock, int lastBlock, const float* us, int usStride, glm::vec3* out) const
+{
+	int nbCurves = getNbCurves();
+	float t[LANES], x[LANES], y[LANES], z[LANES];
+	int segment[LANES];
+
+	for (int b = firstBlock; b < lastBlock; b++)
+	{
+		int first = b * LANES;
+		int count = min(LANES, nbCurves - first);
+		int nbSegments = uniformCounts[b];
+
+		if (maxSegments == 0)
+		{
+			fill(out + first, out + first + count, glm::vec3(0.0f));
+			continue;
+		}
+
+		if (usStride == 0 && nbSegments > 0)
+		{
+			// Mesmo u e mesmo nmero de segmentos: um s segmento, lido com cargas contguas
+			float tb;
+			int s = locate(us[0], nbSegments, tb);
+			fill(t, t + LANES, tb);
+			hornerLanes(blockAt(s, b), t, x, y, z);
+		}
+		else
+		{
+			// Todas as curvas do bloco no mesmo segmento (fases prximas): Horner SIMD na estrutura de
+			// arrays. Para na primeira que difere, que  o caso comum com fases espalhadas
+			bool same = true;
+			for (int l = 0; l < LANES && same; l++)
+			{
+				// Lanes sem curva (fim do ltimo bloco) repetem a primeira
+				int curve = first + (l < count ? l : 0);
+				int n = getNbSegments(curve);
+				if (n > 0)
+					segment[l] = locate(us[curve * usStride], n, t[l]);
+				else
+				{
+					// Curva sem segmentos: t = 0 com coeficientes nulos d a origem
+					segment[l] = 0;
+					t[l] = 0.0f;
+				}
+				same = segment[l] == segment[0];
+			}
+
+			if (same)
+				hornerLanes(blockAt(segment[0], b), t, x, y, z);
+			else
+			{
+				// Cada curva num segmento: cada ponto sai direto da cpia em AoS, por Horner escalar.
+				// Juntar os 8 segmentos em registradores (hornerSegments) custa mais que o prprio
+				// Horner: 1,5 ms contra 1,1 ms para as 100 mil curvas de Microbench::batch
+				for (int curve = first; curve < first + count; curve++)
+				{
+					int n = getNbSegments(curve);
+					if (n == 0)
+					{
+						out[curve] = glm::vec3(0.0f);
+						continue;
+					}
+
+					float tc;
+					int s = locate(us[curve * usStride], n, tc);
+					out[curve] = CurveEvaluator::point(segments[firstSegments[curve] + s], tc);
+				}
+				continue;
+			}
+		}
+
+		// Curvas sem segmentos tm coeficientes nulos: o ponto sai na origem
+		for (int l = 0; l < count; l++)
+			out[first + l] = glm::vec3(x[l], y[l], z[l]);
+	}
+}
+
+void CurveBatch::evaluateGroups(int curve, int firstGroup, int lastGroup, const float* us, int n, glm::vec3* out) const
+{
+	const CurveSegment* segments = &this->segments[firstSegments[curve]];
+	int nbSegments = getNbSegments(curve);
+	const CurveSegment* sources[LANES];
+	float t[LANES], x[LANES], y[LANES], z[LANES];
+
+	for (int g = firstGroup; g < lastGroup; g++)
+	{
+		int first = g * LANES;
+		int count = min(LANES, n - first);
+
+		for (int l = 0; l < LANES; l++)
+			sources[l] = &segments[locate(us[first + (l < count ? l : 0)], nbSegments, t[l])];
+
+		hornerSegments(sources, t, x, y, z);
+
+		for (int l = 0; l < count; l++)
+			out[first + l] = glm::vec3(x[l], y[l], z[l]);
+	}
+}
+
+void CurveBatch::parallelFor(int count, function<void(int, int)> work) const
+{
+	int threads = max(1, min(nbThreads, count / MIN_BLOCKS_PER_THREAD));
+	int perThread = (count + threads - 1) / threads;
+
+	// Uma faixa por tarefa, nas threads persistentes do WorkerPool
+	WorkerPool::shared().run(threads, [&](int i) { work(i * perThread, min(count, (i + 1) * perThread)); });
+}
+
+void CurveBatch::evaluate(float u, glm::vec3* out) const
+{
+	parallelFor(uniformCounts.size(), [&](int first, int last) { evaluateBlocks(first, last, &u, 0, out); });
+}
+
+void CurveBatch::evaluate(const float* us, glm::vec3* out) const
+{
+	parallelFor(uniformCounts.size(), [&](int first, int last) { evaluateBlocks(first, last, us, 1, out); });
+}
+
+void CurveBatch::evaluateCurve(int curve, const float* us, int n, glm::vec3* out) const
+{
+	if (getNbSegments(curve) == 0)
+	{
+		fill(out, out + n, glm::vec3(0.0f));
+		return;
+	}
+
+	parallelFor((n + LANES - 1) / LANES, [&](int first, int last) { evaluateGroups(curve, first, last, us, n, out); });
+}
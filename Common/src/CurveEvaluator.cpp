@@ -0,0 +1,374 @@
+#include "CurveEvaluator.h"
+
+#include <algorithm>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define CURVE_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CURVE_WIDTH 4
+#else
+#define CURVE_WIDTH 1
+#endif
+
+// O SIMD grava os pontos atravs de &out[0].x, como um array de floats
+static_assert(sizeof(glm::vec3) == 12, "glm::vec3 deve ser 3 floats sem preenchimento");
+
+CurveSegment CurveEvaluator::coefficients(const glm::mat4x3& G, const glm::mat4& M)
+{
+	glm::mat4x3 C = G * M;
+
+	CurveSegment s;
+	s.a = C[0];
+	s.b = C[1];
+	s.c = C[2];
+	s.d = C[3];
+	return s;
+}
+
+int CurveEvaluator::getSimdWidth()
+{
+	return CURVE_WIDTH;
+}
+
+void CurveEvaluator::evaluate(const CurveSegment& s, int n, glm::vec3* out)
+{
+	// Medido com Microbench::curves (10^6 amostras): com AVX o SIMD leva 0,6 ms contra 1,5 ms das
+	// diferenas progressivas; com SSE, 4 amostras por vez no compensam a montagem dos
+	// registradores (2,4 ms contra 1,5 ms), e sem SIMD as diferenas tambm ganham do Horner
+#if CURVE_WIDTH == 8
+	evaluateSimd(s, n, out);
+#else
+	evaluateForward(s, n, out);
+#endif
+}
+
+void CurveEvaluator::evaluateHorner(const CurveSegment& s, int n, glm::vec3* out)
+{
+	for (int k = 0; k < n; k++)
+		out[k] = point(s, (float)k / n);
+
+	out[n] = s.a + s.b + s.c + s.d;
+}
+
+void CurveEvaluator::evaluateForward(const CurveSegment& s, int n, glm::vec3* out)
+{
+	double h = 1.0 / n, h2 = h * h, h3 = h2 * h;
+
+	// p e suas trs diferenas em t = 0
+	glm::dvec3 a(s.a), b(s.b), c(s.c);
+	glm::dvec3 p(s.d);
+	glm::dvec3 d1 = a * h3 + b * h2 + c * h;
+	glm::dvec3 d2 = a * (6.0 * h3) + b * (2.0 * h2);
+	glm::dvec3 d3 = a * (6.0 * h3);
+
+	for (int k = 0; k < n; k++)
+	{
+		out[k] = glm::vec3(p);
+		p += d1;
+		d1 += d2;
+		d2 += d3;
+	}
+
+	out[n] = s.a + s.b + s.c + s.d;
+}
+
+#if CURVE_WIDTH == 8
+
+static inline __m256 madd(__m256 x, __m256 y, __m256 z)
+{
+#if defined(__FMA__)
+	return _mm256_fmadd_ps(x, y, z);
+#else
+	return _mm256_add_ps(_mm256_mul_ps(x, y), z);
+#endif
+}
+
+void CurveEvaluator::evaluateSimd(const CurveSegment& s, int n, glm::vec3* out)
+{
+	// Float f do bloco pertence  amostra f / 3, componente f % 3
+	__m256 a[3], b[3], c[3], d[3], offset[3];
+	for (int r = 0; r < 3; r++)
+	{
+		float la[8], lb[8], lc[8], ld[8], lo[8];
+		for (int l = 0; l < 8; l++)
+		{
+			int f = r * 8 + l;
+			la[l] = s.a[f % 3];
+			lb[l] = s.b[f % 3];
+			lc[l] = s.c[f % 3];
+			ld[l] = s.d[f % 3];
+			lo[l] = (float)(f / 3);
+		}
+		a[r] = _mm256_loadu_ps(la);
+		b[r] = _mm256_loadu_ps(lb);
+		c[r] = _mm256_loadu_ps(lc);
+		d[r] = _mm256_loadu_ps(ld);
+		offset[r] = _mm256_loadu_ps(lo);
+	}
+
+	__m256 inverse = _mm256_set1_ps(1.0f / n);
+	float* dst = &out[0].x;
+
+	int k = 0;
+	for (; k + 8 <= n; k += 8)
+	{
+		__m256 base = _mm256_set1_ps((float)k);
+
+		for (int r = 0; r < 3; r++)
+		{
+			__m256 t = _mm256_mul_ps(_mm256_add_ps(base, offset[r]), inverse);
+			__m256 p = madd(madd(madd(a[r], t, b[r]), t, c[r]), t, d[r]);
+			_mm256_storeu_ps(dst + k * 3 + r * 8, p);
+		}
+	}
+
+	for (; k < n; k++)
+		out[k] = point(s, (float)k / n);
+
+	out[n] = s.a + s.b + s.c + s.d;
+}
+
+#elif CURVE_WIDTH == 4
+
+void CurveEvaluator::evaluateSimd(const CurveSegment& s, int n, glm::vec3* out)
+{
+	// Float f do bloco pertence  amostra f / 3, componente f % 3
+	__m128 a[3], b[3], c[3], d[3], offset[3];
+	for (int r = 0; r < 3; r++)
+	{
+		float la[4], lb[4], lc[4], ld[4], lo[4];
+		for (int l = 0; l < 4; l++)
+		{
+			int f = r * 4 + l;
+			la[l] = s.a[f % 3];
+			lb[l] = s.b[f % 3];
+			lc[l] = s.c[f % 3];
+			ld[l] = s.d[f % 3];
+			lo[l] = (float)(f / 3);
+		}
+		a[r] = _mm_loadu_ps(la);
+		b[r] = _mm_loadu_ps(lb);
+		c[r] = _mm_loadu_ps(lc);
+		d[r] = _mm_loadu_ps(ld);
+		offset[r] = _mm_loadu_ps(lo);
+	}
+
+	__m128 inverse = _mm_set1_ps(1.0f / n);
+	float* dst = &out[0].x;
+
+	int k = 0;
+	for (; k + 4 <= n; k += 4)
+	{
+		__m128 base = _mm_set1_ps((float)k);
+
+		for (int r = 0; r < 3; r++)
+		{
+			__m128 t = _mm_mul_ps(_mm_add_ps(base, offset[r]), inverse);
+			__m128 p = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(a[r], t), b[r]), t), c[r]), t), d[r]);
+			_mm_storeu_ps(dst + k * 3 + r * 4, p);
+		}
+	}
+
+	for (; k < n; k++)
+		out[k] = point(s, (float)k / n);
+
+	out[n] = s.a + s.b + s.c + s.d;
+}
+
+#else
+
+void CurveEvaluator::evaluateSimd(const CurveSegment& s, int n, glm::vec3* out)
+{
+	// Sem SSE: Horner escalar
+	evaluateHorner(s, n, out);
+}
+
+#endif
+
+float CurveEvaluator::arcLength(const CurveSegment& s, float t0, float t1)
+{
+	static const float nodes[5] = { 0.0f, -0.5384693101f, 0.5384693101f, -0.9061798459f, 0.9061798459f };
+	static const float weights[5] = { 0.5688888889f, 0.4786286705f, 0.4786286705f, 0.2369268851f, 0.2369268851f };
+
+	float half = (t1 - t0) * 0.5f, middle = (t0 + t1) * 0.5f;
+	float length = 0.0f;
+
+	for (int i = 0; i < 5; i++)
+		length += weights[i] * glm::length(derivative(s, middle + half * nodes[i]));
+
+	return length * half;
+}
+
+bool CurveEvaluator::measured(const Projection& projection, const glm::vec3& p, glm::vec3& out)
+{
+	if (!projection.enabled)
+	{
+		out = p;
+		return true;
+	}
+
+	glm::vec4 clip = projection.viewProjection * glm::vec4(p, 1.0f);
+
+	if (clip.w <= 1e-6f)
+		return false;
+
+	// Pixels na tela (z fica 0: s a distncia na tela importa)
+	glm::vec2 ndc = glm::vec2(clip) / clip.w;
+	out = glm::vec3((ndc * 0.5f + 0.5f) * projection.viewport, 0.0f);
+	return true;
+}
+
+int CurveEvaluator::clipCode(const glm::vec4& clip)
+{
+	int code = 0;
+	if (clip.x < -clip.w) code |= 1;
+	if (clip.x > clip.w) code |= 2;
+	if (clip.y < -clip.w) code |= 4;
+	if (clip.y > clip.w) code |= 8;
+	if (clip.z < -clip.w) code |= 16;
+	if (clip.z > clip.w) code |= 32;
+	if (clip.w <= 1e-6f) code |= BEHIND;
+	return code;
+}
+
+float CurveEvaluator::distanceToSegment(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b)
+{
+	glm::vec3 ab = b - a;
+	float length2 = glm::dot(ab, ab);
+	float t = length2 > 0.0f ? glm::clamp(glm::dot(p - a, ab) / length2, 0.0f, 1.0f) : 0.0f;
+
+	return glm::length(p - (a + ab * t));
+}
+
+void CurveEvaluator::subdivide(const glm::vec3 B[4], float t0, float t1, int depth, float tolerance, const Projection& projection,
+	vector<float>& params)
+{
+	glm::vec3 P[4];
+	int outside = ~0, crossing = 0;
+
+	if (projection.enabled)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			int code = clipCode(projection.viewProjection * glm::vec4(B[i], 1.0f));
+			outside &= code;
+			crossing |= code;
+		}
+	}
+	else
+		outside = 0;
+
+	// Os quatro pontos fora do mesmo plano de recorte (atrs da cmera inclusive): a curva, dentro
+	// do fecho convexo deles, tambm est, e basta a corda
+	if (outside)
+	{
+		params.push_back(t1);
+		return;
+	}
+
+	bool flat;
+	if (crossing & BEHIND)
+	{
+		// Cruza o plano do olho: a tolerncia em pixels no faz sentido para os pontos de trs. S a
+		// metade que cruza continua assim (a da frente  medida na tela e a de trs  descartada acima),
+		// ento o limite de profundidade menor basta para no gastar vrtices perto do olho
+		flat = depth >= NEAR_PLANE_DEPTH;
+	}
+	else
+	{
+		for (int i = 0; i < 4; i++)
+			measured(projection, B[i], P[i]);
+		flat = max(distanceToSegment(P[1], P[0], P[3]), distanceToSegment(P[2], P[0], P[3])) <= tolerance;
+	}
+
+	if (flat || depth >= MAX_DEPTH)
+	{
+		params.push_back(t1);
+		return;
+	}
+
+	// de Casteljau em t = 0.5
+	glm::vec3 b01 = (B[0] + B[1]) * 0.5f, b12 = (B[1] + B[2]) * 0.5f, b23 = (B[2] + B[3]) * 0.5f;
+	glm::vec3 b012 = (b01 + b12) * 0.5f, b123 = (b12 + b23) * 0.5f;
+	glm::vec3 middle = (b012 + b123) * 0.5f;
+
+	glm::vec3 left[4] = { B[0], b01, b012, middle };
+	glm::vec3 right[4] = { middle, b123, b23, B[3] };
+	float tm = (t0 + t1) * 0.5f;
+
+	subdivide(left, t0, tm, depth + 1, tolerance, projection, params);
+	subdivide(right, tm, t1, depth + 1, tolerance, projection, params);
+}
+
+void CurveEvaluator::tessellate(const CurveSegment& s, float tolerance, vector<float>& params)
+{
+	Projection projection;
+	projection.enabled = false;
+
+	// Forma de Bezier do polinmio
+	glm::vec3 B[4] = { s.d, s.d + s.c / 3.0f, s.d + s.c * (2.0f / 3.0f) + s.b / 3.0f, s.a + s.b + s.c + s.d };
+
+	params.push_back(0.0f);
+	subdivide(B, 0.0f, 1.0f, 0, tolerance, projection, params);
+}
+
+void CurveEvaluator::tessellate(const CurveSegment& s, float pixelTolerance, const glm::mat4& viewProjection, const glm::vec2& viewport,
+	vector<float>& params)
+{
+	Projection projection;
+	projection.enabled = true;
+	projection.viewProjection = viewProjection;
+	projection.viewport = viewport;
+
+	glm::vec3 B[4] = { s.d, s.d + s.c / 3.0f, s.d + s.c * (2.0f / 3.0f) + s.b / 3.0f, s.a + s.b + s.c + s.d };
+
+	params.push_back(0.0f);
+	subdivide(B, 0.0f, 1.0f, 0, pixelTolerance, projection, params);
+}
+
+float CurveEvaluator::chordError(const CurveSegment& s, const vector<float>& params, const Projection& projection)
+{
+	const int samplesPerEdge = 16;
+	float error = 0.0f;
+
+	for (size_t e = 0; e + 1 < params.size(); e++)
+	{
+		glm::vec3 a, b;
+		if (!measured(projection, point(s, params[e]), a) || !measured(projection, point(s, params[e + 1]), b))
+			continue;
+
+		for (int k = 1; k < samplesPerEdge; k++)
+		{
+			glm::vec3 q = point(s, params[e] + (params[e + 1] - params[e]) * k / samplesPerEdge), p;
+
+			// Fora da tela o erro no aparece (e os trechos fora do frustum viram uma aresta s)
+			if (projection.enabled && clipCode(projection.viewProjection * glm::vec4(q, 1.0f)) != 0)
+				continue;
+
+			if (measured(projection, q, p))
+				error = max(error, distanceToSegment(p, a, b));
+		}
+	}
+
+	return error;
+}
+
+float CurveEvaluator::chordError(const CurveSegment& s, const vector<float>& params)
+{
+	Projection projection;
+	projection.enabled = false;
+
+	return chordError(s, params, projection);
+}
+
+float CurveEvaluator::chordError(const CurveSegment& s, const vector<float>& params, const glm::mat4& viewProjection, const glm::vec2& viewport)
+{
+	Projection projection;
+	projection.enabled = true;
+	projection.viewProjection = viewProjection;
+	projection.viewport = viewport;
+
+	return chordError(s, params, projection);
+}
@@ -0,0 +1,189 @@
+#include "FrustumCuller.h"
+
+#include <chrono>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define CULL_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CULL_WIDTH 4
+#else
+#define CULL_WIDTH 1
+#endif
+
+void FrustumCuller::setFrustum(const glm::mat4& viewProjection)
+{
+	// Linhas da matriz (a GLM guarda por coluna)
+	glm::vec4 row[4];
+	for (int r = 0; r < 4; r++)
+		row[r] = glm::vec4(viewProjection[0][r], viewProjection[1][r], viewProjection[2][r], viewProjection[3][r]);
+
+	planes[0] = row[3] + row[0]; // esquerdo
+	planes[1] = row[3] - row[0]; // direito
+	planes[2] = row[3] + row[1]; // inferior
+	planes[3] = row[3] - row[1]; // superior
+	planes[4] = row[3] + row[2]; // prximo
+	planes[5] = row[3] - row[2]; // distante
+
+	for (int p = 0; p < 6; p++)
+		planes[p] /= glm::length(glm::vec3(planes[p]));
+}
+
+void FrustumCuller::begin()
+{
+	sphereX.clear();
+	sphereY.clear();
+	sphereZ.clear();
+	sphereR.clear();
+	boxX.clear();
+	boxY.clear();
+	boxZ.clear();
+	extentX.clear();
+	extentY.clear();
+	extentZ.clear();
+	visible.clear();
+	nbVisible = 0;
+}
+
+int FrustumCuller::add(const MeshBounds& bounds, const glm::mat4& model)
+{
+	BoundingSphere sphere = bounds.sphere.transformed(model);
+	AABB box = bounds.box.transformed(model);
+	glm::vec3 center = box.center(), extents = box.extents();
+
+	sphereX.push_back(sphere.center.x);
+	sphereY.push_back(sphere.center.y);
+	sphereZ.push_back(sphere.center.z);
+	sphereR.push_back(sphere.radius);
+	boxX.push_back(center.x);
+	boxY.push_back(center.y);
+	boxZ.push_back(center.z);
+	extentX.push_back(extents.x);
+	extentY.push_back(extents.y);
+	extentZ.push_back(extents.z);
+	visible.push_back(1);
+
+	return visible.size() - 1;
+}
+
+int FrustumCuller::getSimdWidth()
+{
+	return CULL_WIDTH;
+}
+
+void FrustumCuller::cull()
+{
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+
+	size_t first = 0;
+	cullSimd(first);
+	cullScalar(first, visible.size());
+
+	nbVisible = 0;
+	for (size_t i = 0; i < visible.size(); i++)
+		nbVisible += visible[i];
+
+	lastCullMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+}
+
+void FrustumCuller::cullScalar(size_t first, size_t last)
+{
+	for (size_t i = first; i < last; i++)
+	{
+		bool inside = true;
+
+		for (int p = 0; p < 6 && inside; p++)
+		{
+			const glm::vec4& plane = planes[p];
+
+			float sphereDistance = plane.x * sphereX[i] + plane.y * sphereY[i] + plane.z * sphereZ[i] + plane.w;
+			float boxDistance = plane.x * boxX[i] + plane.y * boxY[i] + plane.z * boxZ[i] + plane.w;
+			float boxRadius = fabs(plane.x) * extentX[i] + fabs(plane.y) * extentY[i] + fabs(plane.z) * extentZ[i];
+
+			inside = sphereDistance >= -sphereR[i] && boxDistance >= -boxRadius;
+		}
+
+		visible[i] = inside ? 1 : 0;
+	}
+}
+
+#if CULL_WIDTH == 8
+
+void FrustumCuller::cullSimd(size_t& first)
+{
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+	size_t n = visible.size();
+
+	for (; first + 8 <= n; first += 8)
+	{
+		__m256 sx = _mm256_loadu_ps(&sphereX[first]), sy = _mm256_loadu_ps(&sphereY[first]), sz = _mm256_loadu_ps(&sphereZ[first]);
+		__m256 negR = _mm256_xor_ps(_mm256_loadu_ps(&sphereR[first]), signMask);
+		__m256 bx = _mm256_loadu_ps(&boxX[first]), by = _mm256_loadu_ps(&boxY[first]), bz = _mm256_loadu_ps(&boxZ[first]);
+		__m256 ex = _mm256_loadu_ps(&extentX[first]), ey = _mm256_loadu_ps(&extentY[first]), ez = _mm256_loadu_ps(&extentZ[first]);
+		__m256 outside = _mm256_setzero_ps();
+
+		for (int p = 0; p < 6; p++)
+		{
+			__m256 nx = _mm256_set1_ps(planes[p].x), ny = _mm256_set1_ps(planes[p].y), nz = _mm256_set1_ps(planes[p].z);
+			__m256 d = _mm256_set1_ps(planes[p].w);
+			__m256 ax = _mm256_andnot_ps(signMask, nx), ay = _mm256_andnot_ps(signMask, ny), az = _mm256_andnot_ps(signMask, nz);
+
+			__m256 sphereDistance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, sx), _mm256_mul_ps(ny, sy)), _mm256_add_ps(_mm256_mul_ps(nz, sz), d));
+			__m256 boxDistance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, bx), _mm256_mul_ps(ny, by)), _mm256_add_ps(_mm256_mul_ps(nz, bz), d));
+			__m256 boxRadius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax, ex), _mm256_mul_ps(ay, ey)), _mm256_mul_ps(az, ez));
+
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(sphereDistance, negR, _CMP_LT_OQ));
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(boxDistance, boxRadius), _mm256_setzero_ps(), _CMP_LT_OQ));
+		}
+
+		int mask = _mm256_movemask_ps(outside);
+		for (int k = 0; k < 8; k++)
+			visible[first + k] = (mask >> k) & 1 ? 0 : 1;
+	}
+}
+
+#elif CULL_WIDTH == 4
+
+void FrustumCuller::cullSimd(size_t& first)
+{
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	size_t n = visible.size();
+
+	for (; first + 4 <= n; first += 4)
+	{
+		__m128 sx = _mm_loadu_ps(&sphereX[first]), sy = _mm_loadu_ps(&sphereY[first]), sz = _mm_loadu_ps(&sphereZ[first]);
+		__m128 negR = _mm_xor_ps(_mm_loadu_ps(&sphereR[first]), signMask);
+		__m128 bx = _mm_loadu_ps(&boxX[first]), by = _mm_loadu_ps(&boxY[first]), bz = _mm_loadu_ps(&boxZ[first]);
+		__m128 ex = _mm_loadu_ps(&extentX[first]), ey = _mm_loadu_ps(&extentY[first]), ez = _mm_loadu_ps(&extentZ[first]);
+		__m128 outside = _mm_setzero_ps();
+
+		for (int p = 0; p < 6; p++)
+		{
+			__m128 nx = _mm_set1_ps(planes[p].x), ny = _mm_set1_ps(planes[p].y), nz = _mm_set1_ps(planes[p].z);
+			__m128 d = _mm_set1_ps(planes[p].w);
+			__m128 ax = _mm_andnot_ps(signMask, nx), ay = _mm_andnot_ps(signMask, ny), az = _mm_andnot_ps(signMask, nz);
+
+			__m128 sphereDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, sx), _mm_mul_ps(ny, sy)), _mm_add_ps(_mm_mul_ps(nz, sz), d));
+			__m128 boxDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, bx), _mm_mul_ps(ny, by)), _mm_add_ps(_mm_mul_ps(nz, bz), d));
+			__m128 boxRadius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, ex), _mm_mul_ps(ay, ey)), _mm_mul_ps(az, ez));
+
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(sphereDistance, negR));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(boxDistance, boxRadius), _mm_setzero_ps()));
+		}
+
+		int mask = _mm_movemask_ps(outside);
+		for (int k = 0; k < 4; k++)
+			visible[first + k] = (mask >> k) & 1 ? 0 : 1;
+	}
+}
+
+#else
+
+void FrustumCuller::cullSimd(size_t& first)
+{
+	// Sem SSE: tudo fica para o caminho escalar
+}
+
+#endif
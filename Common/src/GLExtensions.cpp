@@ -0,0 +1,83 @@
+#include "GLExtensions.h"
+
+#include <iostream>
+#include <cstring>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+using namespace std;
+
+PFNGLBUFFERSTORAGEPROC GLExtensions::bufferStorage = NULL;
+PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC GLExtensions::drawElementsInstancedBaseVertexBaseInstance = NULL;
+PFNGLMULTIDRAWELEMENTSINDIRECTPROC GLExtensions::multiDrawElementsIndirect = NULL;
+PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC GLExtensions::multiDrawElementsIndirectCount = NULL;
+PFNGLDISPATCHCOMPUTEPROC GLExtensions::dispatchCompute = NULL;
+PFNGLMEMORYBARRIERPROC GLExtensions::memoryBarrier = NULL;
+PFNGLPATCHPARAMETERIPROC GLExtensions::patchParameteri = NULL;
+
+// Alguns drivers devolvem ponteiros no nulos para funes que no suportam, ento a verso do
+// contexto (ou a extenso equivalente)  conferida antes de usar o ponteiro
+static bool supports(int major, int minor, const char* extension)
+{
+	GLint contextMajor = 0, contextMinor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &contextMajor);
+	glGetIntegerv(GL_MINOR_VERSION, &contextMinor);
+
+	if (contextMajor > major || (contextMajor == major && contextMinor >= minor))
+		return true;
+
+	GLint nbExtensions = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &nbExtensions);
+
+	for (GLint i = 0; i < nbExtensions; i++)
+	{
+		const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if (name && strcmp(name, extension) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+void GLExtensions::load(GLADloadproc getProcAddress)
+{
+	if (!getProcAddress)
+		getProcAddress = (GLADloadproc)glfwGetProcAddress;
+
+	if (supports(4, 4, "GL_ARB_buffer_storage"))
+		bufferStorage = (PFNGLBUFFERSTORAGEPROC)getProcAddress("glBufferStorage");
+
+	if (supports(4, 2, "GL_ARB_base_instance"))
+		drawElementsInstancedBaseVertexBaseInstance = (PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC)getProcAddress("glDrawElementsInstancedBaseVertexBaseInstance");
+
+	if (supports(4, 3, "GL_ARB_multi_draw_indirect"))
+		multiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)getProcAddress("glMultiDrawElementsIndirect");
+
+	// Na extenso ARB a funo tem o sufixo ARB; no ncleo (4.6), no
+	if (supports(4, 6, "GL_ARB_indirect_parameters"))
+	{
+		multiDrawElementsIndirectCount = (PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC)getProcAddress("glMultiDrawElementsIndirectCount");
+		if (!multiDrawElementsIndirectCount)
+			multiDrawElementsIndirectCount = (PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC)getProcAddress("glMultiDrawElementsIndirectCountARB");
+	}
+
+	if (supports(4, 3, "GL_ARB_compute_shader"))
+	{
+		dispatchCompute = (PFNGLDISPATCHCOMPUTEPROC)getProcAddress("glDispatchCompute");
+		memoryBarrier = (PFNGLMEMORYBARRIERPROC)getProcAddress("glMemoryBarrier");
+	}
+
+	if (supports(4, 0, "GL_ARB_tessellation_shader"))
+		patchParameteri = (PFNGLPATCHPARAMETERIPROC)getProcAddress("glPatchParameteri");
+}
+
+void GLExtensions::printSupport()
+{
+	cout << "glBufferStorage (4.4): " << (bufferStorage ? "sim" : "nao") << endl;
+	cout << "glDrawElementsInstancedBaseVertexBaseInstance (4.2): " << (drawElementsInstancedBaseVertexBaseInstance ? "sim" : "nao") << endl;
+	cout << "glMultiDrawElementsIndirect (4.3): " << (multiDrawElementsIndirect ? "sim" : "nao") << endl;
+	cout << "glMultiDrawElementsIndirectCount (4.6): " << (multiDrawElementsIndirectCount ? "sim" : "nao") << endl;
+	cout << "glDispatchCompute (4.3): " << (dispatchCompute ? "sim" : "nao") << endl;
+	cout << "glPatchParameteri (4.0): " << (patchParameteri ? "sim" : "nao") << endl;
+}
@@ -0,0 +1,224 @@
+#include "GLState.h"
+
+GLuint GLState::program = GLState::UNKNOWN;
+GLuint GLState::vertexArray = GLState::UNKNOWN;
+GLenum GLState::activeUnit = GLState::UNKNOWN;
+GLuint GLState::textures[GLState::MAX_TEXTURE_UNITS][GLState::TEXTURE_TARGETS];
+int GLState::caps[GLState::TRACKED_CAPS] = { -1, -1, -1 };
+GLenum GLState::blendSrc = GLState::UNKNOWN;
+GLenum GLState::blendDst = GLState::UNKNOWN;
+int GLState::depthWrite = -1;
+GLfloat GLState::currentLineWidth = -1.0f;
+GLfloat GLState::currentPointSize = -1.0f;
+
+unsigned long long GLState::filteredCalls = 0;
+unsigned long long GLState::forwardedCalls = 0;
+
+// Garante que a tabela de texturas comea como "desconhecida"
+static struct GLStateTexturesInit
+{
+	GLStateTexturesInit() { GLState::invalidate(); }
+} glStateTexturesInit;
+
+bool GLState::changed(bool differs)
+{
+	if (differs)
+		forwardedCalls++;
+	else
+		filteredCalls++;
+
+	return differs;
+}
+
+int GLState::targetIndex(GLenum target)
+{
+	switch (target)
+	{
+	case GL_TEXTURE_2D: return 0;
+	case GL_TEXTURE_BUFFER: return 1;
+	case GL_TEXTURE_CUBE_MAP: return 2;
+	case GL_TEXTURE_2D_ARRAY: return 3;
+	default: return -1;
+	}
+}
+
+int GLState::capIndex(GLenum cap)
+{
+	switch (cap)
+	{
+	case GL_DEPTH_TEST: return 0;
+	case GL_BLEND: return 1;
+	case GL_CULL_FACE: return 2;
+	default: return -1;
+	}
+}
+
+void GLState::useProgram(GLuint program)
+{
+	if (changed(GLState::program != program))
+	{
+		glUseProgram(program);
+		GLState::program = program;
+	}
+}
+
+void GLState::bindVertexArray(GLuint vao)
+{
+	if (changed(vertexArray != vao))
+	{
+		glBindVertexArray(vao);
+		vertexArray = vao;
+	}
+}
+
+void GLState::activeTexture(GLenum unit)
+{
+	if (changed(activeUnit != unit))
+	{
+		glActiveTexture(unit);
+		activeUnit = unit;
+	}
+}
+
+void GLState::bindTexture(GLenum target, GLuint texture)
+{
+	int t = targetIndex(target);
+	int unit = activeUnit == UNKNOWN ? -1 : (int)(activeUnit - GL_TEXTURE0);
+
+	// Alvo ou unidade fora do que  rastreado: repassa sempre
+	if (t < 0 || unit < 0 || unit >= MAX_TEXTURE_UNITS)
+	{
+		forwardedCalls++;
+		glBindTexture(target, texture);
+		return;
+	}
+
+	if (changed(textures[unit][t] != texture))
+	{
+		glBindTexture(target, texture);
+		textures[unit][t] = texture;
+	}
+}
+
+void GLState::bindTextureUnit(GLuint unit, GLenum target, GLuint texture)
+{
+	activeTexture(GL_TEXTURE0 + unit);
+	bindTexture(target, texture);
+}
+
+void GLState::enable(GLenum cap)
+{
+	int c = capIndex(cap);
+
+	if (c < 0)
+	{
+		forwardedCalls++;
+		glEnable(cap);
+	}
+	else if (changed(caps[c] != 1))
+	{
+		glEnable(cap);
+		caps[c] = 1;
+	}
+}
+
+void GLState::disable(GLenum cap)
+{
+	int c = capIndex(cap);
+
+	if (c < 0)
+	{
+		forwardedCalls++;
+		glDisable(cap);
+	}
+	else if (changed(caps[c] != 0))
+	{
+		glDisable(cap);
+		caps[c] = 0;
+	}
+}
+
+void GLState::blendFunc(GLenum sfactor, GLenum dfactor)
+{
+	if (changed(blendSrc != sfactor || blendDst != dfactor))
+	{
+		glBlendFunc(sfactor, dfactor);
+		blendSrc = sfactor;
+		blendDst = dfactor;
+	}
+}
+
+void GLState::depthMask(GLboolean flag)
+{
+	if (changed(depthWrite != (flag ? 1 : 0)))
+	{
+		glDepthMask(flag);
+		depthWrite = flag ? 1 : 0;
+	}
+}
+
+void GLState::lineWidth(GLfloat width)
+{
+	if (changed(currentLineWidth != width))
+	{
+		glLineWidth(width);
+		currentLineWidth = width;
+	}
+}
+
+void GLState::pointSize(GLfloat size)
+{
+	if (changed(currentPointSize != size))
+	{
+		glPointSize(size);
+		currentPointSize = size;
+	}
+}
+
+void GLState::invalidate()
+{
+	program = UNKNOWN;
+	vertexArray = UNKNOWN;
+	activeUnit = UNKNOWN;
+
+	for (int u = 0; u < MAX_TEXTURE_UNITS; u++)
+		for (int t = 0; t < TEXTURE_TARGETS; t++)
+			textures[u][t] = UNKNOWN;
+
+	for (int c = 0; c < TRACKED_CAPS; c++)
+		caps[c] = -1;
+
+	blendSrc = blendDst = UNKNOWN;
+	depthWrite = -1;
+	currentLineWidth = currentPointSize = -1.0f;
+}
+
+void GLState::forgetProgram(GLuint program)
+{
+	if (GLState::program == program)
+		GLState::program = UNKNOWN;
+}
+
+void GLState::forgetVertexArray(GLuint vao)
+{
+	if (vertexArray == vao)
+		vertexArray = UNKNOWN;
+}
+
+void GLState::forgetTexture(GLuint texture)
+{
+	for (int u = 0; u < MAX_TEXTURE_UNITS; u++)
+		for (int t = 0; t < TEXTURE_TARGETS; t++)
+			if (textures[u][t] == texture)
+				textures[u][t] = UNKNOWN;
+}
+
+void GLState::printStats()
+{
+	unsigned long long total = filteredCalls + forwardedCalls;
+
+	cout << "GLState: " << forwardedCalls << " chamadas repassadas, " << filteredCalls << " filtradas";
+	if (total > 0)
+		cout << " (" << (100.0 * filteredCalls / total) << "%)";
+	cout << endl;
+}
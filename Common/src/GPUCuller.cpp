@@ -0,0 +1,238 @@
+#include "GPUCuller.h"
+
+// Unidade de textura da pirmide Hi-Z (a 0 fica com as texturas dos objetos)
+static const GLuint HIZ_UNIT = 1;
+
+bool GPUCuller::isSupported()
+{
+	return GLExtensions::dispatchCompute && GLExtensions::memoryBarrier && GLExtensions::multiDrawElementsIndirect;
+}
+
+bool GPUCuller::create(const string& computePath, MeshPool& pool)
+{
+	this->pool = &pool;
+
+	string code;
+	if (!Shader::readSource(computePath, code))
+	{
+		cout << "GPUCuller: nao foi possivel ler " << computePath << endl;
+		return false;
+	}
+
+	bool linked;
+	program = Shader::buildComputeProgram(code, linked);
+	if (!linked)
+	{
+		glDeleteProgram(program);
+		program = 0;
+		return false;
+	}
+
+	locations.nbObjects = glGetUniformLocation(program, "nbObjects");
+	locations.planes = glGetUniformLocation(program, "planes");
+	locations.viewProjection = glGetUniformLocation(program, "viewProjection");
+	locations.compact = glGetUniformLocation(program, "compact");
+	locations.occlusion = glGetUniformLocation(program, "occlusion");
+	locations.hiZ = glGetUniformLocation(program, "hiZ");
+	locations.hiZLevels = glGetUniformLocation(program, "hiZLevels");
+	locations.hiZSize = glGetUniformLocation(program, "hiZSize");
+
+	// Tabela de malhas: (indexCount, firstIndex, baseVertex, -) em std430
+	vector<GLint> meshes;
+	for (int m = 0; m < pool.getNbMeshes(); m++)
+	{
+		const MeshRange& range = pool.getMesh(m);
+		meshes.push_back(range.indexCount);
+		meshes.push_back(range.firstIndex);
+		meshes.push_back(range.baseVertex);
+		meshes.push_back(0);
+	}
+
+	glGenBuffers(1, &meshBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, meshBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, meshes.size() * sizeof(GLint), meshes.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	glGenBuffers(1, &counterBuffer);
+	glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+	glBufferData(GL_ATOMIC_COUNTER_BUFFER, sizeof(GLuint), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+
+	return true;
+}
+
+void GPUCuller::destroy()
+{
+	GLuint buffers[] = { objectBuffer, meshBuffer, instanceBuffer, commandBuffer, counterBuffer };
+	glDeleteBuffers(5, buffers);
+	objectBuffer = meshBuffer = instanceBuffer = commandBuffer = counterBuffer = 0;
+
+	if (hiZTexture)
+	{
+		GLState::forgetTexture(hiZTexture);
+		glDeleteTextures(1, &hiZTexture);
+		hiZTexture = 0;
+	}
+
+	if (program)
+	{
+		GLState::forgetProgram(program);
+		glDeleteProgram(program);
+		program = 0;
+	}
+}
+
+int GPUCuller::addObject(int mesh, const glm::mat4& model, int material, int layer)
+{
+	GPUObject object;
+	object.params = glm::vec4((float)material, (float)layer, (float)mesh, 0.0f);
+	place(object, model);
+	objects.push_back(object);
+
+	return objects.size() - 1;
+}
+
+void GPUCuller::place(GPUObject& object, const glm::mat4& model)
+{
+	const MeshBounds& bounds = pool->getMesh((int)object.params.z).bounds;
+	BoundingSphere sphere = bounds.sphere.transformed(model);
+	AABB box = bounds.box.transformed(model);
+
+	object.model = model;
+	object.sphere = glm::vec4(sphere.center, sphere.radius);
+	object.boxMin = glm::vec4(box.min, 1.0f);
+	object.boxMax = glm::vec4(box.max, 1.0f);
+}
+
+void GPUCuller::upload()
+{
+	size_t n = objects.size();
+
+	glGenBuffers(1, &objectBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, n * sizeof(GPUObject), objects.data(), GL_DYNAMIC_DRAW);
+
+	// Preenchidos pelo compute shader a cada quadro
+	glGenBuffers(1, &instanceBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, n * sizeof(InstanceData), NULL, GL_DYNAMIC_COPY);
+
+	glGenBuffers(1, &commandBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, n * sizeof(DrawElementsIndirectCommand), NULL, GL_DYNAMIC_COPY);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GPUCuller::updateObject(int object, const glm::mat4& model)
+{
+	GPUObject& o = objects[object];
+	place(o, model);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, object * sizeof(GPUObject), sizeof(GPUObject), &o);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GPUCuller::setHiZ(const OcclusionCuller& occlusionCuller)
+{
+	bool created = hiZTexture != 0 && hiZWidth == occlusionCuller.getWidth() && hiZHeight == occlusionCuller.getHeight();
+
+	if (hiZTexture == 0)
+		glGenTextures(1, &hiZTexture);
+
+	hiZLevels = occlusionCuller.getNbLevels();
+	hiZWidth = occlusionCuller.getWidth();
+	hiZHeight = occlusionCuller.getHeight();
+
+	GLState::bindTextureUnit(HIZ_UNIT, GL_TEXTURE_2D, hiZTexture);
+
+	for (int l = 0; l < hiZLevels; l++)
+	{
+		int w = occlusionCuller.getLevelWidth(l), h = occlusionCuller.getLevelHeight(l);
+		const float* data = occlusionCuller.getLevel(l).data();
+
+		if (created)
+			glTexSubImage2D(GL_TEXTURE_2D, l, 0, 0, w, h, GL_RED, GL_FLOAT, data);
+		else
+			glTexImage2D(GL_TEXTURE_2D, l, GL_R32F, w, h, 0, GL_RED, GL_FLOAT, data);
+	}
+
+	if (!created)
+	{
+		// S texelFetch  usado, mas a textura precisa estar completa
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, hiZLevels - 1);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	}
+}
+
+void GPUCuller::cull(const glm::mat4& viewProjection, const glm::vec4 planes[6])
+{
+	GLuint zero = 0;
+	glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+	glBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(GLuint), &zero);
+	glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+
+	GLState::useProgram(program);
+
+	glUniform1ui(locations.nbObjects, objects.size());
+	glUniform4fv(locations.planes, 6, glm::value_ptr(planes[0]));
+	glUniformMatrix4fv(locations.viewProjection, 1, GL_FALSE, glm::value_ptr(viewProjection));
+	glUniform1i(locations.compact, isCompacting());
+
+	bool useHiZ = occlusion && hiZTexture != 0;
+	glUniform1i(locations.occlusion, useHiZ);
+	if (useHiZ)
+	{
+		GLState::bindTextureUnit(HIZ_UNIT, GL_TEXTURE_2D, hiZTexture);
+		glUniform1i(locations.hiZ, HIZ_UNIT);
+		glUniform1i(locations.hiZLevels, hiZLevels);
+		glUniform2i(locations.hiZSize, hiZWidth, hiZHeight);
+	}
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, objectBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, meshBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, instanceBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, commandBuffer);
+	glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0, counterBuffer);
+
+	GLExtensions::dispatchCompute((objects.size() + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1);
+
+	// Os resultados so lidos como comandos, atributos de vrtice e parmetro do draw
+	GLExtensions::memoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ATOMIC_COUNTER_BARRIER_BIT);
+}
+
+void GPUCuller::draw()
+{
+	if (objects.empty())
+		return;
+
+	GLState::bindVertexArray(pool->getVAO());
+	InstanceData::pointAttributes(instanceBuffer, 0);
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+
+	if (isCompacting())
+	{
+		glBindBuffer(GL_PARAMETER_BUFFER, counterBuffer);
+		GLExtensions::multiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, 0, 0, objects.size(), 0);
+		glBindBuffer(GL_PARAMETER_BUFFER, 0);
+	}
+	else
+		GLExtensions::multiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, 0, objects.size(), 0);
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+int GPUCuller::readVisibleCount()
+{
+	GLuint count = 0;
+
+	glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+	glGetBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(GLuint), &count);
+	glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+
+	return count;
+}
@@ -0,0 +1,171 @@
+#include "GPUCurve.h"
+
+// Unidade de textura dos pontos de controle (a 0 fica com as texturas dos objetos e a 1 com a Hi-Z)
+static const GLuint POINTS_UNIT = 2;
+
+bool GPUCurve::create(const string& vertexPath, const string& fragmentPath)
+{
+	string vertexCode, fragmentCode;
+	if (!Shader::readSource(vertexPath, vertexCode) || !Shader::readSource(fragmentPath, fragmentCode))
+	{
+		cout << "GPUCurve: nao foi possivel ler " << vertexPath << " ou " << fragmentPath << endl;
+		return false;
+	}
+
+	bool linked;
+	program = Shader::buildProgram(vertexCode, fragmentCode, linked);
+	if (!linked)
+	{
+		glDeleteProgram(program);
+		program = 0;
+		return false;
+	}
+
+	locations = findLocations(program);
+
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &pointBuffer);
+	glGenTextures(1, &pointTexture);
+
+	return true;
+}
+
+bool GPUCurve::createTessellation(const string& vertexPath, const string& controlPath, const string& evaluationPath,
+	const string& geometryPath, const string& fragmentPath)
+{
+	if (!isTessellationSupported())
+		return false;
+
+	string vertexCode, controlCode, evaluationCode, geometryCode, fragmentCode;
+	if (!Shader::readSource(vertexPath, vertexCode) || !Shader::readSource(controlPath, controlCode) || !Shader::readSource(evaluationPath, evaluationCode) ||
+		!Shader::readSource(geometryPath, geometryCode) || !Shader::readSource(fragmentPath, fragmentCode))
+	{
+		cout << "GPUCurve: nao foi possivel ler os shaders de tesselacao (" << controlPath << ", " << evaluationPath << ")" << endl;
+		return false;
+	}
+
+	bool linked;
+	tessellationProgram = Shader::buildTessellationProgram(vertexCode, controlCode, evaluationCode, geometryCode, fragmentCode, linked);
+	if (!linked)
+	{
+		glDeleteProgram(tessellationProgram);
+		tessellationProgram = 0;
+		return false;
+	}
+
+	tessellationLocations = findLocations(tessellationProgram);
+	glGetIntegerv(GL_MAX_TESS_GEN_LEVEL, &maxTessellationLevel);
+
+	return true;
+}
+
+GPUCurve::Locations GPUCurve::findLocations(GLuint program)
+{
+	glUniformBlockBinding(program, glGetUniformBlockIndex(program, "Camera"), 0);
+
+	Locations l;
+	l.controlPoints = glGetUniformLocation(program, "controlPoints");
+	l.basis = glGetUniformLocation(program, "basis");
+	l.samplesPerSegment = glGetUniformLocation(program, "samplesPerSegment");
+	l.pixelsPerSample = glGetUniformLocation(program, "pixelsPerSample");
+	l.maxLevel = glGetUniformLocation(program, "maxLevel");
+	l.lineWidth = glGetUniformLocation(program, "lineWidth");
+	l.viewport = glGetUniformLocation(program, "viewport");
+	l.color = glGetUniformLocation(program, "color");
+	return l;
+}
+
+void GPUCurve::destroy()
+{
+	if (VAO)
+	{
+		GLState::forgetVertexArray(VAO);
+		glDeleteVertexArrays(1, &VAO);
+		VAO = 0;
+	}
+
+	if (pointTexture)
+	{
+		GLState::forgetTexture(pointTexture);
+		glDeleteTextures(1, &pointTexture);
+		pointTexture = 0;
+	}
+
+	glDeleteBuffers(1, &pointBuffer);
+	pointBuffer = 0;
+
+	GLuint programs[] = { program, tessellationProgram };
+	for (int p = 0; p < 2; p++)
+	{
+		if (programs[p])
+		{
+			GLState::forgetProgram(programs[p]);
+			glDeleteProgram(programs[p]);
+		}
+	}
+	program = tessellationProgram = 0;
+}
+
+void GPUCurve::upload(Curve& curve)
+{
+	const vector<glm::vec3>& points = curve.getControlPoints();
+	size_t size = points.size() * sizeof(glm::vec3);
+
+	nbControlPoints = points.size();
+	nbSegments = curve.getNbSegments();
+	basis = curve.getPointBasis();
+
+	glBindBuffer(GL_TEXTURE_BUFFER, pointBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, size, points.data(), GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	// O texture buffer guarda a referncia ao buffer: basta religar quando ele  realocado
+	GLState::bindTextureUnit(POINTS_UNIT, GL_TEXTURE_BUFFER, pointTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGB32F, pointBuffer);
+
+	uploadedBytes += size;
+}
+
+void GPUCurve::updateControlPoint(int k, const glm::vec3& p)
+{
+	if (k < 0 || k >= nbControlPoints)
+		return;
+
+	glBindBuffer(GL_TEXTURE_BUFFER, pointBuffer);
+	glBufferSubData(GL_TEXTURE_BUFFER, k * sizeof(glm::vec3), sizeof(glm::vec3), glm::value_ptr(p));
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	uploadedBytes += sizeof(glm::vec3);
+}
+
+void GPUCurve::draw(const glm::vec4& color)
+{
+	if (nbSegments == 0)
+		return;
+
+	bool tessellation = backend == TESSELLATION;
+	const Locations& l = tessellation ? tessellationLocations : locations;
+
+	GLState::useProgram(tessellation ? tessellationProgram : program);
+
+	GLState::bindTextureUnit(POINTS_UNIT, GL_TEXTURE_BUFFER, pointTexture);
+	glUniform1i(l.controlPoints, POINTS_UNIT);
+	glUniformMatrix4fv(l.basis, 1, GL_FALSE, glm::value_ptr(basis));
+	glUniform1i(l.samplesPerSegment, samplesPerSegment);
+	glUniform1f(l.pixelsPerSample, pixelsPerSample);
+	glUniform1f(l.maxLevel, (float)maxTessellationLevel);
+	glUniform1f(l.lineWidth, lineWidth);
+	glUniform2fv(l.viewport, 1, glm::value_ptr(viewport));
+	glUniform4fv(l.color, 1, glm::value_ptr(color));
+
+	GLState::bindVertexArray(VAO);
+
+	if (tessellation)
+	{
+		// Um patch por segmento; o vertex shader busca os pontos pelo gl_VertexID
+		GLExtensions::patchParameteri(GL_PATCH_VERTICES, 4);
+		glDrawArrays(GL_PATCHES, 0, 4 * nbSegments);
+	}
+	else
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 2 * (samplesPerSegment + 1), nbSegments);
+}
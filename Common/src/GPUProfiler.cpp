@@ -0,0 +1,303 @@
+#include "GPUProfiler.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+GPUProfiler::GPUProfiler(int window)
+	: window(max(1, window)), enabled(false), active(false), frameIndex(0), collectedFrames(0), droppedFrames(0)
+{
+	for (int f = 0; f < LATENCY_FRAMES; f++)
+	{
+		frames[f].used = 0;
+		frames[f].pending = false;
+	}
+}
+
+GPUProfiler::~GPUProfiler()
+{
+	for (int f = 0; f < LATENCY_FRAMES; f++)
+		if (!frames[f].queries.empty())
+			glDeleteQueries(frames[f].queries.size(), frames[f].queries.data());
+}
+
+void GPUProfiler::beginFrame()
+{
+	active = enabled;
+
+	if (!active)
+		return;
+
+	// O conjunto deste quadro  o mais antigo do anel
+	FrameQueries& frame = frames[frameIndex % LATENCY_FRAMES];
+
+	if (frame.pending)
+		collect(frame);
+
+	frame.used = 0;
+	frame.markers.clear();
+	openMarkers.clear();
+
+	begin("quadro");
+}
+
+void GPUProfiler::endFrame()
+{
+	if (!active)
+		return;
+
+	// Trechos esquecidos abertos so fechados junto com o quadro
+	while (!openMarkers.empty())
+		end();
+
+	frames[frameIndex % LATENCY_FRAMES].pending = true;
+	frameIndex++;
+	active = false;
+}
+
+int GPUProfiler::findScope(int parent, const string& name)
+{
+	for (size_t s = 0; s < scopes.size(); s++)
+		if (scopes[s].parent == parent && scopes[s].name == name)
+			return s;
+
+	ScopeStats scope;
+	scope.name = name;
+	scope.parent = parent;
+	scope.depth = parent < 0 ? 0 : scopes[parent].depth + 1;
+	scope.path = parent < 0 ? name : scopes[parent].path + "/" + name;
+	scope.next = 0;
+	scope.frameMs = -1.0;
+	scopes.push_back(scope);
+
+	return scopes.size() - 1;
+}
+
+int GPUProfiler::nextQuery()
+{
+	FrameQueries& frame = frames[frameIndex % LATENCY_FRAMES];
+
+	if (frame.used == (int)frame.queries.size())
+	{
+		// Cresce em blocos; as queries so reaproveitadas nos quadros seguintes
+		size_t first = frame.queries.size();
+		frame.queries.resize(first + 16);
+		glGenQueries(16, &frame.queries[first]);
+	}
+
+	return frame.used++;
+}
+
+void GPUProfiler::begin(const string& name)
+{
+	if (!active)
+		return;
+
+	FrameQueries& frame = frames[frameIndex % LATENCY_FRAMES];
+	int parent = openMarkers.empty() ? -1 : frame.markers[openMarkers.back()].scope;
+
+	Marker marker;
+	marker.scope = findScope(parent, name);
+	marker.startQuery = nextQuery();
+	marker.endQuery = -1;
+	glQueryCounter(frame.queries[marker.startQuery], GL_TIMESTAMP);
+
+	openMarkers.push_back(frame.markers.size());
+	frame.markers.push_back(marker);
+}
+
+void GPUProfiler::end()
+{
+	if (!active || openMarkers.empty())
+		return;
+
+	FrameQueries& frame = frames[frameIndex % LATENCY_FRAMES];
+	Marker& marker = frame.markers[openMarkers.back()];
+	openMarkers.pop_back();
+
+	marker.endQuery = nextQuery();
+	glQueryCounter(frame.queries[marker.endQuery], GL_TIMESTAMP);
+}
+
+void GPUProfiler::collect(FrameQueries& frame)
+{
+	frame.pending = false;
+
+	if (frame.used == 0)
+		return;
+
+	// Os timestamps terminam em ordem: se o ltimo est pronto, todos esto
+	GLint available = 0;
+	glGetQueryObjectiv(frame.queries[frame.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+	if (!available)
+	{
+		droppedFrames++;
+		return;
+	}
+
+	for (size_t s = 0; s < scopes.size(); s++)
+		scopes[s].frameMs = -1.0;
+
+	for (size_t m = 0; m < frame.markers.size(); m++)
+	{
+		const Marker& marker = frame.markers[m];
+		GLuint64 start, end;
+		glGetQueryObjectui64v(frame.queries[marker.startQuery], GL_QUERY_RESULT, &start);
+		glGetQueryObjectui64v(frame.queries[marker.endQuery], GL_QUERY_RESULT, &end);
+
+		ScopeStats& scope = scopes[marker.scope];
+		scope.frameMs = max(0.0, scope.frameMs) + (end > start ? (end - start) / 1.0e6 : 0.0);
+	}
+
+	for (size_t s = 0; s < scopes.size(); s++)
+	{
+		ScopeStats& scope = scopes[s];
+
+		if (scope.frameMs < 0.0)
+			continue;
+
+		if ((int)scope.history.size() < window)
+			scope.history.push_back(scope.frameMs);
+		else
+			scope.history[scope.next] = scope.frameMs;
+
+		scope.next = (scope.next + 1) % window;
+	}
+
+	collectedFrames++;
+}
+
+void GPUProfiler::reset()
+{
+	for (size_t s = 0; s < scopes.size(); s++)
+	{
+		scopes[s].history.clear();
+		scopes[s].next = 0;
+	}
+
+	collectedFrames = droppedFrames = 0;
+}
+
+double GPUProfiler::getAverageMs(const string& path)
+{
+	for (size_t s = 0; s < scopes.size(); s++)
+	{
+		if (scopes[s].path != path || scopes[s].history.empty())
+			continue;
+
+		double average, minimum, maximum;
+		statsOf(scopes[s], average, minimum, maximum);
+		return average;
+	}
+
+	return -1.0;
+}
+
+void GPUProfiler::statsOf(const ScopeStats& scope, double& average, double& minimum, double& maximum)
+{
+	average = minimum = maximum = 0.0;
+
+	if (scope.history.empty())
+		return;
+
+	minimum = maximum = scope.history[0];
+	for (size_t i = 0; i < scope.history.size(); i++)
+	{
+		average += scope.history[i];
+		minimum = min(minimum, scope.history[i]);
+		maximum = max(maximum, scope.history[i]);
+	}
+
+	average /= scope.history.size();
+}
+
+void GPUProfiler::print(ostream& out)
+{
+	out << "GPU por trecho (janela de " << window << " quadros, " << collectedFrames << " lidos, "
+		<< droppedFrames << " descartados):" << endl;
+
+	double frameAverage = getAverageMs("quadro");
+
+	// Em pr-ordem: cada trecho logo depois do pai
+	vector<int> stack;
+	for (int s = (int)scopes.size() - 1; s >= 0; s--)
+		if (scopes[s].parent < 0)
+			stack.push_back(s);
+
+	while (!stack.empty())
+	{
+		const ScopeStats& scope = scopes[stack.back()];
+		int index = stack.back();
+		stack.pop_back();
+
+		for (int c = (int)scopes.size() - 1; c >= 0; c--)
+			if (scopes[c].parent == index)
+				stack.push_back(c);
+
+		if (scope.history.empty())
+			continue;
+
+		double average, minimum, maximum;
+		statsOf(scope, average, minimum, maximum);
+
+		out << "  " << string(scope.depth * 2, ' ') << left << setw(max(1, 28 - scope.depth * 2)) << scope.name << right
+			<< fixed << setprecision(3) << setw(8) << average << " ms  (min " << minimum << ", max " << maximum << ")";
+		if (frameAverage > 0.0 && scope.depth > 0)
+			out << setprecision(1) << setw(7) << (100.0 * average / frameAverage) << "%";
+		out << defaultfloat << setprecision(6) << endl;
+	}
+}
+
+string GPUProfiler::escape(const string& text)
+{
+	string escaped;
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		if (text[i] == '"' || text[i] == '\\')
+			escaped += '\\';
+		escaped += text[i];
+	}
+	return escaped;
+}
+
+bool GPUProfiler::writeJSON(const string& path)
+{
+	ostringstream out;
+	out << setprecision(6);
+	out << "{" << endl;
+	out << "  \"window\": " << window << "," << endl;
+	out << "  \"frames\": " << collectedFrames << "," << endl;
+	out << "  \"dropped_frames\": " << droppedFrames << "," << endl;
+	out << "  \"scopes\": [";
+
+	bool first = true;
+	for (size_t s = 0; s < scopes.size(); s++)
+	{
+		const ScopeStats& scope = scopes[s];
+
+		if (scope.history.empty())
+			continue;
+
+		double average, minimum, maximum;
+		statsOf(scope, average, minimum, maximum);
+
+		out << (first ? "" : ",") << endl << "    { \"path\": \"" << escape(scope.path) << "\", \"name\": \"" << escape(scope.name)
+			<< "\", \"depth\": " << scope.depth << ", \"samples\": " << scope.history.size()
+			<< ", \"mean_ms\": " << average << ", \"min_ms\": " << minimum << ", \"max_ms\": " << maximum << " }";
+		first = false;
+	}
+
+	out << endl << "  ]" << endl << "}" << endl;
+
+	ofstream file(path.c_str());
+	if (!file)
+	{
+		cout << "Nao foi possivel gravar " << path << endl;
+		return false;
+	}
+
+	file << out.str();
+	return true;
+}
@@ -0,0 +1,290 @@
+#include "HeadlessContext.h"
+
+#include <iostream>
+#include <algorithm>
+
+#include "ImageWriter.h"
+
+#ifdef __linux__
+#include <dlfcn.h>
+#endif
+
+// S o necessrio da EGL e da OSMesa (valores de EGL/egl.h, EGL/eglext.h e GL/osmesa.h)
+typedef void* (*GetProcAddressProc)(const char* name);
+
+static const int EGL_NONE_ = 0x3038;
+static const int EGL_OPENGL_API_ = 0x30A2;
+static const int EGL_PLATFORM_SURFACELESS_MESA_ = 0x31DD;
+static const int EGL_CONTEXT_MAJOR_VERSION_ = 0x3098;
+static const int EGL_CONTEXT_MINOR_VERSION_ = 0x30FB;
+static const int EGL_CONTEXT_OPENGL_PROFILE_MASK_ = 0x30FD;
+static const int EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_ = 0x1;
+
+typedef void* (*EglGetPlatformDisplayProc)(int platform, void* nativeDisplay, const int* attributes);
+typedef void* (*EglGetDisplayProc)(void* nativeDisplay);
+typedef unsigned int (*EglInitializeProc)(void* display, int* major, int* minor);
+typedef unsigned int (*EglBindAPIProc)(int api);
+typedef void* (*EglCreateContextProc)(void* display, void* config, void* shareContext, const int* attributes);
+typedef unsigned int (*EglMakeCurrentProc)(void* display, void* draw, void* read, void* context);
+typedef unsigned int (*EglDestroyContextProc)(void* display, void* context);
+typedef unsigned int (*EglTerminateProc)(void* display);
+
+static const int OSMESA_FORMAT_ = 0x22;
+static const int OSMESA_DEPTH_BITS_ = 0x30;
+static const int OSMESA_STENCIL_BITS_ = 0x31;
+static const int OSMESA_PROFILE_ = 0x33;
+static const int OSMESA_CORE_PROFILE_ = 0x34;
+static const int OSMESA_CONTEXT_MAJOR_VERSION_ = 0x36;
+static const int OSMESA_CONTEXT_MINOR_VERSION_ = 0x37;
+
+typedef void* (*OSMesaCreateContextAttribsProc)(const int* attributes, void* shareContext);
+typedef unsigned char (*OSMesaMakeCurrentProc)(void* context, void* buffer, GLenum type, GLsizei width, GLsizei height);
+typedef void (*OSMesaDestroyContextProc)(void* context);
+
+// getProcAddress da biblioteca em uso (eglGetProcAddress ou OSMesaGetProcAddress)
+static GetProcAddressProc currentGetProcAddress = NULL;
+
+HeadlessContext::HeadlessContext() : width(0), height(0), framebuffer(0), colorBuffer(0), depthBuffer(0),
+	library(NULL), display(NULL), context(NULL)
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+	destroy();
+}
+
+void* HeadlessContext::getProcAddress(const char* name)
+{
+	return currentGetProcAddress ? currentGetProcAddress(name) : NULL;
+}
+
+#ifdef __linux__
+
+static void* symbol(void* library, const char* name)
+{
+	return library ? dlsym(library, name) : NULL;
+}
+
+bool HeadlessContext::createEGL()
+{
+	library = dlopen("libEGL.so.1", RTLD_NOW | RTLD_LOCAL);
+	if (!library)
+		return false;
+
+	GetProcAddressProc eglGetProcAddress = (GetProcAddressProc)symbol(library, "eglGetProcAddress");
+	EglGetDisplayProc eglGetDisplay = (EglGetDisplayProc)symbol(library, "eglGetDisplay");
+	EglInitializeProc eglInitialize = (EglInitializeProc)symbol(library, "eglInitialize");
+	EglBindAPIProc eglBindAPI = (EglBindAPIProc)symbol(library, "eglBindAPI");
+	EglCreateContextProc eglCreateContext = (EglCreateContextProc)symbol(library, "eglCreateContext");
+	EglMakeCurrentProc eglMakeCurrent = (EglMakeCurrentProc)symbol(library, "eglMakeCurrent");
+
+	if (!eglGetProcAddress || !eglGetDisplay || !eglInitialize || !eglBindAPI || !eglCreateContext || !eglMakeCurrent)
+		return false;
+
+	// Plataforma surfaceless: no precisa de X11, Wayland nem de um dispositivo DRM
+	EglGetPlatformDisplayProc eglGetPlatformDisplay = (EglGetPlatformDisplayProc)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+	if (eglGetPlatformDisplay)
+		display = eglGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA_, NULL, NULL);
+	if (!display)
+		display = eglGetDisplay(NULL);
+
+	int major, minor;
+	if (!display || !eglInitialize(display, &major, &minor) || !eglBindAPI(EGL_OPENGL_API_))
+		return false;
+
+	// Sem config (EGL_KHR_no_config_context) e sem superfcie (EGL_KHR_surfaceless_context)
+	const int attributes[] = { EGL_CONTEXT_MAJOR_VERSION_, 3, EGL_CONTEXT_MINOR_VERSION_, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK_, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_, EGL_NONE_ };
+
+	context = eglCreateContext(display, NULL, NULL, attributes);
+	if (!context || !eglMakeCurrent(display, NULL, NULL, context))
+		return false;
+
+	currentGetProcAddress = eglGetProcAddress;
+	backend = "EGL surfaceless";
+
+	return true;
+}
+
+bool HeadlessContext::createOSMesa(int width, int height)
+{
+	const char* names[] = { "libOSMesa.so.8", "libOSMesa.so.6", "libOSMesa.so" };
+
+	for (int n = 0; n < 3 && !library; n++)
+		library = dlopen(names[n], RTLD_NOW | RTLD_LOCAL);
+
+	OSMesaCreateContextAttribsProc createContext = (OSMesaCreateContextAttribsProc)symbol(library, "OSMesaCreateContextAttribs");
+	OSMesaMakeCurrentProc makeCurrent = (OSMesaMakeCurrentProc)symbol(library, "OSMesaMakeCurrent");
+	GetProcAddressProc osmesaGetProcAddress = (GetProcAddressProc)symbol(library, "OSMesaGetProcAddress");
+
+	if (!createContext || !makeCurrent || !osmesaGetProcAddress)
+		return false;
+
+	const int attributes[] = { OSMESA_FORMAT_, GL_RGBA, OSMESA_DEPTH_BITS_, 24, OSMESA_STENCIL_BITS_, 8,
+		OSMESA_PROFILE_, OSMESA_CORE_PROFILE_, OSMESA_CONTEXT_MAJOR_VERSION_, 3, OSMESA_CONTEXT_MINOR_VERSION_, 3, 0 };
+
+	context = createContext(attributes, NULL);
+
+	// A OSMesa exige um buffer de cor prprio, mesmo que o desenho v para o framebuffer offscreen
+	osmesaBuffer.resize((size_t)width * height * 4);
+	if (!context || !makeCurrent(context, osmesaBuffer.data(), GL_UNSIGNED_BYTE, width, height))
+		return false;
+
+	currentGetProcAddress = osmesaGetProcAddress;
+	backend = "OSMesa";
+
+	return true;
+}
+
+bool HeadlessContext::create(int width, int height)
+{
+	bool created = createEGL();
+
+	if (!created)
+	{
+		destroy();
+		created = createOSMesa(width, height);
+	}
+
+	if (!created)
+	{
+		destroy();
+		cout << "Modo headless: nem EGL surfaceless nem OSMesa disponiveis" << endl;
+		return false;
+	}
+
+	if (!gladLoadGLLoader((GLADloadproc)getProcAddress))
+	{
+		cout << "Failed to initialize GLAD" << endl;
+		destroy();
+		return false;
+	}
+
+	return createFramebuffer(width, height);
+}
+
+void HeadlessContext::destroy()
+{
+	if (framebuffer != 0 && currentGetProcAddress)
+	{
+		glDeleteFramebuffers(1, &framebuffer);
+		glDeleteRenderbuffers(1, &colorBuffer);
+		glDeleteRenderbuffers(1, &depthBuffer);
+	}
+	framebuffer = colorBuffer = depthBuffer = 0;
+
+	// Tambm  chamado no meio de uma tentativa que falhou: a biblioteca aberta diz qual era
+	EglMakeCurrentProc eglMakeCurrent = (EglMakeCurrentProc)symbol(library, "eglMakeCurrent");
+	EglDestroyContextProc eglDestroyContext = (EglDestroyContextProc)symbol(library, "eglDestroyContext");
+	EglTerminateProc eglTerminate = (EglTerminateProc)symbol(library, "eglTerminate");
+	OSMesaDestroyContextProc osmesaDestroyContext = (OSMesaDestroyContextProc)symbol(library, "OSMesaDestroyContext");
+
+	if (context && eglMakeCurrent && eglDestroyContext)
+	{
+		eglMakeCurrent(display, NULL, NULL, NULL);
+		eglDestroyContext(display, context);
+	}
+	else if (context && osmesaDestroyContext)
+		osmesaDestroyContext(context);
+
+	if (display && eglTerminate)
+		eglTerminate(display);
+
+	if (library)
+		dlclose(library);
+
+	library = display = context = NULL;
+	currentGetProcAddress = NULL;
+	backend.clear();
+}
+
+#else
+
+bool HeadlessContext::createEGL()
+{
+	return false;
+}
+
+bool HeadlessContext::createOSMesa(int width, int height)
+{
+	return false;
+}
+
+bool HeadlessContext::create(int width, int height)
+{
+	cout << "Modo headless: contexto sem janela disponivel so no Linux (EGL/OSMesa)" << endl;
+	return false;
+}
+
+void HeadlessContext::destroy()
+{
+	// Sem contexto prprio: o framebuffer pertence ao contexto da janela, que ainda pode estar atual
+	if (framebuffer != 0)
+	{
+		glDeleteFramebuffers(1, &framebuffer);
+		glDeleteRenderbuffers(1, &colorBuffer);
+		glDeleteRenderbuffers(1, &depthBuffer);
+	}
+	framebuffer = colorBuffer = depthBuffer = 0;
+}
+
+#endif
+
+bool HeadlessContext::createFramebuffer(int width, int height)
+{
+	this->width = width;
+	this->height = height;
+
+	glGenRenderbuffers(1, &colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+	glGenRenderbuffers(1, &depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		cout << "Framebuffer offscreen incompleto" << endl;
+		return false;
+	}
+
+	glViewport(0, 0, width, height);
+
+	return true;
+}
+
+void HeadlessContext::finishFrame()
+{
+	glFinish();
+}
+
+bool HeadlessContext::saveFrame(const string& path)
+{
+	pixels.resize((size_t)width * height * 4);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+	// A OpenGL devolve as linhas de baixo para cima
+	size_t rowSize = (size_t)width * 4;
+	for (int y = 0; y < height / 2; y++)
+		swap_ranges(pixels.begin() + y * rowSize, pixels.begin() + (y + 1) * rowSize, pixels.begin() + (height - 1 - y) * rowSize);
+
+	if (!ImageWriter::write(path, width, height, pixels))
+	{
+		cout << "Nao foi possivel gravar " << path << endl;
+		return false;
+	}
+
+	return true;
+}
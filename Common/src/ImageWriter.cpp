@@ -0,0 +1,145 @@
+#include "ImageWriter.h"
+
+#include <fstream>
+#include <algorithm>
+
+bool ImageWriter::write(const string& path, int width, int height, const vector<unsigned char>& rgba)
+{
+	string extension = path.size() > 4 ? path.substr(path.size() - 4) : "";
+	transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+	if (extension == ".ppm")
+		return writePPM(path, width, height, rgba);
+
+	return writePNG(path, width, height, rgba);
+}
+
+bool ImageWriter::writePPM(const string& path, int width, int height, const vector<unsigned char>& rgba)
+{
+	ofstream file(path.c_str(), ios::binary);
+
+	if (!file)
+		return false;
+
+	file << "P6\n" << width << " " << height << "\n255\n";
+
+	vector<unsigned char> rgb(width * 3);
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+			for (int c = 0; c < 3; c++)
+				rgb[x * 3 + c] = rgba[(y * width + x) * 4 + c];
+
+		file.write((const char*)rgb.data(), rgb.size());
+	}
+
+	return (bool)file;
+}
+
+unsigned int ImageWriter::crc32(const unsigned char* data, size_t size, unsigned int crc)
+{
+	static unsigned int table[256];
+	static bool ready = false;
+
+	if (!ready)
+	{
+		for (unsigned int n = 0; n < 256; n++)
+		{
+			unsigned int c = n;
+			for (int k = 0; k < 8; k++)
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			table[n] = c;
+		}
+		ready = true;
+	}
+
+	crc = ~crc;
+	for (size_t i = 0; i < size; i++)
+		crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+
+	return ~crc;
+}
+
+static void putBigEndian(vector<unsigned char>& out, unsigned int value)
+{
+	out.push_back(value >> 24);
+	out.push_back((value >> 16) & 0xFF);
+	out.push_back((value >> 8) & 0xFF);
+	out.push_back(value & 0xFF);
+}
+
+bool ImageWriter::writePNG(const string& path, int width, int height, const vector<unsigned char>& rgba)
+{
+	// Cada linha comea com o filtro 0 (nenhum)
+	size_t rowSize = width * 4 + 1;
+	vector<unsigned char> raw(rowSize * height);
+	for (int y = 0; y < height; y++)
+	{
+		raw[y * rowSize] = 0;
+		copy(rgba.begin() + y * width * 4, rgba.begin() + (y + 1) * width * 4, raw.begin() + y * rowSize + 1);
+	}
+
+	// Fluxo zlib com blocos sem compresso de at 65535 bytes e Adler-32 no final
+	vector<unsigned char> zlib;
+	zlib.push_back(0x78);
+	zlib.push_back(0x01);
+
+	for (size_t offset = 0; offset < raw.size() || offset == 0; )
+	{
+		size_t length = min(raw.size() - offset, (size_t)65535);
+		bool last = offset + length == raw.size();
+
+		zlib.push_back(last ? 1 : 0);
+		zlib.push_back(length & 0xFF);
+		zlib.push_back(length >> 8);
+		zlib.push_back(~length & 0xFF);
+		zlib.push_back((~length >> 8) & 0xFF);
+		zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+
+		offset += length;
+		if (last)
+			break;
+	}
+
+	unsigned int a = 1, b = 0;
+	for (size_t i = 0; i < raw.size(); i++)
+	{
+		a = (a + raw[i]) % 65521;
+		b = (b + a) % 65521;
+	}
+	putBigEndian(zlib, (b << 16) | a);
+
+	ofstream file(path.c_str(), ios::binary);
+
+	if (!file)
+		return false;
+
+	const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	file.write((const char*)signature, 8);
+
+	auto writeChunk = [&](const char* type, const vector<unsigned char>& data)
+	{
+		vector<unsigned char> chunk;
+		putBigEndian(chunk, data.size());
+		chunk.insert(chunk.end(), type, type + 4);
+		chunk.insert(chunk.end(), data.begin(), data.end());
+		putBigEndian(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+		file.write((const char*)chunk.data(), chunk.size());
+	};
+
+	// IHDR: 8 bits por canal, RGBA (tipo de cor 6), sem entrelaamento
+	vector<unsigned char> header;
+	putBigEndian(header, width);
+	putBigEndian(header, height);
+	header.push_back(8);
+	header.push_back(6);
+	header.push_back(0);
+	header.push_back(0);
+	header.push_back(0);
+
+	writeChunk("IHDR", header);
+	writeChunk("IDAT", zlib);
+	writeChunk("IEND", vector<unsigned char>());
+
+	return (bool)file;
+}
@@ -0,0 +1,199 @@
+#include "IndirectBatch.h"
+
+#include <cstring>
+
+void IndirectBatch::begin()
+{
+	itemMeshes.clear();
+	items.clear();
+	meshletItems.clear();
+	meshletIds.clear();
+}
+
+void IndirectBatch::add(int mesh, const glm::mat4& model, int material, int layer)
+{
+	InstanceData instance;
+	instance.model = model;
+	instance.material = (GLfloat)material;
+	instance.layer = (GLfloat)layer;
+
+	itemMeshes.push_back(mesh);
+	items.push_back(instance);
+}
+
+void IndirectBatch::addMeshlets(int mesh, const glm::mat4& model, int material, int layer, const vector<int>& meshlets)
+{
+	if (meshlets.empty())
+		return;
+
+	MeshletItem item;
+	item.mesh = mesh;
+	item.instance.model = model;
+	item.instance.material = (GLfloat)material;
+	item.instance.layer = (GLfloat)layer;
+	item.first = meshletIds.size();
+	item.count = meshlets.size();
+
+	meshletIds.insert(meshletIds.end(), meshlets.begin(), meshlets.end());
+	meshletItems.push_back(item);
+}
+
+void IndirectBatch::buildCommands(MeshPool& pool)
+{
+	int nbMeshes = pool.getNbMeshes();
+
+	// Counting sort das instncias por malha: cada malha usada vira um comando
+	meshCounts.assign(nbMeshes, 0);
+	for (size_t i = 0; i < itemMeshes.size(); i++)
+		meshCounts[itemMeshes[i]]++;
+
+	commands.clear();
+	vector<GLuint> firstInstance(nbMeshes, 0);
+	GLuint running = 0;
+
+	for (int m = 0; m < nbMeshes; m++)
+	{
+		firstInstance[m] = running;
+
+		if (meshCounts[m] == 0)
+			continue;
+
+		const MeshRange& range = pool.getMesh(m);
+
+		DrawElementsIndirectCommand command;
+		command.count = range.indexCount;
+		command.instanceCount = meshCounts[m];
+		command.firstIndex = range.firstIndex;
+		command.baseVertex = range.baseVertex;
+		command.baseInstance = running;
+		commands.push_back(command);
+
+		running += meshCounts[m];
+	}
+
+	sorted.resize(items.size());
+	for (size_t i = 0; i < items.size(); i++)
+		sorted[firstInstance[itemMeshes[i]]++] = items[i];
+
+	// Instncias desenhadas por meshlets vm depois, com um comando por meshlet
+	const vector<Meshlet>& meshlets = pool.getMeshlets();
+
+	for (size_t i = 0; i < meshletItems.size(); i++)
+	{
+		const MeshletItem& item = meshletItems[i];
+		const MeshRange& range = pool.getMesh(item.mesh);
+
+		for (size_t m = item.first; m < item.first + item.count; m++)
+		{
+			const Meshlet& meshlet = meshlets[meshletIds[m]];
+
+			DrawElementsIndirectCommand command;
+			command.count = meshlet.indexCount;
+			command.instanceCount = 1;
+			command.firstIndex = meshlet.firstIndex;
+			command.baseVertex = range.baseVertex;
+			command.baseInstance = sorted.size();
+			commands.push_back(command);
+		}
+
+		sorted.push_back(item.instance);
+	}
+}
+
+void IndirectBatch::draw(MeshPool& pool)
+{
+	drawCalls = 0;
+	triangles = 0;
+
+	if (items.empty() && meshletItems.empty())
+		return;
+
+	buildCommands(pool);
+
+	if (commands.empty())
+		return;
+
+	for (size_t c = 0; c < commands.size(); c++)
+		triangles += (long long)commands[c].count / 3 * commands[c].instanceCount;
+
+	size_t instanceSize = sorted.size() * sizeof(InstanceData);
+	size_t commandSize = commands.size() * sizeof(DrawElementsIndirectCommand);
+
+	GLuint instanceBuffer = 0, commandBuffer = 0;
+	size_t instanceOffset = 0, commandOffset = 0;
+
+	void* instanceData = stream ? stream->allocate(instanceSize, sizeof(glm::vec4), instanceOffset) : NULL;
+	void* commandData = instanceData ? stream->allocate(commandSize, sizeof(GLuint), commandOffset) : NULL;
+
+	if (instanceData && commandData)
+	{
+		memcpy(instanceData, sorted.data(), instanceSize);
+		memcpy(commandData, commands.data(), commandSize);
+		stream->commit();
+		instanceBuffer = commandBuffer = stream->getBuffer();
+	}
+	else
+	{
+		// Sem ring buffer (ou sem espao nele neste quadro): buffers prprios
+		if (instanceVBO == 0)
+		{
+			glGenBuffers(1, &instanceVBO);
+			glGenBuffers(1, &indirectVBO);
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+		glBufferData(GL_ARRAY_BUFFER, instanceSize, sorted.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, indirectVBO);
+		glBufferData(GL_ARRAY_BUFFER, commandSize, commands.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		instanceBuffer = instanceVBO;
+		commandBuffer = indirectVBO;
+		instanceOffset = commandOffset = 0;
+	}
+
+	GLState::bindVertexArray(pool.getVAO());
+
+	if (!getMultiDraw())
+	{
+		drawSeparately(instanceBuffer, instanceOffset);
+		return;
+	}
+
+	InstanceData::pointAttributes(instanceBuffer, instanceOffset);
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	GLExtensions::multiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*)commandOffset, commands.size(), 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	drawCalls = 1;
+}
+
+void IndirectBatch::drawSeparately(GLuint instanceBuffer, size_t instanceOffset)
+{
+	bool baseInstance = GLExtensions::drawElementsInstancedBaseVertexBaseInstance != NULL;
+
+	if (baseInstance)
+		InstanceData::pointAttributes(instanceBuffer, instanceOffset);
+
+	for (size_t c = 0; c < commands.size(); c++)
+	{
+		const DrawElementsIndirectCommand& command = commands[c];
+		const void* indices = (const void*)(command.firstIndex * sizeof(GLuint));
+
+		if (baseInstance)
+		{
+			GLExtensions::drawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, command.count, GL_UNSIGNED_INT, indices,
+				command.instanceCount, command.baseVertex, command.baseInstance);
+		}
+		else
+		{
+			// OpenGL 3.3: o baseInstance  simulado deslocando os ponteiros dos atributos
+			InstanceData::pointAttributes(instanceBuffer, instanceOffset + command.baseInstance * sizeof(InstanceData));
+			glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.count, GL_UNSIGNED_INT, indices,
+				command.instanceCount, command.baseVertex);
+		}
+
+		drawCalls++;
+	}
+}
@@ -0,0 +1,86 @@
+#include "MeshPool.h"
+
+#include <string>
+#include <unordered_map>
+
+int MeshPool::addMesh(const vector<GLfloat>& expanded, bool buildMeshlets)
+{
+	MeshRange range;
+	range.firstIndex = indices.size();
+	range.baseVertex = vertices.size() / FLOATS_PER_VERTEX;
+
+	// Vrtices com todos os atributos iguais viram um s; a chave so os bytes do vrtice
+	unordered_map<string, GLuint> unique;
+	size_t nbVertices = expanded.size() / FLOATS_PER_VERTEX;
+	GLuint nextIndex = 0;
+
+	for (size_t v = 0; v < nbVertices; v++)
+	{
+		const GLfloat* vertex = &expanded[v * FLOATS_PER_VERTEX];
+		string key((const char*)vertex, FLOATS_PER_VERTEX * sizeof(GLfloat));
+
+		unordered_map<string, GLuint>::iterator found = unique.find(key);
+
+		if (found != unique.end())
+		{
+			indices.push_back(found->second);
+			continue;
+		}
+
+		unique[key] = nextIndex;
+		indices.push_back(nextIndex);
+		vertices.insert(vertices.end(), vertex, vertex + FLOATS_PER_VERTEX);
+		nextIndex++;
+	}
+
+	// ndices relativos  malha: o baseVertex do comando de desenho faz o deslocamento
+	range.indexCount = indices.size() - range.firstIndex;
+	range.vertexCount = nextIndex;
+	range.bounds = MeshBounds::fromVertices(expanded, FLOATS_PER_VERTEX);
+	range.firstMeshlet = meshlets.size();
+	range.meshletCount = 0;
+
+	if (buildMeshlets)
+	{
+		MeshletBuilder::build(&vertices[range.baseVertex * FLOATS_PER_VERTEX], FLOATS_PER_VERTEX, indices,
+			range.firstIndex, range.indexCount, meshlets);
+		range.meshletCount = meshlets.size() - range.firstMeshlet;
+	}
+	meshes.push_back(range);
+
+	return meshes.size() - 1;
+}
+
+void MeshPool::upload()
+{
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &EBO);
+
+	GLState::bindVertexArray(VAO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
+
+	// O EBO vinculado faz parte do estado do VAO
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+
+	GLsizei stride = FLOATS_PER_VERTEX * sizeof(GLfloat);
+
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)0);
+	glEnableVertexAttribArray(0);
+
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(3 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(1);
+
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(6 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(2);
+
+	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(8 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(3);
+
+	InstanceData::enableAttributes();
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
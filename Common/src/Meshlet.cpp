@@ -0,0 +1,179 @@
+#include "Meshlet.h"
+
+#include <algorithm>
+#include <cmath>
+
+void MeshletBuilder::build(const GLfloat* vertices, int stride, vector<GLuint>& indices, size_t firstIndex, size_t indexCount,
+	vector<Meshlet>& meshlets)
+{
+	size_t nbTriangles = indexCount / 3;
+	if (nbTriangles == 0)
+		return;
+
+	const GLuint* source = &indices[firstIndex];
+	GLuint nbVertices = *max_element(source, source + nbTriangles * 3) + 1;
+
+	// Tringulos de cada vrtice (lista compacta: offsets + lista)
+	vector<GLuint> offsets(nbVertices + 1, 0), adjacency(nbTriangles * 3);
+	for (size_t i = 0; i < nbTriangles * 3; i++)
+		offsets[source[i] + 1]++;
+	for (GLuint v = 0; v < nbVertices; v++)
+		offsets[v + 1] += offsets[v];
+
+	vector<GLuint> fill(offsets.begin(), offsets.end() - 1);
+	for (size_t i = 0; i < nbTriangles * 3; i++)
+		adjacency[fill[source[i]]++] = i / 3;
+
+	vector<bool> used(nbTriangles, false);
+	vector<int> localIndex(nbVertices, -1);   // posio do vrtice no meshlet atual, ou -1
+	vector<GLuint> meshletVertices, meshletTriangles;
+	vector<GLuint> reordered;
+	reordered.reserve(nbTriangles * 3);
+
+	size_t nextUnused = 0;
+	size_t remaining = nbTriangles;
+
+	auto finish = [&]()
+	{
+		if (meshletTriangles.empty())
+			return;
+
+		Meshlet meshlet;
+		meshlet.firstIndex = firstIndex + reordered.size();
+		meshlet.indexCount = meshletTriangles.size() * 3;
+		meshlet.vertexCount = meshletVertices.size();
+
+		for (size_t t = 0; t < meshletTriangles.size(); t++)
+			for (int k = 0; k < 3; k++)
+				reordered.push_back(source[meshletTriangles[t] * 3 + k]);
+
+		computeBounds(vertices, stride, &reordered[meshlet.firstIndex - firstIndex], meshlet.indexCount, meshlet);
+		meshlets.push_back(meshlet);
+
+		for (size_t v = 0; v < meshletVertices.size(); v++)
+			localIndex[meshletVertices[v]] = -1;
+		meshletVertices.clear();
+		meshletTriangles.clear();
+	};
+
+	while (remaining > 0)
+	{
+		// Entre os vizinhos do meshlet, o tringulo que acrescenta menos vrtices novos
+		int best = -1, bestNew = 4;
+
+		for (size_t v = 0; v < meshletVertices.size() && bestNew > 0; v++)
+		{
+			GLuint vertex = meshletVertices[v];
+
+			for (GLuint a = offsets[vertex]; a < offsets[vertex + 1]; a++)
+			{
+				GLuint triangle = adjacency[a];
+				if (used[triangle])
+					continue;
+
+				int extra = 0;
+				for (int k = 0; k < 3; k++)
+					extra += localIndex[source[triangle * 3 + k]] < 0;
+
+				if (extra < bestNew)
+				{
+					bestNew = extra;
+					best = triangle;
+				}
+			}
+		}
+
+		// Sem vizinhos livres: comea pelo prximo tringulo ainda no usado
+		if (best < 0)
+		{
+			while (used[nextUnused])
+				nextUnused++;
+			best = nextUnused;
+			bestNew = 0;
+			for (int k = 0; k < 3; k++)
+				bestNew += localIndex[source[best * 3 + k]] < 0;
+		}
+
+		if (meshletVertices.size() + bestNew > (size_t)MAX_VERTICES || meshletTriangles.size() + 1 > (size_t)MAX_TRIANGLES)
+		{
+			finish();
+			continue;
+		}
+
+		for (int k = 0; k < 3; k++)
+		{
+			GLuint vertex = source[best * 3 + k];
+			if (localIndex[vertex] < 0)
+			{
+				localIndex[vertex] = meshletVertices.size();
+				meshletVertices.push_back(vertex);
+			}
+		}
+
+		meshletTriangles.push_back(best);
+		used[best] = true;
+		remaining--;
+	}
+
+	finish();
+
+	copy(reordered.begin(), reordered.end(), indices.begin() + firstIndex);
+}
+
+void MeshletBuilder::computeBounds(const GLfloat* vertices, int stride, const GLuint* indices, size_t indexCount, Meshlet& meshlet)
+{
+	glm::vec3 minimum(1e30f), maximum(-1e30f);
+
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		const GLfloat* v = &vertices[indices[i] * stride];
+		minimum = glm::min(minimum, glm::vec3(v[0], v[1], v[2]));
+		maximum = glm::max(maximum, glm::vec3(v[0], v[1], v[2]));
+	}
+
+	meshlet.center = (minimum + maximum) * 0.5f;
+	meshlet.radius = 0.0f;
+
+	glm::vec3 normalSum(0.0f);
+	vector<glm::vec3> normals;
+
+	for (size_t i = 0; i < indexCount; i += 3)
+	{
+		glm::vec3 p[3];
+		for (int k = 0; k < 3; k++)
+		{
+			const GLfloat* v = &vertices[indices[i + k] * stride];
+			p[k] = glm::vec3(v[0], v[1], v[2]);
+			meshlet.radius = max(meshlet.radius, glm::length(p[k] - meshlet.center));
+		}
+
+		// Normal geomtrica (sentido anti-horrio = frente)
+		glm::vec3 n = glm::cross(p[1] - p[0], p[2] - p[0]);
+		float length = glm::length(n);
+		if (length < 1e-12f)
+			continue;
+
+		normals.push_back(n / length);
+		normalSum += n / length;
+	}
+
+	meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+	meshlet.coneCutoff = 1.0f;
+
+	float sumLength = glm::length(normalSum);
+	if (normals.empty() || sumLength < 1e-6f)
+		return;
+
+	meshlet.coneAxis = normalSum / sumLength;
+
+	float minDot = 1.0f;
+	for (size_t n = 0; n < normals.size(); n++)
+		minDot = min(minDot, glm::dot(normals[n], meshlet.coneAxis));
+
+	// Normais a mais de 90 graus do eixo: o cone no permite descartar nada
+	if (minDot <= 0.0f)
+		return;
+
+	// Seno do meio-ngulo do cone (ver MeshletCuller::cull)
+	meshlet.coneCutoff = sqrt(1.0f - minDot * minDot);
+}
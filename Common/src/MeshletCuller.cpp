@@ -0,0 +1,64 @@
+#include "MeshletCuller.h"
+
+void MeshletCuller::setFrustum(const glm::vec4 planes[6])
+{
+	for (int p = 0; p < 6; p++)
+		this->planes[p] = planes[p];
+}
+
+void MeshletCuller::resetStats()
+{
+	nbMeshlets = frustumCulled = coneCulled = nbTriangles = rejectedTriangles = 0;
+}
+
+int MeshletCuller::cull(MeshPool& pool, int mesh, const glm::mat4& model, vector<int>& visible)
+{
+	const MeshRange& range = pool.getMesh(mesh);
+	return cull(pool.getMeshlets(), range.firstMeshlet, range.meshletCount, model, visible);
+}
+
+int MeshletCuller::cull(const vector<Meshlet>& meshlets, int first, int count, const glm::mat4& model, vector<int>& visible)
+{
+	glm::vec3 localCamera = glm::vec3(glm::inverse(model) * glm::vec4(cameraPosition, 1.0f));
+	float scale = glm::max(glm::length(glm::vec3(model[0])), glm::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+
+	int survivors = 0;
+
+	for (int m = first; m < first + count; m++)
+	{
+		const Meshlet& meshlet = meshlets[m];
+		int triangles = meshlet.indexCount / 3;
+
+		nbMeshlets++;
+		nbTriangles += triangles;
+
+		glm::vec3 center = glm::vec3(model * glm::vec4(meshlet.center, 1.0f));
+		float radius = meshlet.radius * scale;
+		bool inside = true;
+
+		for (int p = 0; p < 6 && inside; p++)
+			inside = glm::dot(glm::vec3(planes[p]), center) + planes[p].w >= -radius;
+
+		if (!inside)
+		{
+			frustumCulled++;
+			rejectedTriangles += triangles;
+			continue;
+		}
+
+		// Todas as faces de costas: a cmera est dentro do cone "oposto" ao das normais, com folga
+		// do raio da esfera (mesmo teste do meshoptimizer, com centro e raio)
+		glm::vec3 toCenter = meshlet.center - localCamera;
+		if (coneCulling && glm::dot(toCenter, meshlet.coneAxis) >= meshlet.coneCutoff * glm::length(toCenter) + meshlet.radius)
+		{
+			coneCulled++;
+			rejectedTriangles += triangles;
+			continue;
+		}
+
+		visible.push_back(m);
+		survivors++;
+	}
+
+	return survivors;
+}
@@ -0,0 +1,1147 @@
+#include "Microbench.h"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <thread>
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "BVH.h"
+#include "FrustumCuller.h"
+#include "OcclusionCuller.h"
+#include "Meshlet.h"
+#include "MeshletCuller.h"
+#include "CurveEvaluator.h"
+#include "Bezier.h"
+#include "Hermite.h"
+#include "CurveT.h"
+#include "CurveBatch.h"
+#include "HeadlessContext.h"
+#include "ControlPointFile.h"
+
+bool Microbench::run(const string& name)
+{
+	if (name == "bvh")
+		bvh();
+	else if (name == "occlusion")
+		occlusion();
+	else if (name == "meshlets")
+		meshlets();
+	else if (name == "curves")
+		curves();
+	else if (name == "tessellation")
+		tessellation();
+	else if (name == "arclength")
+		arclength();
+	else if (name == "bases")
+		bases();
+	else if (name == "batch")
+		batch();
+	else if (name == "edit")
+		edit();
+	else if (name == "controlpoints")
+		controlpoints();
+	else
+	{
+		cout << "Benchmark desconhecido: " << name << " (disponiveis: bvh, occlusion, meshlets, curves, tessellation, arclength, bases, batch, edit, controlpoints)" << endl;
+		return false;
+	}
+
+	return true;
+}
+
+double Microbench::bestOf(int repetitions, function<void()> work)
+{
+	double best = 1e30;
+
+	for (int r = 0; r < repetitions; r++)
+	{
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		work();
+		best = min(best, chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count());
+	}
+
+	return best;
+}
+
+void Microbench::bvh()
+{
+	const int sizes[] = { 1000, 100000, 1000000 };
+	const int nbQueries = 1000;
+
+	cout << fixed << setprecision(3);
+	cout << "BVH x testes lineares (tempos em ms, melhor de 5)" << endl;
+
+	for (int s = 0; s < 3; s++)
+	{
+		int n = sizes[s];
+		mt19937 random(42);
+
+		// Densidade constante: o lado do volume cresce com a raiz cbica do nmero de objetos
+		float side = 10.0f * cbrt((float)n);
+		uniform_real_distribution<float> position(-side / 2.0f, side / 2.0f);
+		uniform_real_distribution<float> size(0.2f, 1.0f);
+		uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+		vector<AABB> boxes(n);
+		for (int i = 0; i < n; i++)
+		{
+			glm::vec3 center(position(random), position(random), position(random));
+			glm::vec3 extents(size(random), size(random), size(random));
+			boxes[i].min = center - extents;
+			boxes[i].max = center + extents;
+		}
+
+		BVH tree;
+		double buildMs = bestOf(3, [&]() { tree.build(boxes); });
+
+		// Todos os objetos andam um pouco: refit completo
+		vector<AABB> moved(boxes);
+		for (int i = 0; i < n; i++)
+		{
+			glm::vec3 offset(unit(random), unit(random), unit(random));
+			moved[i].min += offset * 0.1f;
+			moved[i].max += offset * 0.1f;
+		}
+		double refitMs = bestOf(5, [&]() { tree.refit(moved); });
+
+		// S 1% dos objetos anda (como a suzanne): refit incremental pelos ancestrais
+		int nbMoving = max(1, n / 100);
+		double updateMs = bestOf(5, [&]() {
+			for (int i = 0; i < nbMoving; i++)
+				tree.update(i * 100 % n, moved[i * 100 % n]);
+		});
+
+		tree.build(boxes);
+
+		// Cmera no centro do volume olhando para +x, com o plano distante na borda
+		glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, side / 2.0f);
+		glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+		FrustumCuller culler;
+		culler.setFrustum(projection * view);
+		culler.begin();
+		for (int i = 0; i < n; i++)
+		{
+			MeshBounds bounds;
+			bounds.box = boxes[i];
+			bounds.sphere.center = boxes[i].center();
+			bounds.sphere.radius = glm::length(boxes[i].extents());
+			culler.add(bounds, glm::mat4(1));
+		}
+
+		vector<int> visible;
+		visible.reserve(n);
+		double bvhFrustumMs = bestOf(5, [&]() { visible.clear(); tree.queryFrustum(culler.getPlanes(), visible); });
+		double linearFrustumMs = bestOf(5, [&]() { culler.cull(); });
+
+		// Raios e esferas aleatrios
+		vector<glm::vec3> origins(nbQueries), directions(nbQueries);
+		for (int q = 0; q < nbQueries; q++)
+		{
+			origins[q] = glm::vec3(position(random), position(random), position(random));
+			directions[q] = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.001f));
+		}
+
+		int bvhHits = 0, linearHits = 0;
+		double bvhRayMs = bestOf(5, [&]() {
+			bvhHits = 0;
+			for (int q = 0; q < nbQueries; q++)
+			{
+				float distance;
+				bvhHits += tree.raycast(origins[q], directions[q], side, distance) >= 0;
+			}
+		});
+		double linearRayMs = bestOf(n > 100000 ? 1 : 5, [&]() {
+			linearHits = 0;
+			for (int q = 0; q < nbQueries; q++)
+			{
+				glm::vec3 inverse = 1.0f / directions[q];
+				float best = side;
+				int hit = -1;
+
+				for (int i = 0; i < n; i++)
+				{
+					glm::vec3 t0 = (boxes[i].min - origins[q]) * inverse, t1 = (boxes[i].max - origins[q]) * inverse;
+					glm::vec3 tMin = glm::min(t0, t1), tMax = glm::max(t0, t1);
+					float entry = max(max(tMin.x, tMin.y), max(tMin.z, 0.0f));
+					float exit = min(min(tMax.x, tMax.y), min(tMax.z, best));
+
+					if (entry <= exit && entry < best)
+					{
+						best = entry;
+						hit = i;
+					}
+				}
+
+				linearHits += hit >= 0;
+			}
+		});
+
+		vector<int> near;
+		size_t bvhNear = 0, linearNear = 0;
+		double bvhSphereMs = bestOf(5, [&]() {
+			bvhNear = 0;
+			for (int q = 0; q < nbQueries; q++)
+			{
+				near.clear();
+				tree.querySphere(origins[q], 5.0f, near);
+				bvhNear += near.size();
+			}
+		});
+		double linearSphereMs = bestOf(n > 100000 ? 1 : 5, [&]() {
+			linearNear = 0;
+			for (int q = 0; q < nbQueries; q++)
+				for (int i = 0; i < n; i++)
+				{
+					glm::vec3 d = glm::clamp(origins[q], boxes[i].min, boxes[i].max) - origins[q];
+					linearNear += glm::dot(d, d) <= 25.0f;
+				}
+		});
+
+		cout << endl << n << " objetos (" << tree.getNbNodes() << " nos, profundidade " << tree.getDepth() << ")" << endl;
+		cout << "  construcao SAH:        " << buildMs << endl;
+		cout << "  refit completo:        " << refitMs << endl;
+		cout << "  update de " << nbMoving << " objetos: " << updateMs << endl;
+		cout << "  frustum:  BVH " << bvhFrustumMs << "  linear SIMD " << linearFrustumMs
+			<< "  (" << visible.size() << " x " << culler.getNbVisible() << " visiveis)" << endl;
+		cout << "  " << nbQueries << " raios:  BVH " << bvhRayMs << "  linear " << linearRayMs
+			<< "  (" << bvhHits << " x " << linearHits << " acertos)" << endl;
+		cout << "  " << nbQueries << " esferas: BVH " << bvhSphereMs << "  linear " << linearSphereMs
+			<< "  (" << bvhNear << " x " << linearNear << " objetos)" << endl;
+	}
+}
+
+void Microbench::occlusion()
+{
+	// Cubo unitrio centrado na origem, usado como oclusor
+	const GLfloat cube[] = { -1, -1, -1,  1, -1, -1,  1, 1, -1,  -1, 1, -1,  -1, -1, 1,  1, -1, 1,  1, 1, 1,  -1, 1, 1 };
+	const GLuint cubeIndices[] = { 0, 1, 2, 0, 2, 3,  4, 6, 5, 4, 7, 6,  0, 4, 5, 0, 5, 1,  3, 2, 6, 3, 6, 7,  0, 3, 7, 0, 7, 4,  1, 5, 6, 1, 6, 2 };
+
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 200.0f);
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	OcclusionCuller culler(256, 128);
+	culler.setViewProjection(projection * view);
+
+	// Parede de 4x2 blocos a 10 unidades da cmera, cobrindo o centro da tela
+	vector<glm::mat4> wall;
+	for (int y = 0; y < 2; y++)
+		for (int x = 0; x < 4; x++)
+			wall.push_back(glm::scale(glm::translate(glm::mat4(1), glm::vec3(-3.0f + 2.0f * x, -1.0f + 2.0f * y, -10.0f)), glm::vec3(1.0f, 1.0f, 0.5f)));
+
+	auto renderWall = [&]()
+	{
+		culler.begin();
+		for (size_t w = 0; w < wall.size(); w++)
+			culler.addOccluder(cube, 3, cubeIndices, 36, wall[w]);
+		culler.render();
+	};
+
+	renderWall();
+
+	auto box = [](glm::vec3 center, float half)
+	{
+		AABB b;
+		b.min = center - glm::vec3(half);
+		b.max = center + glm::vec3(half);
+		return b;
+	};
+
+	// Verificaes: atrs da parede est oculto; na frente, ao lado ou atravessando o plano prximo, no
+	bool ok = true;
+	ok = ok && culler.isOccluded(box(glm::vec3(0.0f, 0.0f, -20.0f), 0.5f));
+	ok = ok && culler.isOccluded(box(glm::vec3(2.0f, 1.0f, -40.0f), 1.0f));
+	ok = ok && !culler.isOccluded(box(glm::vec3(0.0f, 0.0f, -5.0f), 0.5f));
+	ok = ok && !culler.isOccluded(box(glm::vec3(30.0f, 0.0f, -20.0f), 0.5f));
+	ok = ok && !culler.isOccluded(box(glm::vec3(0.0f, 0.0f, -20.0f), 15.0f));
+	ok = ok && !culler.isOccluded(box(glm::vec3(0.0f, 0.0f, 0.0f), 1.0f));
+
+	cout << fixed << setprecision(3);
+	cout << "Rasterizador de oclusao " << culler.getWidth() << "x" << culler.getHeight() << ", " << culler.getNbLevels()
+		<< " niveis Hi-Z, " << OcclusionCuller::getSimdWidth() << " pixels por passo" << endl;
+	cout << "Verificacoes: " << (ok ? "ok" : "FALHOU") << endl;
+
+	// Oclusores mais pesados: a parede repetida em vrias profundidades (mais tringulos sobrepostos)
+	for (int layer = 1; layer < 64; layer++)
+		for (int w = 0; w < 8; w++)
+			wall.push_back(glm::translate(wall[w], glm::vec3(0.0f, 0.0f, -0.25f * layer)));
+
+	int maxThreads = max(4, (int)thread::hardware_concurrency());
+	for (int threads = 1; threads <= maxThreads; threads *= 2)
+	{
+		culler.setThreads(threads);
+		double rasterMs = bestOf(20, [&]() { renderWall(); });
+		cout << "  " << culler.getNbThreads() << " thread(s): " << culler.getNbTriangles() << " triangulos em " << rasterMs << " ms" << endl;
+	}
+
+	// Objetos espalhados atrs e na frente da parede
+	mt19937 random(7);
+	uniform_real_distribution<float> spread(-1.0f, 1.0f);
+	uniform_real_distribution<float> depth(3.0f, 100.0f);
+
+	int n = 100000;
+	vector<AABB> boxes(n);
+	for (int i = 0; i < n; i++)
+	{
+		float z = depth(random);
+		boxes[i] = box(glm::vec3(spread(random) * z * 0.5f, spread(random) * z * 0.25f, -z), 0.2f);
+	}
+
+	vector<unsigned char> visible;
+	double testMs = bestOf(5, [&]() { visible.assign(n, 1); culler.test(boxes, visible); });
+
+	cout << "  " << n << " objetos testados em " << testMs << " ms: " << culler.getNbOccluded() << " ocultos" << endl;
+}
+
+void Microbench::meshlets()
+{
+	// Esfera UV de raio 1 com 256 x 128 segmentos (~65k tringulos), s posies
+	const int slices = 256, stacks = 128;
+	vector<GLfloat> vertices;
+	vector<GLuint> indices;
+
+	for (int j = 0; j <= stacks; j++)
+	{
+		float phi = glm::pi<float>() * j / stacks;
+		for (int i = 0; i <= slices; i++)
+		{
+			float theta = 2.0f * glm::pi<float>() * i / slices;
+			vertices.push_back(sin(phi) * cos(theta));
+			vertices.push_back(cos(phi));
+			vertices.push_back(sin(phi) * sin(theta));
+		}
+	}
+
+	for (int j = 0; j < stacks; j++)
+		for (int i = 0; i < slices; i++)
+		{
+			GLuint a = j * (slices + 1) + i, b = a + slices + 1;
+			// Sentido anti-horrio visto de fora; os tringulos degenerados dos polos so omitidos
+			if (j > 0)
+			{
+				indices.push_back(a); indices.push_back(a + 1); indices.push_back(b);
+			}
+			if (j < stacks - 1)
+			{
+				indices.push_back(a + 1); indices.push_back(b + 1); indices.push_back(b);
+			}
+		}
+
+	vector<Meshlet> meshlets;
+	double buildMs = bestOf(1, [&]() { MeshletBuilder::build(vertices.data(), 3, indices, 0, indices.size(), meshlets); });
+
+	size_t maxVertices = 0, maxTriangles = 0;
+	for (size_t m = 0; m < meshlets.size(); m++)
+	{
+		maxVertices = max(maxVertices, (size_t)meshlets[m].vertexCount);
+		maxTriangles = max(maxTriangles, (size_t)meshlets[m].indexCount / 3);
+	}
+
+	cout << fixed << setprecision(3);
+	cout << "Meshlets: " << indices.size() / 3 << " triangulos em " << meshlets.size() << " meshlets (max "
+		<< maxVertices << " vertices, " << maxTriangles << " triangulos) construidos em " << buildMs << " ms" << endl;
+
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+	glm::mat4 model = glm::mat4(1);
+	FrustumCuller frustum;
+	MeshletCuller culler;
+	vector<int> visible;
+
+	// rbitas de 360 quadros: de longe a esfera inteira fica na tela (s o cone descarta); de perto
+	// boa parte dela sai do frustum
+	const float distances[] = { 4.0f, 1.6f, 1.15f };
+	for (int d = 0; d < 3; d++)
+	{
+		culler.resetStats();
+		double cullMs = 0.0;
+
+		for (int frame = 0; frame < 360; frame++)
+		{
+			float angle = glm::radians((float)frame);
+			glm::vec3 eye = distances[d] * glm::vec3(cos(angle), 0.3f, sin(angle));
+			glm::mat4 viewProjection = projection * glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+			frustum.setFrustum(viewProjection);
+			culler.setFrustum(frustum.getPlanes());
+			culler.setCameraPosition(eye);
+
+			visible.clear();
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			culler.cull(meshlets, 0, meshlets.size(), model, visible);
+			cullMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		}
+
+		cout << "  orbita a " << distances[d] << ": " << culler.getNbMeshlets() / 360 << " meshlets/quadro, "
+			<< 100.0 * culler.getFrustumCulled() / culler.getNbMeshlets() << "% fora do frustum, "
+			<< 100.0 * culler.getConeCulled() / culler.getNbMeshlets() << "% de costas, "
+			<< 100.0 * culler.getRejectionRate() << "% dos triangulos descartados, "
+			<< cullMs / 360 << " ms/quadro" << endl;
+	}
+}
+
+void Microbench::curves()
+{
+	// Bezier com 10 segmentos de pontos aleatrios; o tamanho  o total de amostras da curva
+	const int nbSegments = 10;
+	const glm::mat4 M(-1, 3, -3, 1, 3, -6, 3, 0, -3, 3, 0, 0, 1, 0, 0, 0);
+
+	mt19937 rng(11);
+	uniform_real_distribution<float> coordinate(-5.0f, 5.0f);
+	vector<glm::vec3> controlPoints(nbSegments * 3 + 1);
+	for (size_t i = 0; i < controlPoints.size(); i++)
+		controlPoints[i] = glm::vec3(coordinate(rng), coordinate(rng), coordinate(rng));
+
+	vector<CurveSegment> segments;
+	for (int s = 0; s < nbSegments; s++)
+	{
+		glm::mat4x3 G(controlPoints[s * 3], controlPoints[s * 3 + 1], controlPoints[s * 3 + 2], controlPoints[s * 3 + 3]);
+		segments.push_back(CurveEvaluator::coefficients(G, M));
+	}
+
+	// Referncia em double, com t = k / n
+	auto reference = [&](int s, int k, int n)
+	{
+		glm::dvec3 a(segments[s].a), b(segments[s].b), c(segments[s].c), d(segments[s].d);
+		double t = (double)k / n;
+		return ((a * t + b) * t + c) * t + d;
+	};
+
+	cout << fixed << setprecision(3);
+	cout << "Amostragem de curvas (" << nbSegments << " segmentos, tempos em ms, SIMD de " << CurveEvaluator::getSimdWidth()
+		<< " amostras; erro maximo contra double)" << endl;
+	cout << "  amostras    G*M*T    Horner  dif.prog.      SIMD | erro G*M*T  Horner  dif.prog.     SIMD | pontos G*M*T" << endl;
+
+	for (int total = 1000; total <= 10000000; total *= 10)
+	{
+		int n = total / nbSegments - 1;
+		int repetitions = total >= 10000000 ? 3 : 5;
+
+		// Caminho antigo: G montado e G * M * T a cada amostra, com t acumulado em float
+		vector<glm::vec3> old;
+		double oldMs = bestOf(repetitions, [&]()
+		{
+			old.clear();
+			float step = 1.0f / (float)n;
+
+			for (int s = 0; s < nbSegments; s++)
+				for (float t = 0.0; t <= 1.0; t += step)
+				{
+					glm::vec4 T(t * t * t, t * t, t, 1);
+					glm::mat4x3 G(controlPoints[s * 3], controlPoints[s * 3 + 1], controlPoints[s * 3 + 2], controlPoints[s * 3 + 3]);
+					old.push_back(G * M * T);
+				}
+		});
+
+		vector<glm::vec3> out(nbSegments * (n + 1));
+		double ms[3], error[3];
+		void (*methods[3])(const CurveSegment&, int, glm::vec3*) = { CurveEvaluator::evaluateHorner, CurveEvaluator::evaluateForward, CurveEvaluator::evaluateSimd };
+
+		for (int m = 0; m < 3; m++)
+		{
+			ms[m] = bestOf(repetitions, [&]()
+			{
+				for (int s = 0; s < nbSegments; s++)
+					methods[m](segments[s], n, &out[s * (n + 1)]);
+			});
+
+			error[m] = 0.0;
+			for (int s = 0; s < nbSegments; s++)
+				for (int k = 0; k <= n; k++)
+					error[m] = max(error[m], glm::length(glm::dvec3(out[s * (n + 1) + k]) - reference(s, k, n)));
+		}
+
+		// O caminho antigo pode ter uma amostra a menos por segmento; compara o que existe
+		double oldError = 0.0;
+		size_t perSegment = old.size() / nbSegments;
+		for (int s = 0; s < nbSegments; s++)
+			for (size_t k = 0; k < perSegment && (int)k <= n; k++)
+				oldError = max(oldError, glm::length(glm::dvec3(old[s * perSegment + k]) - reference(s, k, n)));
+
+		cout << setw(10) << total << setw(9) << oldMs << setw(10) << ms[0] << setw(11) << ms[1] << setw(10) << ms[2]
+			<< " | " << scientific << setprecision(1) << setw(10) << oldError << setw(8) << error[0] << setw(11) << error[1]
+			<< setw(9) << error[2] << fixed << setprecision(3) << " | " << old.size() << " (" << out.size() << " esperados)" << endl;
+	}
+}
+
+void Microbench::tessellation()
+{
+	const glm::mat4 M(-1, 3, -3, 1, 3, -6, 3, 0, -3, 3, 0, 0, 1, 0, 0, 0);
+	const int fixedSteps = 1000;
+
+	// Suave: circunferncia de raio 5 em 8 arcos de Bezier; fechada: 10 segmentos aleatrios
+	vector<CurveSegment> gentle, sharp;
+	const float kappa = 4.0f / 3.0f * tan(glm::pi<float>() / 16.0f);
+	for (int i = 0; i < 8; i++)
+	{
+		float a0 = glm::two_pi<float>() * i / 8, a1 = glm::two_pi<float>() * (i + 1) / 8;
+		glm::vec3 p0(5.0f * cos(a0), 0.0f, 5.0f * sin(a0)), p3(5.0f * cos(a1), 0.0f, 5.0f * sin(a1));
+		glm::vec3 t0(-sin(a0), 0.0f, cos(a0)), t1(-sin(a1), 0.0f, cos(a1));
+		gentle.push_back(CurveEvaluator::coefficients(glm::mat4x3(p0, p0 + 5.0f * kappa * t0, p3 - 5.0f * kappa * t1, p3), M));
+	}
+
+	mt19937 rng(5);
+	uniform_real_distribution<float> coordinate(-5.0f, 5.0f);
+	glm::vec3 last(coordinate(rng), coordinate(rng), coordinate(rng));
+	for (int i = 0; i < 10; i++)
+	{
+		glm::vec3 p1(coordinate(rng), coordinate(rng), coordinate(rng)), p2(coordinate(rng), coordinate(rng), coordinate(rng));
+		glm::vec3 p3(coordinate(rng), coordinate(rng), coordinate(rng));
+		sharp.push_back(CurveEvaluator::coefficients(glm::mat4x3(last, p1, p2, p3), M));
+		last = p3;
+	}
+
+	vector<float> fixedParams;
+	for (int k = 0; k <= fixedSteps; k++)
+		fixedParams.push_back((float)k / fixedSteps);
+
+	auto fixedOf = [](int n)
+	{
+		vector<float> params;
+		for (int k = 0; k <= n; k++)
+			params.push_back((float)k / n);
+		return params;
+	};
+
+	cout << "Tesselacao adaptativa x passo fixo (" << fixedSteps << " por segmento); vertices sem repetir as juncoes" << endl;
+
+	const char* names[2] = { "suave", "fechada" };
+	vector<CurveSegment>* curves[2] = { &gentle, &sharp };
+
+	for (int c = 0; c < 2; c++)
+	{
+		const vector<CurveSegment>& segments = *curves[c];
+		size_t nbSegments = segments.size();
+
+		float fixedError = 0.0f;
+		for (size_t s = 0; s < nbSegments; s++)
+			fixedError = max(fixedError, CurveEvaluator::chordError(segments[s], fixedParams));
+
+		cout << "  curva " << names[c] << " (" << nbSegments << " segmentos): passo fixo " << nbSegments * fixedSteps + 1
+			<< " vertices, erro " << scientific << setprecision(2) << fixedError << fixed << endl;
+
+		const float tolerances[] = { 1e-2f, 1e-3f, 1e-4f };
+		for (int t = 0; t < 3; t++)
+		{
+			size_t vertices = 1;
+			float error = 0.0f;
+			vector<float> params;
+
+			double ms = bestOf(5, [&]()
+			{
+				vertices = 1;
+				for (size_t s = 0; s < nbSegments; s++)
+				{
+					params.clear();
+					CurveEvaluator::tessellate(segments[s], tolerances[t], params);
+					vertices += params.size() - 1;
+				}
+			});
+
+			for (size_t s = 0; s < nbSegments; s++)
+			{
+				params.clear();
+				CurveEvaluator::tessellate(segments[s], tolerances[t], params);
+				error = max(error, CurveEvaluator::chordError(segments[s], params));
+			}
+
+			// Passo fixo com o mesmo nmero de vrtices, para comparar a distribuio
+			vector<float> uniform = fixedOf(max(1, (int)((vertices - 1) / nbSegments)));
+			float uniformError = 0.0f;
+			for (size_t s = 0; s < nbSegments; s++)
+				uniformError = max(uniformError, CurveEvaluator::chordError(segments[s], uniform));
+
+			cout << scientific << setprecision(0) << "    tolerancia " << tolerances[t] << fixed << setprecision(3) << ": "
+				<< vertices << " vertices (" << 100.0 * vertices / (nbSegments * fixedSteps + 1) << "% do passo fixo) em "
+				<< ms << " ms, erro " << scientific << setprecision(2) << error << "; passo fixo com os mesmos vertices: erro "
+				<< uniformError << fixed << setprecision(3) << endl;
+		}
+	}
+
+	// Na tela: a circunferncia vista de perto e de longe, tolerncia de meio pixel
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 500.0f);
+	glm::vec2 viewport(1000.0f, 1000.0f);
+	const float distances[] = { 8.0f, 40.0f, 200.0f };
+
+	for (int d = 0; d < 3; d++)
+	{
+		glm::mat4 viewProjection = projection * glm::lookAt(glm::vec3(0.0f, distances[d] * 0.5f, distances[d]), glm::vec3(0.0f),
+			glm::vec3(0.0f, 1.0f, 0.0f));
+
+		size_t vertices = 1;
+		float error = 0.0f, fixedError = 0.0f;
+		vector<float> params;
+
+		for (size_t s = 0; s < gentle.size(); s++)
+		{
+			params.clear();
+			CurveEvaluator::tessellate(gentle[s], 0.5f, viewProjection, viewport, params);
+			vertices += params.size() - 1;
+			error = max(error, CurveEvaluator::chordError(gentle[s], params, viewProjection, viewport));
+			fixedError = max(fixedError, CurveEvaluator::chordError(gentle[s], fixedParams, viewProjection, viewport));
+		}
+
+		cout << "  na tela a " << distances[d] << " unidades (0.5 px): " << vertices << " vertices, erro " << error
+			<< " px (passo fixo: " << gentle.size() * fixedSteps + 1 << " vertices, erro " << fixedError << " px)" << endl;
+	}
+
+	// Do centro da circunferncia, olhando para +x: metade dos arcos fica atrs da cmera e dois
+	// cruzam o plano do olho; sem o descarte, cada arco de trs chegaria a 2^MAX_DEPTH arestas
+	glm::mat4 inside = projection * glm::lookAt(glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(5.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	size_t insideVertices = 1;
+	vector<float> params;
+
+	double insideMs = bestOf(5, [&]()
+	{
+		insideVertices = 1;
+		for (size_t s = 0; s < gentle.size(); s++)
+		{
+			params.clear();
+			CurveEvaluator::tessellate(gentle[s], 0.5f, inside, viewport, params);
+			insideVertices += params.size() - 1;
+		}
+	});
+
+	cout << "  na tela, de dentro da curva: " << insideVertices << " vertices em " << insideMs << " ms (limite "
+		<< gentle.size() * (1 << CurveEvaluator::MAX_DEPTH) + 1 << ")" << endl;
+}
+
+void Microbench::arclength()
+{
+	// Bezier de 10 segmentos aleatrios (sem contexto OpenGL: s a tabela  usada)
+	mt19937 rng(3);
+	uniform_real_distribution<float> coordinate(-5.0f, 5.0f);
+	vector<glm::vec3> controlPoints(31);
+	for (size_t i = 0; i < controlPoints.size(); i++)
+		controlPoints[i] = glm::vec3(coordinate(rng), coordinate(rng), coordinate(rng));
+
+	Bezier curve;
+	curve.setControlPoints(controlPoints);
+	curve.buildArcLengthTable(256);
+	const vector<CurveSegment>& segments = curve.getSegments();
+
+	// Distncia "verdadeira" at o parmetro u, com 256 intervalos por segmento
+	auto lengthOf = [&](int segment, float t)
+	{
+		double s = 0.0;
+		for (int k = 0; k < 256; k++)
+			s += CurveEvaluator::arcLength(segments[segment], t * k / 256, t * (k + 1) / 256);
+		return s;
+	};
+
+	vector<double> segmentStart(1, 0.0);
+	for (size_t k = 0; k < segments.size(); k++)
+		segmentStart.push_back(segmentStart.back() + lengthOf(k, 1.0f));
+
+	auto distanceTo = [&](float u)
+	{
+		int segment = min((int)u, (int)segments.size() - 1);
+		return segmentStart[segment] + lengthOf(segment, u - segment);
+	};
+
+	float length = curve.getLength();
+	const int nbQueries = 100000;
+
+	cout << fixed << setprecision(3);
+	cout << "Comprimento de arco: curva de " << segments.size() << " segmentos com " << length << " unidades" << endl;
+
+	// Memria de uma curva usada s para animao: pontos amostrados contra coeficientes e tabela
+	cout << "  memoria: " << segments.size() * 1001 * sizeof(glm::vec3) << " bytes com 1000 pontos por segmento, "
+		<< segments.size() * sizeof(CurveSegment) << " bytes de coeficientes (evaluate) + " << (segments.size() * 8 + 1) * 2 * sizeof(float)
+		<< " bytes da tabela de 8 intervalos por segmento" << endl;
+
+	// Passo fixo por ndice (como a suzanne andava): a distncia entre pontos consecutivos varia
+	float minStep = 1e30f, maxStep = 0.0f;
+	for (size_t s = 0; s < segments.size(); s++)
+		for (int k = 0; k < 1000; k++)
+		{
+			float step = glm::length(CurveEvaluator::point(segments[s], (k + 1) / 1000.0f) - CurveEvaluator::point(segments[s], k / 1000.0f));
+			minStep = min(minStep, step);
+			maxStep = max(maxStep, step);
+		}
+	cout << "  passo fixo de 1000 pontos por segmento: deslocamento por quadro de " << minStep << " a " << maxStep
+		<< " (" << maxStep / minStep << "x)" << endl;
+
+	const int intervals[] = { 4, 8, 16 };
+	const int lutSizes[] = { 0, 1024, 16384 };
+
+	for (int i = 0; i < 3; i++)
+		for (int l = 0; l < 3; l++)
+		{
+			curve.buildArcLengthTable(intervals[i], lutSizes[l]);
+
+			double error = 0.0;
+			for (int q = 0; q <= 1000; q++)
+			{
+				float s = length * q / 1000;
+				error = max(error, fabs(distanceTo(curve.parameterAtDistance(s)) - s));
+			}
+
+			volatile float sink = 0.0f;
+			double ms = bestOf(5, [&]()
+			{
+				float sum = 0.0f;
+				for (int q = 0; q < nbQueries; q++)
+					sum += curve.pointAtDistance(length * q / nbQueries).x;
+				sink = sum;
+			});
+
+			cout << "  " << setw(2) << intervals[i] << " intervalos por segmento, " << (lutSizes[l] > 0 ? "tabela uniforme de " + to_string(lutSizes[l])
+				: string("busca binaria")) << ": erro maximo " << scientific << setprecision(2) << error << fixed << setprecision(3)
+				<< ", " << (ms * 1.0e6 / nbQueries) << " ns por consulta" << endl;
+		}
+
+	// Trocar os pontos de controle (aqui, por menos segmentos) e depois editar um deles deve dar a
+	// mesma tabela que uma curva nova com esses pontos
+	vector<glm::vec3> fewer(controlPoints.begin(), controlPoints.begin() + 16);
+	glm::vec3 moved(1.0f, 2.0f, 3.0f);
+	curve.buildArcLengthTable(8, 1024);
+	curve.setControlPoints(fewer);
+	curve.moveControlPoint(4, moved);
+
+	Bezier fresh;
+	fewer[4] = moved;
+	fresh.setControlPoints(fewer);
+	fresh.buildArcLengthTable(8, 1024);
+
+	// A edio soma a diferena s distncias seguintes em vez de acumular de novo: erro de arredondamento
+	float difference = fabs(curve.getLength() - fresh.getLength());
+	for (int q = 0; q <= 1000; q++)
+	{
+		float d = fresh.getLength() * q / 1000;
+		difference = max(difference, fabs(curve.parameterAtDistance(d) - fresh.parameterAtDistance(d)));
+	}
+
+	cout << "  trocando os pontos de controle (" << fresh.getNbSegments() << " segmentos) e editando um: diferenca "
+		<< scientific << setprecision(2) << difference << fixed << setprecision(3) << " da tabela nova" << endl;
+	cout << "Verificacoes: " << (difference < 1e-4f ? "ok" : "FALHOU") << endl;
+}
+
+void Microbench::bases()
+{
+	// 10 segmentos de pontos aleatrios; u aleatrios para que a busca do segmento no seja prevista
+	const int nbSegments = 10;
+	const int nbQueries = 1000000;
+
+	mt19937 rng(5);
+	uniform_real_distribution<float> coordinate(-5.0f, 5.0f);
+	vector<glm::vec3> controlPoints(nbSegments * 3 + 1);
+	for (size_t i = 0; i < controlPoints.size(); i++)
+		controlPoints[i] = glm::vec3(coordinate(rng), coordinate(rng), coordinate(rng));
+
+	vector<float> us(nbQueries);
+	uniform_real_distribution<float> parameter(0.0f, (float)nbSegments);
+	for (int q = 0; q < nbQueries; q++)
+		us[q] = parameter(rng);
+
+	Bezier bezier;
+	Hermite hermite;
+	bezier.setControlPoints(controlPoints);
+	hermite.setControlPoints(controlPoints);
+	Curve* runtime[2] = { &bezier, &hermite };
+
+	CurveT<BezierBasis> bezierT(controlPoints);
+	CurveT<HermiteBasis> hermiteT(controlPoints);
+	AnyCurve erased[2] = { AnyCurve(bezierT), AnyCurve(hermiteT) };
+
+	// Tempo de uma passada por todos os u, com a soma guardada para o lao no ser descartado
+	volatile float sink = 0.0f;
+	auto timeOf = [&](const auto& evaluate)
+	{
+		return bestOf(5, [&]()
+		{
+			float sum = 0.0f;
+			for (int q = 0; q < nbQueries; q++)
+				sum += evaluate(us[q]).x;
+			sink = sum;
+		});
+	};
+
+	cout << fixed << setprecision(3);
+	cout << "Bases de curvas: " << nbQueries << " avaliacoes em u aleatorio, " << nbSegments << " segmentos (tempos em ms)" << endl;
+	cout << "  base        G*M*T  Curve::evaluate   CurveT   AnyCurve | diferenca maxima CurveT x Curve" << endl;
+
+	const char* names[2] = { "Bezier", "Hermite" };
+	for (int b = 0; b < 2; b++)
+	{
+		Curve& curve = *runtime[b];
+		const glm::mat4 M = b == 0 ? glm::mat4(-1, 3, -3, 1, 3, -6, 3, 0, -3, 3, 0, 0, 1, 0, 0, 0)
+			: glm::mat4(2, -2, 1, 1, -3, 3, -2, -1, 0, 0, 1, 0, 1, 0, 0, 0);
+
+		// Caminho antigo: G montado e multiplicado por M a cada avaliao
+		double oldMs = bestOf(5, [&]()
+		{
+			float sum = 0.0f;
+			for (int q = 0; q < nbQueries; q++)
+			{
+				int s = min((int)us[q], nbSegments - 1);
+				float t = us[q] - s;
+				glm::vec3 P0 = controlPoints[s * 3], P3 = controlPoints[s * 3 + 3];
+				glm::mat4x3 G = b == 0 ? glm::mat4x3(P0, controlPoints[s * 3 + 1], controlPoints[s * 3 + 2], P3)
+					: glm::mat4x3(P0, P3, controlPoints[s * 3 + 1] - P0, controlPoints[s * 3 + 2] - P3);
+				sum += (G * M * glm::vec4(t * t * t, t * t, t, 1)).x;
+			}
+			sink = sum;
+		});
+
+		double curveMs = timeOf([&](float u) { return curve.evaluate(u); });
+		double templateMs = b == 0 ? timeOf([&](float u) { return bezierT.evaluate(u); }) : timeOf([&](float u) { return hermiteT.evaluate(u); });
+		double erasedMs = timeOf([&](float u) { return erased[b].evaluate(u); });
+
+		float difference = 0.0f;
+		for (int q = 0; q < nbQueries; q += 100)
+			difference = max(difference, glm::length(erased[b].evaluate(us[q]) - curve.evaluate(us[q])));
+
+		cout << "  " << left << setw(9) << names[b] << right << setw(8) << oldMs << setw(17) << curveMs << setw(9) << templateMs
+			<< setw(11) << erasedMs << " | " << scientific << setprecision(2) << difference << fixed << setprecision(3) << endl;
+	}
+
+	// Amostragem da curva inteira (1000 pontos por segmento) em cada base
+	const int pointsPerSegment = 1000;
+	vector<glm::vec3> out;
+	out.reserve((controlPoints.size() - 3) * (pointsPerSegment + 1));
+
+	auto sampleTime = [&](const AnyCurve& curve, int& nbPoints)
+	{
+		double ms = bestOf(5, [&]()
+		{
+			out.clear();
+			curve.sample(pointsPerSegment, out);
+		});
+		nbPoints = out.size();
+		return ms;
+	};
+
+	AnyCurve all[5] = { AnyCurve(bezierT), AnyCurve(hermiteT), AnyCurve(CurveT<CatmullRomBasis>(controlPoints)),
+		AnyCurve(CurveT<CardinalBasis<1, 4> >(controlPoints)), AnyCurve(CurveT<BSplineBasis>(controlPoints)) };
+	const char* allNames[5] = { "Bezier", "Hermite", "Catmull-Rom", "cardinal (s = 1/4)", "B-spline" };
+
+	cout << "  amostragem com " << pointsPerSegment << " pontos por segmento (sample):" << endl;
+	for (int b = 0; b < 5; b++)
+	{
+		int nbPoints;
+		double ms = sampleTime(all[b], nbPoints);
+		cout << "    " << left << setw(19) << allNames[b] << right << setw(3) << all[b].getNbSegments() << " segmentos, "
+			<< setw(6) << nbPoints << " pontos: " << ms << " ms" << endl;
+	}
+
+	double evaluatorMs = bestOf(5, [&]()
+	{
+		out.resize(nbSegments * (pointsPerSegment + 1));
+		for (int s = 0; s < nbSegments; s++)
+			CurveEvaluator::evaluate(bezier.getSegments()[s], pointsPerSegment, &out[s * (pointsPerSegment + 1)]);
+	});
+	cout << "    " << left << setw(19) << "Bezier (Curve)" << right << setw(3) << nbSegments << " segmentos, " << setw(6) << out.size()
+		<< " pontos: " << evaluatorMs << " ms" << endl;
+}
+
+void Microbench::batch()
+{
+	// 100k caminhos Bezier de 10 segmentos (como objetos animados, cada um no seu caminho)
+	const int nbCurves = 100000;
+	const int nbSegments = 10;
+
+	mt19937 rng(17);
+	uniform_real_distribution<float> coordinate(-50.0f, 50.0f);
+	uniform_real_distribution<float> parameter(0.0f, 1.0f);
+	const glm::mat4 M(-1, 3, -3, 1, 3, -6, 3, 0, -3, 3, 0, 0, 1, 0, 0, 0);
+
+	vector<vector<CurveSegment> > paths(nbCurves);
+	CurveBatch batch;
+	for (int i = 0; i < nbCurves; i++)
+	{
+		glm::vec3 p = glm::vec3(coordinate(rng), coordinate(rng), coordinate(rng));
+		for (int s = 0; s < nbSegments; s++)
+		{
+			glm::vec3 p1 = p + glm::vec3(parameter(rng), parameter(rng), parameter(rng));
+			glm::vec3 p2 = p1 + glm::vec3(parameter(rng), parameter(rng), parameter(rng));
+			glm::vec3 p3 = p2 + glm::vec3(parameter(rng), parameter(rng), parameter(rng));
+			paths[i].push_back(CurveEvaluator::coefficients(glm::mat4x3(p, p1, p2, p3), M));
+			p = p3;
+		}
+		batch.addCurve(paths[i]);
+	}
+
+	vector<float> phases(nbCurves), close(nbCurves);
+	for (int i = 0; i < nbCurves; i++)
+		phases[i] = parameter(rng);
+	// Fases prximas (objetos em comboio): todos no mesmo segmento, t diferentes
+	for (int i = 0; i < nbCurves; i++)
+		close[i] = 0.3f + 0.09f * parameter(rng);
+
+	// Uma curva por vez, com os segmentos em AoS (como Curve::evaluate faria em cada objeto)
+	auto single = [&](int i, float u)
+	{
+		float x = u * nbSegments;
+		int s = min((int)x, nbSegments - 1);
+		return CurveEvaluator::point(paths[i][s], x - s);
+	};
+
+	vector<glm::vec3> expected(nbCurves), out(nbCurves);
+	auto maxError = [&]()
+	{
+		float error = 0.0f;
+		for (int i = 0; i < nbCurves; i++)
+			error = max(error, glm::length(out[i] - expected[i]));
+		return error;
+	};
+
+	cout << fixed << setprecision(3);
+	cout << "Avaliacao em lote: " << nbCurves << " caminhos de " << nbSegments << " segmentos, SIMD de " << CurveBatch::getSimdWidth()
+		<< " (tempos em ms, erro maximo contra uma curva por vez)" << endl;
+
+	double sharedSingleMs = bestOf(5, [&]()
+	{
+		for (int i = 0; i < nbCurves; i++)
+			expected[i] = single(i, 0.37f);
+	});
+	double phasedSingleMs = bestOf(5, [&]()
+	{
+		for (int i = 0; i < nbCurves; i++)
+			out[i] = single(i, phases[i]);
+	});
+	double closeSingleMs = bestOf(5, [&]()
+	{
+		for (int i = 0; i < nbCurves; i++)
+			out[i] = single(i, close[i]);
+	});
+	cout << "  uma curva por vez: mesmo u " << sharedSingleMs << ", u por curva " << phasedSingleMs << " (fases proximas "
+		<< closeSingleMs << ")" << endl;
+
+	int hardware = max(1, (int)thread::hardware_concurrency());
+	vector<int> threadCounts(1, 1);
+	if (hardware > 1)
+		threadCounts.push_back(hardware);
+
+	for (size_t c = 0; c < threadCounts.size(); c++)
+	{
+		batch.setThreads(threadCounts[c]);
+
+		for (int i = 0; i < nbCurves; i++)
+			expected[i] = single(i, 0.37f);
+		double sharedMs = bestOf(5, [&]() { batch.evaluate(0.37f, out.data()); });
+		float sharedError = maxError();
+
+		for (int i = 0; i < nbCurves; i++)
+			expected[i] = single(i, phases[i]);
+		double phasedMs = bestOf(5, [&]() { batch.evaluate(phases.data(), out.data()); });
+		float phasedError = maxError();
+
+		for (int i = 0; i < nbCurves; i++)
+			expected[i] = single(i, close[i]);
+		double closeMs = bestOf(5, [&]() { batch.evaluate(close.data(), out.data()); });
+		phasedError = max(phasedError, maxError());
+
+		for (int i = 0; i < nbCurves; i++)
+			expected[i] = single(0, phases[i]);
+		double curveMs = bestOf(5, [&]() { batch.evaluateCurve(0, phases.data(), nbCurves, out.data()); });
+		float curveError = maxError();
+
+		cout << "  CurveBatch com " << threadCounts[c] << " thread(s): mesmo u " << sharedMs << ", u por curva " << phasedMs
+			<< " (fases proximas " << closeMs << ")"
+			<< ", " << nbCurves << " u numa curva " << curveMs << " | erro " << scientific << setprecision(1) << sharedError << ", "
+			<< phasedError << ", " << curveError << fixed << setprecision(3) << endl;
+	}
+}
+
+void Microbench::edit()
+{
+	// O VBO s existe com um contexto; sem janela, o mesmo contexto do modo headless
+	HeadlessContext context;
+	if (!context.create(64, 64))
+	{
+		cout << "Edicao de curvas: precisa de um contexto OpenGL (EGL ou OSMesa)" << endl;
+		return;
+	}
+
+	// Bezier de 10 segmentos aleatrios, editada 200 vezes em pontos aleatrios
+	const int nbEdits = 200;
+	mt19937 rng(23);
+	uniform_real_distribution<float> coordinate(-5.0f, 5.0f);
+	vector<glm::vec3> initial(31);
+	for (size_t i = 0; i < initial.size(); i++)
+		initial[i] = glm::vec3(coordinate(rng), coordinate(rng), coordinate(rng));
+
+	vector<int> indices(nbEdits);
+	vector<glm::vec3> positions(nbEdits);
+	for (int e = 0; e < nbEdits; e++)
+	{
+		indices[e] = rng() % initial.size();
+		positions[e] = glm::vec3(coordinate(rng), coordinate(rng), coordinate(rng));
+	}
+
+	cout << fixed << setprecision(3);
+	cout << "Edicao de curvas: " << nbEdits << " pontos movidos numa Bezier de " << (initial.size() - 1) / 3
+		<< " segmentos, contra gerar tudo de novo (tempos em ms por edicao)" << endl;
+
+	const char* names[2] = { "passo fixo (100 por segmento)", "adaptativa (1e-3)" };
+	bool ok = true;
+
+	for (int mode = 0; mode < 2; mode++)
+	{
+		auto generate = [&](Bezier& curve)
+		{
+			if (mode == 0)
+				curve.generateCurve(100);
+			else
+				curve.generateCurveAdaptive(1e-3f);
+			curve.buildArcLengthTable(8, 256);
+		};
+
+		Bezier edited;
+		edited.setControlPoints(initial);
+		generate(edited);
+
+		vector<glm::vec3> points = initial;
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		for (int e = 0; e < nbEdits; e++)
+		{
+			edited.moveControlPoint(indices[e], positions[e]);
+			points[indices[e]] = positions[e];
+		}
+		glFinish();
+		double editMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count() / nbEdits;
+
+		Bezier fresh;
+		double regenerateMs = bestOf(5, [&]()
+		{
+			fresh.setControlPoints(points);
+			generate(fresh);
+			glFinish();
+		});
+
+		// Pontos amostrados: a edio refaz os segmentos com as mesmas funes, ento so idnticos
+		bool samePoints = edited.getNbCurvePoints() == fresh.getNbCurvePoints();
+		for (int i = 0; i < fresh.getNbCurvePoints() && samePoints; i++)
+			samePoints = edited.getPointOnCurve(i) == fresh.getPointOnCurve(i);
+
+		// O VBO, atualizado por trechos, tem que ter os mesmos pontos
+		vector<glm::vec3> uploaded(edited.getNbCurvePoints());
+		glBindBuffer(GL_ARRAY_BUFFER, edited.getVBO());
+		glGetBufferSubData(GL_ARRAY_BUFFER, 0, uploaded.size() * sizeof(glm::vec3), uploaded.data());
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		bool sameVBO = samePoints;
+		for (size_t i = 0; i < uploaded.size() && sameVBO; i++)
+			sameVBO = uploaded[i] == fresh.getPointOnCurve(i);
+
+		// A tabela editada soma a diferena s distncias seguintes: s arredondamento
+		float difference = fabs(edited.getLength() - fresh.getLength());
+		for (int q = 0; q <= 1000; q++)
+		{
+			float d = fresh.getLength() * q / 1000;
+			difference = max(difference, fabs(edited.parameterAtDistance(d) - fresh.parameterAtDistance(d)));
+		}
+
+		ok = ok && samePoints && sameVBO && difference < 1e-4f;
+
+		cout << "  " << names[mode] << ": edicao " << editMs << ", gerar de novo " << regenerateMs << " | " << fresh.getNbCurvePoints()
+			<< " pontos " << (samePoints ? "iguais" : "DIFERENTES") << ", VBO " << (sameVBO ? "igual" : "DIFERENTE")
+			<< ", tabela de comprimento com diferenca " << scientific << setprecision(2) << difference << fixed << setprecision(3) << endl;
+	}
+
+	cout << "Verificacoes: " << (ok ? "ok" : "FALHOU") << endl;
+}
+
+void Microbench::controlpoints()
+{
+	const string textPath = "microbench_pontos.txt", binaryPath = "microbench_pontos.cpb";
+	const int nbSegments = 100000;
+	const int windowSegments = 4096;
+
+	mt19937 rng(29);
+	uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+	vector<glm::vec3> points(3 * nbSegments + 1);
+	for (size_t i = 0; i < points.size(); i++)
+		points[i] = glm::vec3(coordinate(rng), coordinate(rng), coordinate(rng));
+
+	// Texto como curvePoints.txt (9 algarismos: o float volta exato), com linhas que no so pontos
+	// no meio: comentrio, linha vazia, dois nmeros e uma linha de nmeros maior que o bloco de
+	// leitura, cujo fim no pode virar um ponto
+	FILE* text = fopen(textPath.c_str(), "wb");
+	if (!text)
+	{
+		cout << "Arquivo de pontos: nao foi possivel gravar " << textPath << endl;
+		return;
+	}
+
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		fprintf(text, "%.9g %.9g %.9g\n", points[i].x, points[i].y, points[i].z);
+
+		if (i == 10)
+			fprintf(text, "# comentario\n\n1 2\n");
+		else if (i == 1000)
+		{
+			for (int k = 0; k < 1300000; k++)
+				fputs("9 ", text);
+			fputs("\n", text);
+		}
+	}
+	fclose(text);
+
+	cout << fixed << setprecision(3);
+	cout << "Arquivo de pontos de controle: " << points.size() << " pontos (" << nbSegments << " segmentos Bezier)" << endl;
+
+	long long imported = -1;
+	double importMs = bestOf(1, [&]() { imported = ControlPointFile::importText(textPath, binaryPath); });
+
+	ControlPointFile file;
+	vector<glm::vec3> read;
+	bool opened = file.open(binaryPath);
+	if (opened)
+		file.readAll(read);
+
+	bool sameImport = imported == (long long)points.size() && read == points;
+	cout << "  importacao: " << imported << " pontos em " << importMs << " ms, " << (sameImport ? "iguais" : "DIFERENTES")
+		<< " aos gravados" << endl;
+
+	// Janelas sequenciais: cada segmento tem que sair com os pontos originais
+	Bezier bezier;
+	glm::mat4 basis = bezier.getPointBasis();
+	long long nbRead = 0;
+	bool sameWindows = opened;
+	SegmentWindow window;
+
+	double streamMs = bestOf(3, [&]()
+	{
+		nbRead = 0;
+		sameWindows = opened;
+		file.rewind();
+		while (file.nextWindow(windowSegments, window))
+		{
+			if (window.firstSegment != nbRead)
+				sameWindows = false;
+			const glm::vec3* expected = &points[3 * window.firstSegment];
+			sameWindows = sameWindows && equal(window.points, window.points + 3 * window.nbSegments + 1, expected);
+			nbRead += window.nbSegments;
+		}
+	});
+	sameWindows = sameWindows && nbRead == nbSegments;
+
+	// Acesso aleatrio por u contra os coeficientes calculados na memria
+	float error = 0.0f;
+	uniform_real_distribution<double> parameter(0.0, (double)nbSegments);
+	for (int q = 0; q < 10000 && opened; q++)
+	{
+		double u = parameter(rng);
+		long long segment = min((long long)u, (long long)nbSegments - 1);
+		const glm::vec3* p = &points[3 * segment];
+		CurveSegment expected = CurveEvaluator::coefficients(glm::mat4x3(p[0], p[1], p[2], p[3]), basis);
+		error = max(error, glm::length(file.evaluate(u, basis) - CurveEvaluator::point(expected, (float)(u - segment))));
+	}
+
+	cout << "  janelas de " << windowSegments << " segmentos (" << (file.isMapped() ? "mapeado" : "fread") << "): " << nbRead
+		<< " segmentos em " << streamMs << " ms, " << (sameWindows ? "iguais" : "DIFERENTES") << "; evaluate(u): erro "
+		<< scientific << setprecision(2) << error << fixed << setprecision(3) << endl;
+
+	file.close();
+	remove(textPath.c_str());
+	remove(binaryPath.c_str());
+
+	cout << "Verificacoes: " << (sameImport && sameWindows && error < 1e-3f ? "ok" : "FALHOU") << endl;
+}
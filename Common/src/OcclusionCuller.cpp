@@ -0,0 +1,299 @@
+#include "OcclusionCuller.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RASTER_SIMD 1
+#else
+#define RASTER_SIMD 0
+#endif
+
+// Vrtices com w menor que isso esto atrs (ou muito perto) do olho
+static const float MIN_W = 1e-5f;
+
+OcclusionCuller::OcclusionCuller(int width, int height, int nbThreads)
+	: width((width + 3) & ~3), height(height), nbOccluded(0), lastRasterMs(0.0), lastTestMs(0.0)
+{
+	setThreads(nbThreads);
+
+	// Nveis da pirmide at uma das dimenses chegar a 1
+	int w = this->width, h = this->height;
+	while (true)
+	{
+		levels.push_back(vector<float>(w * h, 1.0f));
+		levelWidth.push_back(w);
+		levelHeight.push_back(h);
+
+		if (w == 1 || h == 1)
+			break;
+
+		w = max(1, w / 2);
+		h = max(1, h / 2);
+	}
+}
+
+void OcclusionCuller::setThreads(int nbThreads)
+{
+	if (nbThreads <= 0)
+		nbThreads = max(1, (int)thread::hardware_concurrency());
+
+	// Faixas com menos de 4 linhas no compensam o custo da thread
+	this->nbThreads = max(1, min(nbThreads, height / 4));
+}
+
+int OcclusionCuller::getSimdWidth()
+{
+	return RASTER_SIMD ? 4 : 1;
+}
+
+void OcclusionCuller::begin()
+{
+	triangles.clear();
+}
+
+void OcclusionCuller::addOccluder(const GLfloat* vertices, int stride, const GLuint* indices, size_t nbIndices, const glm::mat4& model)
+{
+	glm::mat4 mvp = viewProjection * model;
+
+	for (size_t i = 0; i + 2 < nbIndices; i += 3)
+	{
+		glm::vec4 p[3];
+
+		for (int k = 0; k < 3; k++)
+		{
+			const GLfloat* v = &vertices[indices[i + k] * stride];
+			p[k] = mvp * glm::vec4(v[0], v[1], v[2], 1.0f);
+		}
+
+		setupTriangle(p[0], p[1], p[2]);
+	}
+}
+
+void OcclusionCuller::setupTriangle(const glm::vec4& p0, const glm::vec4& p1, const glm::vec4& p2)
+{
+	// Tringulos que cruzam o plano prximo so ignorados: perder um oclusor s reduz o descarte
+	if (p0.w < MIN_W || p1.w < MIN_W || p2.w < MIN_W)
+		return;
+
+	glm::vec3 s[3];
+	const glm::vec4* p[3] = { &p0, &p1, &p2 };
+
+	for (int k = 0; k < 3; k++)
+	{
+		float invW = 1.0f / p[k]->w;
+		s[k].x = (p[k]->x * invW * 0.5f + 0.5f) * width;
+		s[k].y = (p[k]->y * invW * 0.5f + 0.5f) * height;
+		s[k].z = p[k]->z * invW * 0.5f + 0.5f;
+	}
+
+	// Fora do intervalo de profundidade visvel
+	if (max(s[0].z, max(s[1].z, s[2].z)) < 0.0f || min(s[0].z, min(s[1].z, s[2].z)) > 1.0f)
+		return;
+
+	float area = (s[1].x - s[0].x) * (s[2].y - s[0].y) - (s[2].x - s[0].x) * (s[1].y - s[0].y);
+	if (fabs(area) < 1e-8f)
+		return;
+
+	Triangle t;
+	t.minX = max(0, (int)floor(min(s[0].x, min(s[1].x, s[2].x))));
+	t.maxX = min(width - 1, (int)ceil(max(s[0].x, max(s[1].x, s[2].x))));
+	t.minY = max(0, (int)floor(min(s[0].y, min(s[1].y, s[2].y))));
+	t.maxY = min(height - 1, (int)ceil(max(s[0].y, max(s[1].y, s[2].y))));
+
+	if (t.minX > t.maxX || t.minY > t.maxY)
+		return;
+
+	// Os dois sentidos de giro so aceitos (sem descarte de faces traseiras)
+	float sign = area > 0.0f ? 1.0f : -1.0f;
+
+	for (int e = 0; e < 3; e++)
+	{
+		const glm::vec3& from = s[e];
+		const glm::vec3& to = s[(e + 1) % 3];
+		t.a[e] = sign * (from.y - to.y);
+		t.b[e] = sign * (to.x - from.x);
+		t.c[e] = sign * (from.x * to.y - to.x * from.y);
+	}
+
+	// Profundidade (z/w)  linear no espao da tela, e a interpolao no precisa de correo
+	t.dzdx = ((s[1].z - s[0].z) * (s[2].y - s[0].y) - (s[2].z - s[0].z) * (s[1].y - s[0].y)) / area;
+	t.dzdy = ((s[2].z - s[0].z) * (s[1].x - s[0].x) - (s[1].z - s[0].z) * (s[2].x - s[0].x)) / area;
+	t.z0 = s[0].z - t.dzdx * s[0].x - t.dzdy * s[0].y;
+
+	triangles.push_back(t);
+}
+
+void OcclusionCuller::render()
+{
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+
+	fill(levels[0].begin(), levels[0].end(), 1.0f);
+
+	// Uma faixa de linhas por tarefa, nas threads persistentes do WorkerPool
+	int rowsPerBand = (height + nbThreads - 1) / nbThreads;
+
+	WorkerPool::shared().run(nbThreads, [&](int b) { rasterizeBand(b * rowsPerBand, min(height, (b + 1) * rowsPerBand)); });
+
+	buildHiZ();
+
+	lastRasterMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+}
+
+void OcclusionCuller::rasterizeBand(int firstRow, int lastRow)
+{
+	float* depth = levels[0].data();
+
+	for (size_t i = 0; i < triangles.size(); i++)
+	{
+		const Triangle& t = triangles[i];
+
+		int y0 = max(t.minY, firstRow), y1 = min(t.maxY, lastRow - 1);
+		if (y0 > y1)
+			continue;
+
+		// Comea num mltiplo de 4 para as linhas do buffer ficarem alinhadas com os grupos
+		int x0 = t.minX & ~3;
+
+		for (int y = y0; y <= y1; y++)
+		{
+			float py = y + 0.5f;
+			float* row = depth + y * width;
+			int x = x0;
+
+#if RASTER_SIMD
+			const __m128 offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+			__m128 zero = _mm_setzero_ps();
+
+			for (; x <= t.maxX; x += 4)
+			{
+				__m128 px = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+
+				__m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.a[0]), px), _mm_set1_ps(t.b[0] * py + t.c[0]));
+				__m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.a[1]), px), _mm_set1_ps(t.b[1] * py + t.c[1]));
+				__m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.a[2]), px), _mm_set1_ps(t.b[2] * py + t.c[2]));
+
+				__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+				if (_mm_movemask_ps(inside) == 0)
+					continue;
+
+				__m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.dzdx), px), _mm_set1_ps(t.z0 + t.dzdy * py));
+				z = _mm_max_ps(z, zero);
+
+				__m128 current = _mm_loadu_ps(row + x);
+				__m128 nearest = _mm_min_ps(current, z);
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+			}
+#else
+			for (; x <= t.maxX; x++)
+			{
+				float px = x + 0.5f;
+
+				if (t.a[0] * px + t.b[0] * py + t.c[0] < 0.0f || t.a[1] * px + t.b[1] * py + t.c[1] < 0.0f ||
+					t.a[2] * px + t.b[2] * py + t.c[2] < 0.0f)
+					continue;
+
+				float z = max(0.0f, t.z0 + t.dzdx * px + t.dzdy * py);
+				row[x] = min(row[x], z);
+			}
+#endif
+		}
+	}
+}
+
+void OcclusionCuller::buildHiZ()
+{
+	for (size_t l = 1; l < levels.size(); l++)
+	{
+		const vector<float>& source = levels[l - 1];
+		vector<float>& target = levels[l];
+		int sourceWidth = levelWidth[l - 1], sourceHeight = levelHeight[l - 1];
+
+		for (int y = 0; y < levelHeight[l]; y++)
+			for (int x = 0; x < levelWidth[l]; x++)
+			{
+				// Dimenses mpares: a ltima linha/coluna entra no texel vizinho
+				int sx1 = (x == levelWidth[l] - 1) ? sourceWidth - 1 : 2 * x + 1;
+				int sy1 = (y == levelHeight[l] - 1) ? sourceHeight - 1 : 2 * y + 1;
+				float farthest = 0.0f;
+
+				for (int sy = 2 * y; sy <= sy1; sy++)
+					for (int sx = 2 * x; sx <= sx1; sx++)
+						farthest = max(farthest, source[sy * sourceWidth + sx]);
+
+				target[y * levelWidth[l] + x] = farthest;
+			}
+	}
+}
+
+bool OcclusionCuller::isOccluded(const AABB& box) const
+{
+	float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f, minZ = 1e30f;
+
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec3 p((corner & 1) ? box.max.x : box.min.x, (corner & 2) ? box.max.y : box.min.y, (corner & 4) ? box.max.z : box.min.z);
+		glm::vec4 clip = viewProjection * glm::vec4(p, 1.0f);
+
+		// A caixa cruza o plano prximo: no h como garantir que est oculta
+		if (clip.w < MIN_W)
+			return false;
+
+		float invW = 1.0f / clip.w;
+		float x = (clip.x * invW * 0.5f + 0.5f) * width;
+		float y = (clip.y * invW * 0.5f + 0.5f) * height;
+
+		minX = min(minX, x);
+		maxX = max(maxX, x);
+		minY = min(minY, y);
+		maxY = max(maxY, y);
+		minZ = min(minZ, clip.z * invW * 0.5f + 0.5f);
+	}
+
+	int x0 = max(0, (int)floor(minX)), x1 = min(width - 1, (int)floor(maxX));
+	int y0 = max(0, (int)floor(minY)), y1 = min(height - 1, (int)floor(maxY));
+
+	// Fora da tela: fica para o descarte por frustum
+	if (x0 > x1 || y0 > y1)
+		return false;
+
+	// Nvel em que o retngulo cobre no mximo 2x2 texels
+	int level = 0;
+	while (level + 1 < (int)levels.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+		level++;
+
+	int lw = levelWidth[level], lh = levelHeight[level];
+	const vector<float>& hiZ = levels[level];
+
+	// Com dimenses mpares a ltima linha/coluna do nvel anterior foi includa no ltimo texel
+	for (int y = min(lh - 1, y0 >> level); y <= min(lh - 1, y1 >> level); y++)
+		for (int x = min(lw - 1, x0 >> level); x <= min(lw - 1, x1 >> level); x++)
+			if (hiZ[y * lw + x] >= minZ)
+				return false;
+
+	return true;
+}
+
+int OcclusionCuller::test(const vector<AABB>& boxes, vector<unsigned char>& visible)
+{
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+
+	nbOccluded = 0;
+
+	for (size_t i = 0; i < boxes.size(); i++)
+	{
+		if (!visible[i] || !isOccluded(boxes[i]))
+			continue;
+
+		visible[i] = 0;
+		nbOccluded++;
+	}
+
+	lastTestMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+
+	return nbOccluded;
+}
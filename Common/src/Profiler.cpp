@@ -0,0 +1,150 @@
+#include "Profiler.h"
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+
+atomic<bool> Profiler::enabled(false);
+mutex Profiler::registryMutex;
+vector<Profiler::ThreadBuffer*> Profiler::buffers;
+thread_local Profiler::ThreadBuffer* Profiler::currentBuffer = NULL;
+
+static const chrono::steady_clock::time_point profilerEpoch = chrono::steady_clock::now();
+
+uint64_t Profiler::now()
+{
+	return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - profilerEpoch).count();
+}
+
+Profiler::ThreadBuffer* Profiler::threadBuffer()
+{
+	if (currentBuffer)
+		return currentBuffer;
+
+	ThreadBuffer* buffer = new ThreadBuffer();
+	for (size_t c = 0; c < MAX_CHUNKS; c++)
+		buffer->chunks[c] = NULL;
+	buffer->count.store(0);
+	buffer->dropped.store(0);
+
+	lock_guard<mutex> lock(registryMutex);
+	buffer->id = buffers.size() + 1;
+	buffer->name = buffer->id == 1 ? "principal" : "thread " + to_string(buffer->id);
+	buffers.push_back(buffer);
+
+	currentBuffer = buffer;
+	return buffer;
+}
+
+void Profiler::record(const char* name, uint64_t start, uint64_t end)
+{
+	ThreadBuffer* buffer = threadBuffer();
+
+	size_t n = buffer->count.load(memory_order_relaxed);
+	size_t chunk = n / CHUNK_EVENTS;
+
+	if (chunk >= MAX_CHUNKS)
+	{
+		buffer->dropped.fetch_add(1, memory_order_relaxed);
+		return;
+	}
+
+	if (!buffer->chunks[chunk])
+		buffer->chunks[chunk] = new Event[CHUNK_EVENTS];
+
+	Event& event = buffer->chunks[chunk][n % CHUNK_EVENTS];
+	event.name = name;
+	event.start = start;
+	event.end = end;
+
+	// Publica o evento (e o bloco, se for novo) para a exportao
+	buffer->count.store(n + 1, memory_order_release);
+}
+
+void Profiler::setThreadName(const string& name)
+{
+	ThreadBuffer* buffer = threadBuffer();
+
+	lock_guard<mutex> lock(registryMutex);
+	buffer->name = name;
+}
+
+size_t Profiler::getNbEvents()
+{
+	lock_guard<mutex> lock(registryMutex);
+
+	size_t total = 0;
+	for (size_t b = 0; b < buffers.size(); b++)
+		total += buffers[b]->count.load(memory_order_acquire);
+
+	return total;
+}
+
+size_t Profiler::getNbDropped()
+{
+	lock_guard<mutex> lock(registryMutex);
+
+	size_t total = 0;
+	for (size_t b = 0; b < buffers.size(); b++)
+		total += buffers[b]->dropped.load(memory_order_relaxed);
+
+	return total;
+}
+
+string Profiler::escape(const char* text)
+{
+	string escaped;
+	for (const char* c = text; *c; c++)
+	{
+		if (*c == '"' || *c == '\\')
+			escaped += '\\';
+		if ((unsigned char)*c >= 0x20)
+			escaped += *c;
+	}
+	return escaped;
+}
+
+bool Profiler::writeChromeTrace(const string& path)
+{
+	ostringstream out;
+	out << fixed << setprecision(3);
+	out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" << endl;
+
+	lock_guard<mutex> lock(registryMutex);
+
+	bool first = true;
+	for (size_t b = 0; b < buffers.size(); b++)
+	{
+		const ThreadBuffer* buffer = buffers[b];
+
+		out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+			<< ",\"args\":{\"name\":\"" << escape(buffer->name.c_str()) << "\"}}";
+		first = false;
+
+		// S os eventos j publicados; a thread pode continuar gravando enquanto isso
+		size_t count = buffer->count.load(memory_order_acquire);
+
+		for (size_t e = 0; e < count; e++)
+		{
+			const Event& event = buffer->chunks[e / CHUNK_EVENTS][e % CHUNK_EVENTS];
+
+			// O formato usa microssegundos; as trs casas guardam os nanossegundos
+			out << ",\n{\"name\":\"" << escape(event.name) << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+				<< ",\"ts\":" << (event.start / 1000.0) << ",\"dur\":" << ((event.end - event.start) / 1000.0) << "}";
+		}
+	}
+
+	out << endl << "]}" << endl;
+
+	ofstream file(path.c_str());
+	if (!file)
+	{
+		cout << "Nao foi possivel gravar " << path << endl;
+		return false;
+	}
+
+	file << out.str();
+	return true;
+}
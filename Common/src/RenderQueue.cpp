@@ -0,0 +1,276 @@
+#include "RenderQueue.h"
+
+// Layout da chave (bit 63 = transparente):
+//  opaco:        [62..55] programa  [54..45] VAO  [44..35] textura  [34..27] material  [26..3] profundidade
+//  transparente: [62..39] profundidade invertida  [38..31] programa  [30..21] VAO  [20..11] textura  [10..3] material
+static const int DEPTH_BITS = 24;
+
+int RenderQueue::addMaterial(const Material& material)
+{
+	materials.push_back(material);
+	return materials.size() - 1;
+}
+
+void RenderQueue::begin(const glm::mat4& view)
+{
+	this->view = view;
+	packets.clear();
+	keys.clear();
+	order.clear();
+}
+
+void RenderQueue::submit(const DrawPacket& packet)
+{
+	// Profundidade no espao da cmera (a cmera olha para -z)
+	glm::vec4 center = view * packet.model * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+	keys.push_back(makeKey(packet, -center.z));
+	order.push_back(packets.size());
+	packets.push_back(packet);
+}
+
+uint32_t RenderQueue::denseId(vector<GLuint>& ids, GLuint id)
+{
+	for (size_t i = 0; i < ids.size(); i++)
+		if (ids[i] == id)
+			return i;
+
+	ids.push_back(id);
+	return ids.size() - 1;
+}
+
+uint64_t RenderQueue::makeKey(const DrawPacket& packet, float depth)
+{
+	uint64_t program = denseId(programIds, packet.program) & 0xFF;
+	uint64_t vao = denseId(vaoIds, packet.vao) & 0x3FF;
+	uint64_t texture = denseId(textureIds, packet.texture) & 0x3FF;
+	uint64_t material = (uint64_t)packet.material & 0xFF;
+
+	float normalized = glm::clamp(depth / farPlane, 0.0f, 1.0f);
+	uint64_t quantized = (uint64_t)(normalized * ((1 << DEPTH_BITS) - 1));
+
+	if (!packet.transparent)
+		return (program << 55) | (vao << 45) | (texture << 35) | (material << 27) | (quantized << 3);
+
+	uint64_t inverted = ((1 << DEPTH_BITS) - 1) - quantized;
+	return (1ULL << 63) | (inverted << 39) | (program << 31) | (vao << 21) | (texture << 11) | (material << 3);
+}
+
+void RenderQueue::radixSort(vector<uint64_t>& keys, vector<uint32_t>& order, vector<uint64_t>& tmpKeys, vector<uint32_t>& tmpOrder)
+{
+	size_t n = keys.size();
+	tmpKeys.resize(n);
+	tmpOrder.resize(n);
+
+	// LSD, 8 passadas de 8 bits; passadas em que todas as chaves tm o mesmo byte so puladas
+	for (int shift = 0; shift < 64; shift += 8)
+	{
+		size_t count[256] = { 0 };
+
+		for (size_t i = 0; i < n; i++)
+			count[(keys[i] >> shift) & 0xFF]++;
+
+		if (n == 0 || count[(keys[0] >> shift) & 0xFF] == n)
+			continue;
+
+		size_t offset = 0;
+		for (int b = 0; b < 256; b++)
+		{
+			size_t c = count[b];
+			count[b] = offset;
+			offset += c;
+		}
+
+		for (size_t i = 0; i < n; i++)
+		{
+			size_t dst = count[(keys[i] >> shift) & 0xFF]++;
+			tmpKeys[dst] = keys[i];
+			tmpOrder[dst] = order[i];
+		}
+
+		keys.swap(tmpKeys);
+		order.swap(tmpOrder);
+	}
+}
+
+void RenderQueue::sort()
+{
+	radixSort(keys, order, tmpKeys, tmpOrder);
+}
+
+const RenderQueue::ProgramLocations& RenderQueue::locationsOf(GLuint program)
+{
+	for (size_t i = 0; i < locations.size(); i++)
+		if (locations[i].program == program)
+			return locations[i];
+
+	ProgramLocations l;
+	l.program = program;
+	l.materials = glGetUniformLocation(program, "materials");
+	locations.push_back(l);
+
+	return locations.back();
+}
+
+void RenderQueue::enableInstancing(GLuint vao)
+{
+	GLState::bindVertexArray(vao);
+	InstanceData::enableAttributes();
+}
+
+void RenderQueue::pointInstanceAttributes(size_t firstInstance)
+{
+	// Sem base instance (OpenGL 4.2), o incio do grupo  dado pelo offset dos ponteiros
+	InstanceData::pointAttributes(instanceBuffer, instanceBase + firstInstance * sizeof(InstanceData));
+}
+
+void RenderQueue::uploadMaterials(GLint location, const vector<Material>& materials)
+{
+	GLfloat data[MAX_MATERIALS * 4];
+	int n = glm::min((int)materials.size(), MAX_MATERIALS);
+
+	for (int i = 0; i < n; i++)
+	{
+		data[i * 4 + 0] = materials[i].ka;
+		data[i * 4 + 1] = materials[i].kd;
+		data[i * 4 + 2] = materials[i].ks;
+		data[i * 4 + 3] = materials[i].q;
+	}
+
+	if (n > 0)
+		glUniform4fv(location, n, data);
+}
+
+bool RenderQueue::sameMesh(const DrawPacket& a, const DrawPacket& b)
+{
+	return a.program == b.program && a.vao == b.vao && a.texture == b.texture &&
+		a.mode == b.mode && a.first == b.first && a.count == b.count && a.transparent == b.transparent;
+}
+
+void RenderQueue::uploadInstances()
+{
+	size_t size = order.size() * sizeof(InstanceData);
+
+	// Dados por instncia na ordem final de desenho, escritos direto no ring buffer
+	if (stream)
+	{
+		InstanceData* out = (InstanceData*)stream->allocate(size, sizeof(glm::vec4), instanceBase);
+
+		if (out)
+		{
+			for (size_t i = 0; i < order.size(); i++)
+			{
+				const DrawPacket& p = packets[order[i]];
+				out[i].model = p.model;
+				out[i].material = (GLfloat)p.material;
+				out[i].layer = (GLfloat)p.layer;
+			}
+
+			stream->commit();
+			instanceBuffer = stream->getBuffer();
+			return;
+		}
+	}
+
+	// Sem ring buffer (ou sem espao nele neste quadro): VBO prprio, realocado a cada quadro
+	if (instanceVBO == 0)
+		glGenBuffers(1, &instanceVBO);
+
+	instances.resize(order.size());
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		const DrawPacket& p = packets[order[i]];
+		instances[i].model = p.model;
+		instances[i].material = (GLfloat)p.material;
+		instances[i].layer = (GLfloat)p.layer;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, size, instances.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	instanceBuffer = instanceVBO;
+	instanceBase = 0;
+}
+
+void RenderQueue::execute()
+{
+	drawCalls = stateChanges = skippedBinds = 0;
+	triangles = 0;
+
+	if (order.empty())
+		return;
+
+	uploadInstances();
+
+	// Nomes invlidos foram o primeiro bind de cada tipo
+	GLuint program = 0xFFFFFFFF, vao = 0xFFFFFFFF, texture = 0xFFFFFFFF;
+	bool blending = false;
+
+	GLState::disable(GL_BLEND);
+	GLState::depthMask(GL_TRUE);
+
+	size_t i = 0;
+	while (i < order.size())
+	{
+		const DrawPacket& p = packets[order[i]];
+
+		// Pacotes consecutivos da mesma malha viram um nico draw instanciado
+		size_t end = i + 1;
+		if (batching)
+			while (end < order.size() && sameMesh(p, packets[order[end]]))
+				end++;
+
+		if (p.transparent && !blending)
+		{
+			GLState::enable(GL_BLEND);
+			GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			GLState::depthMask(GL_FALSE);
+			blending = true;
+		}
+
+		if (p.program != program)
+		{
+			GLState::useProgram(p.program);
+			// Uniforms so por programa: os materiais precisam ser reenviados
+			uploadMaterials(locationsOf(p.program).materials, materials);
+			program = p.program;
+			stateChanges++;
+		}
+		else
+			skippedBinds++;
+
+		if (p.vao != vao)
+		{
+			GLState::bindVertexArray(p.vao);
+			vao = p.vao;
+			stateChanges++;
+		}
+		else
+			skippedBinds++;
+
+		if (p.texture != texture)
+		{
+			GLState::bindTextureUnit(0, textureTarget, p.texture);
+			texture = p.texture;
+			stateChanges++;
+		}
+		else
+			skippedBinds++;
+
+		pointInstanceAttributes(i);
+		glDrawArraysInstanced(p.mode, p.first, p.count, end - i);
+		drawCalls++;
+		if (p.mode == GL_TRIANGLES)
+			triangles += (long long)(p.count / 3) * (end - i);
+
+		i = end;
+	}
+
+	if (blending)
+	{
+		GLState::disable(GL_BLEND);
+		GLState::depthMask(GL_TRUE);
+	}
+}
@@ -0,0 +1,241 @@
+#include "ShaderWatcher.h"
+#include "Profiler.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+void ShaderWatcher::watch(Shader* shader, string vertexPath, string fragmentPath, function<void(Shader*)> onReload)
+{
+	WatchedShader w;
+	w.shader = shader;
+	w.vertexPath = vertexPath;
+	w.fragmentPath = fragmentPath;
+	w.onReload = onReload;
+	w.vertexStamp = modificationStamp(vertexPath);
+	w.fragmentStamp = modificationStamp(fragmentPath);
+	w.pending = false;
+
+	lock_guard<mutex> lock(pendingMutex);
+	watched.push_back(w);
+}
+
+void ShaderWatcher::start()
+{
+	if (running)
+		return;
+
+	running = true;
+	worker = thread(&ShaderWatcher::run, this);
+}
+
+void ShaderWatcher::stop()
+{
+	running = false;
+
+	if (worker.joinable())
+		worker.join();
+}
+
+int ShaderWatcher::update()
+{
+	int reloaded = 0;
+
+	lock_guard<mutex> lock(pendingMutex);
+
+	for (size_t i = 0; i < watched.size(); i++)
+	{
+		WatchedShader& w = watched[i];
+
+		if (!w.pending)
+			continue;
+
+		w.pending = false;
+
+		bool linked;
+		GLuint program = Shader::buildProgram(w.vertexCode, w.fragmentCode, linked);
+
+		if (!linked)
+		{
+			// Mantm o programa antigo em uso at o arquivo ser corrigido
+			glDeleteProgram(program);
+			cout << "Shader nao recarregado (falha na linkagem): " << w.fragmentPath << endl;
+			continue;
+		}
+
+		w.shader->swapProgram(program);
+		w.shader->Use();
+
+		if (w.onReload)
+			w.onReload(w.shader);
+
+		chrono::steady_clock::time_point now = chrono::steady_clock::now();
+		double totalMs = chrono::duration<double, milli>(now - w.changedAt).count();
+		double readMs = chrono::duration<double, milli>(w.readAt - w.changedAt).count();
+
+		cout << "Shader recarregado: " << w.vertexPath << " + " << w.fragmentPath
+			<< " em " << totalMs << " ms (leitura " << readMs << " ms)" << endl;
+
+		reloaded++;
+	}
+
+	return reloaded;
+}
+
+void ShaderWatcher::reloadSources(WatchedShader& w, chrono::steady_clock::time_point changedAt)
+{
+	PROFILE_ZONE("ShaderWatcher::reloadSources");
+
+	string vertexCode, fragmentCode;
+
+	if (!Shader::readSource(w.vertexPath, vertexCode) || !Shader::readSource(w.fragmentPath, fragmentCode))
+		return;
+
+	lock_guard<mutex> lock(pendingMutex);
+
+	w.vertexCode = vertexCode;
+	w.fragmentCode = fragmentCode;
+	w.changedAt = changedAt;
+	w.readAt = chrono::steady_clock::now();
+	w.pending = true;
+}
+
+#ifdef __linux__
+
+void ShaderWatcher::run()
+{
+	PROFILE_THREAD_NAME("ShaderWatcher");
+
+	int fd = inotify_init1(IN_NONBLOCK);
+
+	if (fd < 0)
+	{
+		cout << "ShaderWatcher: inotify indisponivel" << endl;
+		return;
+	}
+
+	// Um watch por diretrio (editores costumam salvar via arquivo temporrio + rename)
+	vector<pair<int, string> > directories;
+
+	for (size_t i = 0; i < watched.size(); i++)
+	{
+		string dirs[2] = { directoryOf(watched[i].vertexPath), directoryOf(watched[i].fragmentPath) };
+
+		for (int d = 0; d < 2; d++)
+		{
+			bool known = false;
+			for (size_t j = 0; j < directories.size(); j++)
+				known = known || directories[j].second == dirs[d];
+
+			if (known)
+				continue;
+
+			int wd = inotify_add_watch(fd, dirs[d].c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+			if (wd >= 0)
+				directories.push_back(make_pair(wd, dirs[d]));
+		}
+	}
+
+	char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+	while (running)
+	{
+		pollfd pfd = { fd, POLLIN, 0 };
+
+		if (poll(&pfd, 1, 100) <= 0)
+			continue;
+
+		chrono::steady_clock::time_point changedAt = chrono::steady_clock::now();
+		vector<bool> changed(watched.size(), false);
+
+		ssize_t length;
+		while ((length = read(fd, buffer, sizeof(buffer))) > 0)
+		{
+			for (char* ptr = buffer; ptr < buffer + length; ptr += sizeof(inotify_event) + ((inotify_event*)ptr)->len)
+			{
+				const inotify_event* event = (const inotify_event*)ptr;
+
+				if (event->len == 0)
+					continue;
+
+				string directory;
+				for (size_t j = 0; j < directories.size(); j++)
+					if (directories[j].first == event->wd)
+						directory = directories[j].second;
+
+				for (size_t i = 0; i < watched.size(); i++)
+				{
+					const WatchedShader& w = watched[i];
+
+					if ((directoryOf(w.vertexPath) == directory && fileNameOf(w.vertexPath) == event->name) ||
+						(directoryOf(w.fragmentPath) == directory && fileNameOf(w.fragmentPath) == event->name))
+						changed[i] = true;
+				}
+			}
+		}
+
+		for (size_t i = 0; i < watched.size(); i++)
+			if (changed[i])
+				reloadSources(watched[i], changedAt);
+	}
+
+	close(fd);
+}
+
+#else
+
+void ShaderWatcher::run()
+{
+	PROFILE_THREAD_NAME("ShaderWatcher");
+
+	// Sem inotify: verifica a data de modificao dos arquivos a cada 250 ms
+	while (running)
+	{
+		this_thread::sleep_for(chrono::milliseconds(250));
+
+		for (size_t i = 0; i < watched.size(); i++)
+		{
+			WatchedShader& w = watched[i];
+
+			long long vertexStamp = modificationStamp(w.vertexPath);
+			long long fragmentStamp = modificationStamp(w.fragmentPath);
+
+			if (vertexStamp == w.vertexStamp && fragmentStamp == w.fragmentStamp)
+				continue;
+
+			w.vertexStamp = vertexStamp;
+			w.fragmentStamp = fragmentStamp;
+
+			reloadSources(w, chrono::steady_clock::now());
+		}
+	}
+}
+
+#endif
+
+long long ShaderWatcher::modificationStamp(const string& path)
+{
+	struct stat info;
+
+	if (stat(path.c_str(), &info) != 0)
+		return 0;
+
+	return (long long)info.st_mtime;
+}
+
+string ShaderWatcher::directoryOf(const string& path)
+{
+	size_t slash = path.find_last_of("/\\");
+	return slash == string::npos ? string(".") : path.substr(0, slash);
+}
+
+string ShaderWatcher::fileNameOf(const string& path)
+{
+	size_t slash = path.find_last_of("/\\");
+	return slash == string::npos ? path : path.substr(slash + 1);
+}
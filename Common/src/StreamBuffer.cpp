@@ -0,0 +1,147 @@
+#include "StreamBuffer.h"
+
+#include <chrono>
+#include <algorithm>
+
+StreamBuffer::StreamBuffer()
+	: buffer(0), frameSize(0), framesInFlight(0), frame(0), head(0), committed(0), requestedSize(0),
+	mapped(NULL), lastWaitMs(0.0), totalWaitMs(0.0)
+{
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	destroy();
+}
+
+void StreamBuffer::create(size_t frameSize, int framesInFlight)
+{
+	destroy();
+
+	this->frameSize = frameSize;
+	this->framesInFlight = framesInFlight;
+	frame = 0;
+	head = committed = 0;
+	fences.assign(framesInFlight, (GLsync)0);
+
+	size_t totalSize = frameSize * framesInFlight;
+
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+	if (GLExtensions::bufferStorage)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		GLExtensions::bufferStorage(GL_ARRAY_BUFFER, totalSize, NULL, flags);
+		mapped = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, totalSize, flags);
+	}
+
+	if (!mapped)
+	{
+		glBufferData(GL_ARRAY_BUFFER, totalSize, NULL, GL_STREAM_DRAW);
+		staging.resize(totalSize);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void StreamBuffer::destroy()
+{
+	if (buffer == 0)
+		return;
+
+	for (size_t i = 0; i < fences.size(); i++)
+	{
+		if (fences[i])
+		{
+			glClientWaitSync(fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+			glDeleteSync(fences[i]);
+		}
+	}
+	fences.clear();
+
+	if (mapped)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		mapped = NULL;
+	}
+
+	glDeleteBuffers(1, &buffer);
+	buffer = 0;
+	staging.clear();
+}
+
+void StreamBuffer::beginFrame()
+{
+	// Uma alocao no coube no quadro anterior: recria o buffer com regies maiores
+	if (requestedSize > frameSize)
+	{
+		size_t newSize = frameSize;
+		while (newSize < requestedSize)
+			newSize *= 2;
+
+		create(newSize, framesInFlight);
+		requestedSize = 0;
+	}
+
+	head = committed = 0;
+	lastWaitMs = 0.0;
+
+	GLsync& fence = fences[frame];
+
+	if (!fence)
+		return;
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	while (result == GL_TIMEOUT_EXPIRED)
+		result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+
+	lastWaitMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	totalWaitMs += lastWaitMs;
+
+	glDeleteSync(fence);
+	fence = 0;
+}
+
+void* StreamBuffer::allocate(size_t size, size_t alignment, size_t& offset)
+{
+	size_t start = regionStart();
+	size_t aligned = alignment > 1 ? ((start + head + alignment - 1) / alignment) * alignment - start : head;
+
+	if (aligned + size > frameSize)
+	{
+		requestedSize = max(requestedSize, (aligned + size) * 2);
+		return NULL;
+	}
+
+	head = aligned + size;
+	offset = start + aligned;
+
+	return mapped ? mapped + offset : &staging[offset];
+}
+
+void StreamBuffer::commit()
+{
+	if (mapped || head == committed)
+		return;
+
+	size_t start = regionStart();
+
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferSubData(GL_ARRAY_BUFFER, start + committed, head - committed, &staging[start + committed]);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	committed = head;
+}
+
+void StreamBuffer::endFrame()
+{
+	commit();
+
+	fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	frame = (frame + 1) % framesInFlight;
+}
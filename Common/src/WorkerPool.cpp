@@ -0,0 +1,101 @@
+#include "WorkerPool.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+WorkerPool::WorkerPool(int nbThreads) : task(NULL), nbTasks(0), next(0), generation(0), busy(0), stopping(false)
+{
+	if (nbThreads <= 0)
+		nbThreads = max(1, (int)thread::hardware_concurrency());
+
+	for (int i = 1; i < nbThreads; i++)
+		workers.push_back(thread(&WorkerPool::workerLoop, this));
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		lock_guard<mutex> lock(stateMutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (size_t w = 0; w < workers.size(); w++)
+		workers[w].join();
+}
+
+WorkerPool& WorkerPool::shared()
+{
+	static WorkerPool pool;
+	return pool;
+}
+
+void WorkerPool::run(int nbTasks, const function<void(int)>& task)
+{
+	if (nbTasks <= 0)
+		return;
+
+	// Sem threads de trabalho (ou com uma tarefa s) no h o que dividir
+	if (workers.empty() || nbTasks == 1)
+	{
+		for (int i = 0; i < nbTasks; i++)
+			task(i);
+		return;
+	}
+
+	lock_guard<mutex> running(runMutex);
+
+	{
+		lock_guard<mutex> lock(stateMutex);
+		this->task = &task;
+		this->nbTasks = nbTasks;
+		next = 0;
+		generation++;
+	}
+	wake.notify_all();
+
+	execute(task, nbTasks);
+
+	// Todas as tarefas j foram pegas; falta esperar as que ainda esto nas outras threads. S
+	// depois disso task volta a NULL, e uma thread que acorde atrasada no pega uma tarefa que j
+	// no existe
+	unique_lock<mutex> lock(stateMutex);
+	done.wait(lock, [this] { return busy == 0; });
+	this->task = NULL;
+}
+
+void WorkerPool::execute(const function<void(int)>& task, int nbTasks)
+{
+	for (int i = next.fetch_add(1); i < nbTasks; i = next.fetch_add(1))
+		task(i);
+}
+
+void WorkerPool::workerLoop()
+{
+	PROFILE_THREAD_NAME("WorkerPool");
+
+	uint64_t seen = 0;
+	unique_lock<mutex> lock(stateMutex);
+
+	while (true)
+	{
+		wake.wait(lock, [&] { return stopping || generation != seen; });
+		if (stopping)
+			return;
+
+		seen = generation;
+		if (!task)
+			continue;
+
+		const function<void(int)>* current = task;
+		int count = nbTasks;
+		busy++;
+
+		lock.unlock();
+		execute(*current, count);
+		lock.lock();
+
+		if (--busy == 0)
+			done.notify_all();
+	}
+}
@@ -16,14 +16,14 @@ using namespace std;
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 
 int setupShader();
-int setupGeometry();
+int setupGeometry(GLuint& instanceVBO);
 
 const GLuint WIDTH = 1000, HEIGHT = 1000;
 
 const GLchar* vertexShaderSource = "#version 450\n"
 "layout (location = 0) in vec3 position;\n"
 "layout (location = 1) in vec3 color;\n"
-"uniform mat4 model;\n"
+"layout (location = 2) in mat4 model;\n"
 "out vec4 finalColor;\n"
 "void main()\n"
 "{\n"
@@ -69,16 +69,14 @@ int main()
 
 	GLuint shaderID = setupShader();
 
-	GLuint VAO = setupGeometry();
-	GLuint VAO2 = setupGeometry();
+	// Um nico VAO para os dois cubos: a matriz model de cada um vem do buffer de instncias
+	GLuint instanceVBO;
+	GLuint VAO = setupGeometry(instanceVBO);
 
 	glUseProgram(shaderID);
 
 	glm::mat4 model = glm::mat4(1);
-	GLint modelLoc = glGetUniformLocation(shaderID, "model");
-
-	model = glm::rotate(model, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-	glUniformMatrix4fv(modelLoc, 1, FALSE, glm::value_ptr(model));
+	glm::mat4 models[2];
 
 	glEnable(GL_DEPTH_TEST);
 
@@ -114,19 +112,18 @@ int main()
 		model = glm::translate(model, glm::vec3(x, y, z));
 		model = glm::scale(model, glm::vec3(cubeSize, cubeSize, cubeSize));
 
-		glUniformMatrix4fv(modelLoc, 1, FALSE, glm::value_ptr(model));
-		
-		glBindVertexArray(VAO);
-		glDrawArrays(GL_TRIANGLES, 0, 36);
+		// A instncia 0  o segundo cubo, para que os pontos (1 instncia) saiam s nele
+		models[1] = model;
+		models[0] = glm::translate(model, glm::vec3(1.0, 1.0, 1.0));
 
-		model = glm::translate(model, glm::vec3(1.0, 1.0, 1.0));
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(models), models);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-		glUniformMatrix4fv(modelLoc, 1, FALSE, glm::value_ptr(model));
+		glBindVertexArray(VAO);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 36, 2);
 
-		glBindVertexArray(VAO2);
-		glDrawArrays(GL_TRIANGLES, 0, 36);
-		
-		glDrawArrays(GL_POINTS, 0, 36);
+		glDrawArraysInstanced(GL_POINTS, 0, 36, 1);
 		glBindVertexArray(0);
 
 		glfwSwapBuffers(window);
@@ -248,7 +245,7 @@ int setupShader()
 	return shaderProgram;
 }
 
-int setupGeometry()
+int setupGeometry(GLuint& instanceVBO)
 {
 	GLfloat vertices[] = {
 		//x    y    z    r    g    b
@@ -325,23 +322,20 @@ int setupGeometry()
 	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3*sizeof(GLfloat)));
 	glEnableVertexAttribArray(1);
 
-	GLuint VBO2, VAO2;
-
-	glGenBuffers(1, &VBO2);
-
-	glBindBuffer(GL_ARRAY_BUFFER, VBO2);
-
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	// Buffer de instncias: uma mat4 por cubo, nos atributos 2 a 5 (uma coluna em cada),
+	// avanando uma vez por instncia (divisor 1)
+	glGenBuffers(1, &instanceVBO);
 
-	glGenVertexArrays(1, &VAO2);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
 
-	glBindVertexArray(VAO2);
+	glBufferData(GL_ARRAY_BUFFER, 2 * sizeof(glm::mat4), NULL, GL_DYNAMIC_DRAW);
 
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)0);
-	glEnableVertexAttribArray(0);
-
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-	glEnableVertexAttribArray(1);
+	for (int c = 0; c < 4; c++)
+	{
+		glVertexAttribPointer(2 + c, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (GLvoid*)(c * sizeof(glm::vec4)));
+		glEnableVertexAttribArray(2 + c);
+		glVertexAttribDivisor(2 + c, 1);
+	}
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
@@ -4,6 +4,9 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cctype>
 
 using namespace std;
 
@@ -19,8 +22,44 @@ using namespace std;
 
 #include "Shader.h"
 
+#include "ShaderWatcher.h"
+
+#include "GLState.h"
+
+#include "RenderQueue.h"
+
+#include "StreamBuffer.h"
+
+#include "MeshPool.h"
+
+#include "IndirectBatch.h"
+
+#include "FrustumCuller.h"
+
+#include "BVH.h"
+
+#include "OcclusionCuller.h"
+
+#include "GPUCuller.h"
+
+#include "MeshletCuller.h"
+
+#include "Microbench.h"
+
+#include "HeadlessContext.h"
+
+#include "Benchmark.h"
+
+#include "GPUProfiler.h"
+
+#include "Profiler.h"
+
 #include "Bezier.h"
 
+#include "GPUCurve.h"
+
+#include "ControlPointFile.h"
+
 struct Vertex {
 	GLfloat x, y, z, r = 1.0, g = 1.0, b = 0.0;
 };
@@ -41,17 +80,26 @@ struct NormalProperties {
 	GLfloat ka = 0.2, ks = 0.5, q = 10.0;
 };
 
+// Bloco de uniforms "Camera" (std140), escrito a cada quadro no ring buffer
+struct CameraBlock {
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec4 cameraPos;
+};
+
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
+
 void getMtlProperties(string filename, NormalProperties& normalProperties);
 
 void readFromObjFile(string filename, vector<Vertex>& vertices, vector<Face>& faces, vector<Texture>& textures, vector<Normal>& normals);
 
 vector<float> readFromTxtFile(string filename);
 
-int loadTexture(string path);
+int loadTextureArray(vector<string> paths);
 
 string getTextureFile(string filename);
 
@@ -61,6 +109,8 @@ std::vector<glm::vec3> generateControlPointsSet();
 
 int setupGeometry(string filename, vector<Vertex>& vertices, vector<Face>& faces, vector<Texture>& textures, vector<Normal>& normals, vector<GLfloat>& finalVertices);
 
+bool formatFramePath(const string& pattern, int frame, string& path);
+
 const GLuint WIDTH = 1000, HEIGHT = 1000;
 
 bool rotateX=false, rotateY=false, rotateZ=false;
@@ -81,32 +131,167 @@ float lastX, lastY;
 float sensitivity = 0.05;
 float xRotation = 0.0, yRotation = -90.0;
 
-int main()
+// Tecla I alterna entre desenho instanciado e um draw call por objeto
+bool instancingEnabled = true;
+
+// Tecla M alterna entre o glMultiDrawElementsIndirect (MeshPool) e a RenderQueue
+bool multiDrawEnabled = true;
+
+// Tecla C liga/desliga o descarte por frustum; tecla B alterna entre a BVH e o teste por objeto
+bool cullingEnabled = true;
+bool bvhEnabled = true;
+
+// Tecla O liga/desliga o descarte por ocluso (rasterizador na CPU)
+bool occlusionEnabled = true;
+
+// Tecla G passa o descarte (frustum e Hi-Z) para um compute shader
+bool gpuCullingEnabled = false;
+
+// Tecla K desenha a suzanne por meshlets, descartando os fora do frustum ou de costas (multi draw)
+bool meshletCullingEnabled = true;
+
+// Tecla P liga/desliga o profiler de GPU por trecho; ao desligar, imprime as mdias
+bool gpuProfilerEnabled = false;
+
+// Tecla L desenha a trajetria da suzanne, avaliada no vertex shader a partir dos pontos de controle
+bool pathEnabled = false;
+
+// Tecla T alterna a trajetria entre amostras fixas e tesselao na GPU (densidade pelo tamanho na tela)
+bool pathTessellation = false;
+
+// Clique esquerdo seleciona o objeto no centro da tela (raio a partir da cmera)
+bool pickRequested = false;
+
+int main(int argc, char** argv)
 {
-	glfwInit();
+	// --stress N adiciona N cubos  cena para medir o desempenho do desenho instanciado; --render-queue
+	// desenha pela RenderQueue em vez do multi draw indireto (tecla M) e --no-instancing faz um draw
+	// call por objeto (tecla I), para comparar com o instanciado; no multi draw indireto,
+	// --no-instancing troca a chamada nica por um draw por malha
+	// --distinct faz cada cubo do teste de carga ser uma malha diferente no MeshPool
+	// --microbench NOME executa um benchmark s de CPU (sem abrir a janela) e termina
+	// --gpu-culling faz o descarte por frustum e ocluso na GPU desde o incio (tecla G); --no-culling
+	// desenha todos os objetos (tecla C), a referncia para medir o custo do descarte
+	// --gpu-profile ARQUIVO liga o profiler de GPU desde o incio e grava as mdias em JSON ao sair
+	// --path desenha a trajetria da suzanne desde o incio (tecla L); --path-tessellation, com o
+	// backend de tesselao (tecla T)
+	// --trace ARQUIVO grava as zonas de CPU (inicializao e cada fase dos quadros) no formato do
+	// Chrome trace (chrome://tracing ou ui.perfetto.dev)
+	// --headless N desenha N quadros num framebuffer offscreen, sem janela (EGL/OSMesa), e termina
+	// --dump PADRAO grava cada quadro do modo headless (ex.: quadros/%04d.png; .ppm tambm serve)
+	// --benchmark N mede N quadros com passo fixo e a cmera num caminho fixo, depois de --warmup M
+	// quadros (60 por padro), e grava o relatrio em --report ARQUIVO (benchmark.json); com
+	// --headless, o nmero de quadros  o do benchmark
+	int stressObjects = 0;
+	bool distinctMeshes = false;
+	int headlessFrames = 0;
+	string dumpPattern;
+	int benchmarkFrames = 0, warmupFrames = 60;
+	string reportPath = "benchmark.json";
+	string gpuProfilePath;
+	string tracePath;
+
+	for (int a = 1; a < argc; a++)
+	{
+		if (string(argv[a]) == "--stress" && a + 1 < argc)
+			stressObjects = atoi(argv[++a]);
+		else if (string(argv[a]) == "--distinct")
+			distinctMeshes = true;
+		else if (string(argv[a]) == "--render-queue")
+			multiDrawEnabled = false;
+		else if (string(argv[a]) == "--no-instancing")
+			instancingEnabled = false;
+		else if (string(argv[a]) == "--microbench" && a + 1 < argc)
+			return Microbench::run(argv[a + 1]) ? 0 : 1;
+		else if (string(argv[a]) == "--headless" && a + 1 < argc)
+			headlessFrames = max(1, atoi(argv[++a]));
+		else if (string(argv[a]) == "--dump" && a + 1 < argc)
+			dumpPattern = argv[++a];
+		else if (string(argv[a]) == "--benchmark" && a + 1 < argc)
+			benchmarkFrames = max(1, atoi(argv[++a]));
+		else if (string(argv[a]) == "--warmup" && a + 1 < argc)
+			warmupFrames = max(0, atoi(argv[++a]));
+		else if (string(argv[a]) == "--report" && a + 1 < argc)
+			reportPath = argv[++a];
+		else if (string(argv[a]) == "--gpu-profile" && a + 1 < argc)
+		{
+			gpuProfilePath = argv[++a];
+			gpuProfilerEnabled = true;
+		}
+		else if (string(argv[a]) == "--trace" && a + 1 < argc)
+			tracePath = argv[++a];
+		else if (string(argv[a]) == "--gpu-culling")
+			gpuCullingEnabled = true;
+		else if (string(argv[a]) == "--no-culling")
+			cullingEnabled = false;
+		else if (string(argv[a]) == "--path")
+			pathEnabled = true;
+		else if (string(argv[a]) == "--path-tessellation")
+			pathEnabled = pathTessellation = true;
+	}
 
-	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "Trabalho Final", nullptr, nullptr);
-	glfwMakeContextCurrent(window);
+	// O padro de --dump no vai para o snprintf: um %s ou duas converses leriam argumentos que no existem
+	string dumpPath;
+	if (!dumpPattern.empty() && !formatFramePath(dumpPattern, 0, dumpPath))
+	{
+		cout << "--dump: o padrao precisa de exatamente um %d (ex.: quadros/%04d.png), e % sozinho se escreve %%" << endl;
+		return 1;
+	}
 
-	glfwSetKeyCallback(window, key_callback);
-	glfwSetCursorPosCallback(window, mouse_callback);
+	Profiler::setEnabled(!tracePath.empty());
+	PROFILE_ZONE_NAMED(startupZone, "inicializacao");
 
-	glfwSetCursorPos(window, WIDTH / 2, HEIGHT / 2);
+	bool benchmarking = benchmarkFrames > 0;
+	bool fixedTimestep = benchmarking || headlessFrames > 0;
 
-	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+	// No modo headless o contexto  criado sem janela; se no der (por exemplo, fora do Linux),
+	// uma janela invisvel da GLFW fornece o contexto e o desenho vai para o mesmo framebuffer offscreen
+	HeadlessContext headless;
+	GLFWwindow* window = nullptr;
 
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	if (headlessFrames == 0 || !headless.create(WIDTH, HEIGHT))
 	{
-		std::cout << "Failed to initialize GLAD" << std::endl;
+		glfwInit();
+
+		if (headlessFrames > 0)
+			glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+		window = glfwCreateWindow(WIDTH, HEIGHT, "Trabalho Final", nullptr, nullptr);
+		glfwMakeContextCurrent(window);
+
+		glfwSetKeyCallback(window, key_callback);
+		glfwSetCursorPosCallback(window, mouse_callback);
+		glfwSetMouseButtonCallback(window, mouse_button_callback);
+
+		glfwSetCursorPos(window, WIDTH / 2, HEIGHT / 2);
+
+		glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+		if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+		{
+			std::cout << "Failed to initialize GLAD" << std::endl;
+		}
+
+		GLExtensions::load();
+
+		if (headlessFrames > 0 && !headless.createFramebuffer(WIDTH, HEIGHT))
+			return 1;
 	}
+	else
+		GLExtensions::load((GLADloadproc)HeadlessContext::getProcAddress);
+
+	if (headlessFrames > 0)
+		cout << "Modo headless (" << (headless.getBackend().empty() ? "janela invisivel" : headless.getBackend()) << "): "
+			<< headlessFrames << " quadros" << (dumpPattern.empty() ? "" : ", gravados em " + dumpPattern) << endl;
 
 	const GLubyte* renderer = glGetString(GL_RENDERER);
 	const GLubyte* version = glGetString(GL_VERSION);
 	cout << "Renderer: " << renderer << endl;
 	cout << "OpenGL version supported " << version << endl;
 
-	int width, height;
-	glfwGetFramebufferSize(window, &width, &height);
+	int width = WIDTH, height = HEIGHT;
+	if (window)
+		glfwGetFramebufferSize(window, &width, &height);
 	glViewport(0, 0, width, height);
 
 	Shader shader("../shaders/sprite.vs", "../shaders/sprite.fs");
@@ -114,64 +299,283 @@ int main()
 	GLuint VAO = setupGeometry("../files/suzanne.obj", vertices1, faces1, textures1, normals1, finalVertices1);
 	GLuint VAO2 = setupGeometry("../files/cube.obj", vertices2, faces2, textures2, normals2, finalVertices2);
 
-	GLuint texID = loadTexture(getTextureFile("../files/suzanne.mtl"));
-	GLuint texID2 = loadTexture(getTextureFile("../files/cube.mtl"));
+	// As duas texturas tm o mesmo tamanho: camada 0 = suzanne, camada 1 = cubo
+	vector<string> texturePaths;
+	texturePaths.push_back(getTextureFile("../files/suzanne.mtl"));
+	texturePaths.push_back(getTextureFile("../files/cube.mtl"));
+	GLuint texArray = loadTextureArray(texturePaths);
+	const int layer1 = 0, layer2 = 1;
+
+	glm::mat4 model = glm::mat4(1);
+
+	NormalProperties normalProperties1, normalProperties2;
+
+	getMtlProperties("../files/suzanne.mtl", normalProperties1);
+	getMtlProperties("../files/cube.mtl", normalProperties2);
+
+	// Cada objeto submete um pacote por quadro; a fila ordena e evita trocas de estado repetidas
+	RenderQueue renderQueue;
+
+	Material material1, material2;
+	material1.ka = normalProperties1.ka;
+	material1.ks = normalProperties1.ks;
+	material1.q = normalProperties1.q;
+	material2.ka = normalProperties2.ka;
+	material2.ks = normalProperties2.ks;
+	material2.q = normalProperties2.q;
+
+	int materialID1 = renderQueue.addMaterial(material1);
+	int materialID2 = renderQueue.addMaterial(material2);
+
+	// Uniforms que s so enviados uma vez; reenviados a cada recarga do shader
+	auto setupShaderUniforms = [&](Shader* s)
+	{
+		s->Use();
+
+		glUniform1i(glGetUniformLocation(s->ID, "tex_buffer"), 0);
+
+		glUniformBlockBinding(s->ID, glGetUniformBlockIndex(s->ID, "Camera"), 0);
 
-	glUseProgram(shader.ID);
+		s->setVec3("lightPos", -2.0, 10.0, 2.0);
+		s->setVec3("lightColor", 1.0, 1.0, 0.8);
 
-	glUniform1i(glGetUniformLocation(shader.ID, "tex_buffer"), 0);
+		RenderQueue::uploadMaterials(glGetUniformLocation(s->ID, "materials"), renderQueue.getMaterials());
+	};
 
-	glm::mat4 view = glm::lookAt(glm::vec3(0.0, 0.0, 3.0), glm::vec3(0.0, 0.0, 0.0), glm::vec3(0.0, 1.0, 0.0));
-	shader.setMat4("view", value_ptr(view));
+	setupShaderUniforms(&shader);
+
+	GLState::enable(GL_DEPTH_TEST);
 
 	glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)width / (float)height, 0.1f, 100.0f);
-	shader.setMat4("projection", glm::value_ptr(projection));
 
-	glEnable(GL_DEPTH_TEST);
+	// Dados por quadro (cmera e instncias) vo num ring buffer com 3 quadros em voo
+	StreamBuffer frameData;
+	frameData.create(4 * 1024 * 1024, 3);
 
-	glm::mat4 model = glm::mat4(1);
-	GLint modelLoc = glGetUniformLocation(shader.ID, "model");
+	GLint uniformAlignment;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
 
-	model = glm::rotate(model, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-	glUniformMatrix4fv(modelLoc, 1, FALSE, glm::value_ptr(model));
+	cout << "Ring buffer " << (frameData.isPersistent() ? "persistente" : "com glBufferSubData (sem OpenGL 4.4)") << endl;
 
-	glEnable(GL_DEPTH_TEST);
+	// Recarrega os shaders ao salvar os arquivos, sem reiniciar a aplicao
+	ShaderWatcher shaderWatcher;
+	shaderWatcher.watch(&shader, "../shaders/sprite.vs", "../shaders/sprite.fs", setupShaderUniforms);
+	shaderWatcher.start();
 
-	NormalProperties normalProperties1, normalProperties2;
+	renderQueue.enableInstancing(VAO);
+	renderQueue.enableInstancing(VAO2);
+	renderQueue.setStreamBuffer(&frameData);
+	renderQueue.setTextureTarget(GL_TEXTURE_2D_ARRAY);
 
-	getMtlProperties("../files/suzanne.mtl", normalProperties1);
-	getMtlProperties("../files/cube.mtl", normalProperties2);
+	// Grade de cubos para o teste de carga
+	vector<glm::mat4> stressModels;
+	int side = (int)ceil(cbrt((double)stressObjects));
+
+	for (int s = 0; s < stressObjects; s++)
+	{
+		glm::vec3 position((s % side) - side / 2.0f, ((s / side) % side) - side / 2.0f, -(float)(s / (side * side)) - 5.0f);
+		stressModels.push_back(glm::scale(glm::translate(glm::mat4(1), position * 0.5f), glm::vec3(0.1f)));
+	}
+
+	// Todas as malhas num s conjunto de buffers, para desenhar a cena com um nico draw call
+	MeshPool meshPool;
+	int mesh1 = meshPool.addMesh(finalVertices1, true);
+	int mesh2 = meshPool.addMesh(finalVertices2);
+
+	vector<int> stressMeshes(stressObjects, mesh2);
+	if (distinctMeshes)
+		for (int s = 0; s < stressObjects; s++)
+			stressMeshes[s] = meshPool.addMesh(finalVertices2);
+
+	meshPool.upload();
+
+	IndirectBatch indirectBatch;
+	indirectBatch.setStreamBuffer(&frameData);
+
+	FrustumCuller frustumCuller;
+	MeshletCuller meshletCuller;
+	vector<int> visibleMeshlets;
+	int shownVisible = -1, shownCulled = -1;
+
+	// O cubo no se move
+	glm::mat4 model2 = glm::mat4(1);
+	model2 = glm::translate(model2, glm::vec3(0.0f, -1.0f, -3.0f));
+	model2 = glm::rotate(model2, glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	model2 = glm::rotate(model2, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+	model2 = glm::scale(model2, glm::vec3(0.8f, 0.8f, 0.8f));
+
+	// BVH sobre os objetos da cena (0 = suzanne, 1 = cubo, 2 em diante = teste de carga); s a
+	// suzanne se move, e a cada quadro apenas a folha dela e os ancestrais so reajustados
+	vector<AABB> objectBoxes;
+	objectBoxes.push_back(meshPool.getMesh(mesh1).bounds.box);
+	objectBoxes.push_back(meshPool.getMesh(mesh2).bounds.box.transformed(model2));
+	for (int s = 0; s < stressObjects; s++)
+		objectBoxes.push_back(meshPool.getMesh(stressMeshes[s]).bounds.box.transformed(stressModels[s]));
+
+	BVH sceneBVH;
+	sceneBVH.build(objectBoxes);
+
+	vector<int> bvhVisible, nearSuzanne;
+	vector<unsigned char> visibleFlags(objectBoxes.size(), 1);
+
+	cout << "BVH: " << sceneBVH.getNbNodes() << " nos, profundidade " << sceneBVH.getDepth() << endl;
+
+	// O cubo e a suzanne so os oclusores; os objetos que sobram do frustum so testados contra eles
+	OcclusionCuller occlusionCuller;
+	const MeshRange& occluder1 = meshPool.getMesh(mesh1);
+	const MeshRange& occluder2 = meshPool.getMesh(mesh2);
+	int nbOccluded = 0;
+
+	// Os mesmos objetos num SSBO, para o descarte na GPU (OpenGL 4.3)
+	GPUCuller gpuCuller;
+	bool gpuCullingReady = GPUCuller::isSupported() && gpuCuller.create("../shaders/cull.cs", meshPool);
+
+	if (gpuCullingReady)
+	{
+		gpuCuller.addObject(mesh1, glm::mat4(1), materialID1, layer1);
+		gpuCuller.addObject(mesh2, model2, materialID2, layer2);
+		for (int s = 0; s < stressObjects; s++)
+			gpuCuller.addObject(stressMeshes[s], stressModels[s], materialID2, layer2);
+		gpuCuller.upload();
+	}
+
+	cout << "Descarte na GPU " << (gpuCullingReady ? (gpuCuller.isCompacting() ? "com glMultiDrawElementsIndirectCount" : "com um comando por objeto")
+		: "indisponivel (sem OpenGL 4.3)") << endl;
+
+	cout << "Descarte por frustum com " << FrustumCuller::getSimdWidth() << " objetos por teste" << endl;
+
+	cout << "MeshPool: " << meshPool.getNbMeshes() << " malhas, " << meshPool.getNbVertices() << " vertices, "
+		<< meshPool.getNbIndices() << " indices, " << meshPool.getMesh(mesh1).meshletCount << " meshlets na suzanne" << endl;
+	cout << "Multi draw indirect " << (IndirectBatch::isMultiDrawSupported() ? "disponivel" : "indisponivel (sem OpenGL 4.3)") << endl;
+
+	if (stressObjects > 0 || benchmarking)
+	{
+		// Sem vsync, para que o tempo de quadro reflita o custo do desenho
+		if (window)
+			glfwSwapInterval(0);
+	}
 
-	shader.setVec3("lightPos", -2.0, 10.0, 2.0);
-	shader.setVec3("lightColor", 1.0, 1.0, 0.8);
+	if (stressObjects > 0)
+	{
+		cout << "Teste de carga com " << stressObjects << (distinctMeshes ? " malhas distintas" : " cubos")
+			<< " (tecla M alterna multi draw/RenderQueue, tecla I alterna um draw por malha/instanciamento)" << endl;
+	}
+
+	// Relgio para as estatsticas (a GLFW no  inicializada no modo headless)
+	auto now = []() { return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count(); };
+	double statsStart = now(), runStart = now();
+	int frame = 0;
+	int statsFrames = 0;
 
 	std::vector<glm::vec3> controlPoints = generateControlPointsSet();
 	
 	Bezier bezier;
 	bezier.setControlPoints(controlPoints);
 	bezier.setShader(&shader);
-	bezier.generateCurve(1000);
+	// A curva no  desenhada: a animao usa s os coeficientes e a tabela de comprimento de arco
+	bezier.buildArcLengthTable();
+
+	// A suzanne percorre a curva com velocidade constante, uma volta a cada 30 s, independente da
+	// taxa de quadros e do nmero de pontos por segmento
+	const float suzanneSpeed = bezier.getLength() / 30.0f;
 
 	cout << controlPoints.size() << endl;
 
-	int nbCurvePoints = bezier.getNbCurvePoints();
-	int i = 0;
+	// A trajetria  desenhada na GPU: s os pontos de controle so enviados e as amostras por
+	// segmento so um uniform
+	GPUCurve gpuPath;
+	bool gpuPathReady = gpuPath.create("../shaders/curve.vs", "../shaders/curve.fs");
+	if (gpuPathReady)
+	{
+		gpuPath.upload(bezier);
+		gpuPath.setViewport(width, height);
+		gpuPath.setLineWidth(10.0f);
+		cout << "Trajetoria na GPU: " << gpuPath.getNbSegments() << " segmentos, " << gpuPath.getUploadedBytes()
+			<< " bytes enviados (tecla L)" << endl;
+
+		bool tessellationReady = gpuPath.createTessellation("../shaders/curve_patch.vs", "../shaders/curve.tcs", "../shaders/curve.tes",
+			"../shaders/curve.gs", "../shaders/curve.fs");
+		cout << "Trajetoria por tesselacao " << (tessellationReady ? "disponivel (tecla T)" : "indisponivel (sem OpenGL 4.0)") << endl;
+	}
+
+	GPUProfiler gpuProfiler;
+
+	// Benchmark: a cmera percorre uma Bezier ao redor da cena, sempre olhando para o centro dela
+	Benchmark benchmark(warmupFrames, benchmarkFrames);
+	Bezier cameraPath;
+	const glm::vec3 cameraTarget(0.0f, -0.5f, -3.0f);
 
-	while (!glfwWindowShouldClose(window))
+	if (benchmarking)
 	{
-		glfwPollEvents();
+		vector<glm::vec3> pathPoints;
+		pathPoints.push_back(glm::vec3(0.0f, 0.0f, 3.0f));
+		pathPoints.push_back(glm::vec3(3.0f, 0.5f, 2.0f));
+		pathPoints.push_back(glm::vec3(4.0f, 1.0f, -1.0f));
+		pathPoints.push_back(glm::vec3(2.0f, 1.5f, -5.0f));
+		pathPoints.push_back(glm::vec3(0.0f, 2.0f, -9.0f));
+		pathPoints.push_back(glm::vec3(-4.0f, 1.0f, -6.0f));
+		pathPoints.push_back(glm::vec3(-3.0f, 0.0f, 0.0f));
+
+		cameraPath.setControlPoints(pathPoints);
+
+		benchmark.setConfig("scene", "Trabalho Final");
+		benchmark.setConfig("renderer", (const char*)renderer);
+		benchmark.setConfig("version", (const char*)version);
+		benchmark.setConfig("width", width);
+		benchmark.setConfig("height", height);
+		benchmark.setConfig("stress_objects", stressObjects);
+		benchmark.setConfig("headless", headlessFrames > 0 ? headless.getBackend().empty() ? "janela invisivel" : headless.getBackend() : "nao");
+		if (multiDrawEnabled)
+			benchmark.setConfig("path", instancingEnabled ? "multi draw indirect" : "um draw por malha");
+		else
+			benchmark.setConfig("path", instancingEnabled ? "RenderQueue instanciada" : "RenderQueue por objeto");
+		benchmark.setConfig("culling", !cullingEnabled ? "nao" : gpuCullingEnabled && gpuCullingReady ? "GPU" : bvhEnabled ? "BVH" : "por objeto");
+
+		cout << "Benchmark: " << warmupFrames << " quadros de aquecimento e " << benchmarkFrames << " medidos" << endl;
+	}
+
+	PROFILE_ZONE_END(startupZone);
+
+	while (benchmarking ? !benchmark.isDone() && (!window || !glfwWindowShouldClose(window))
+		: headlessFrames > 0 ? frame < headlessFrames : !glfwWindowShouldClose(window))
+	{
+		PROFILE_ZONE("quadro");
+
+		PROFILE_ZONE_NAMED(inputZone, "eventos e recarga de shaders");
+		if (window)
+			glfwPollEvents();
+
+		if (benchmarking)
+			benchmark.beginFrame();
+
+		shaderWatcher.update();
+		PROFILE_ZONE_END(inputZone);
+
+		PROFILE_ZONE_NAMED(waitZone, "espera do ring buffer");
+		frameData.beginFrame();
+		PROFILE_ZONE_END(waitZone);
 
+		PROFILE_ZONE_NAMED(cameraZone, "animacao e camera");
+
+		if (gpuProfiler.isEnabled() && !gpuProfilerEnabled)
+			gpuProfiler.print();
+		gpuProfiler.setEnabled(gpuProfilerEnabled);
+		gpuProfiler.beginFrame();
+
+		gpuProfiler.begin("limpeza");
 		glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		gpuProfiler.end();
 
-		glLineWidth(10);
-		glPointSize(20);
+		GLState::lineWidth(10);
+		GLState::pointSize(20);
 
-		float angle = (GLfloat)glfwGetTime();
+		// Nos modos headless e benchmark o tempo avana 1/60 s por quadro, para que os quadros se repitam
+		float angle = fixedTimestep ? frame / 60.0f : (GLfloat)glfwGetTime();
 
 		model = glm::mat4(1); 
 
-		glm::vec3 pointOnCurve = bezier.getPointOnCurve(i);
+		glm::vec3 pointOnCurve = bezier.pointAtTime(angle, suzanneSpeed);
 
 		model = glm::translate(model, pointOnCurve);
 
@@ -191,62 +595,376 @@ int main()
 
 		}
 
+		if (benchmarking)
+		{
+			cameraPos = cameraPath.evaluate(benchmark.getProgress() * cameraPath.getNbSegments());
+			cameraFront = glm::normalize(cameraTarget - cameraPos);
+		}
+
 		//Atualizando a posio e orientao da cmera
 		glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-		shader.setMat4("view", glm::value_ptr(view));
 
 		//Atualizando o shader com a posio da cmera
-		shader.setVec3("cameraPos", cameraPos.x, cameraPos.y, cameraPos.z);
+		size_t cameraOffset;
+		CameraBlock* camera = (CameraBlock*)frameData.allocate(sizeof(CameraBlock), uniformAlignment, cameraOffset);
+		if (camera)
+		{
+			camera->view = view;
+			camera->projection = projection;
+			camera->cameraPos = glm::vec4(cameraPos, 1.0f);
+			frameData.commit();
+			glBindBufferRange(GL_UNIFORM_BUFFER, 0, frameData.getBuffer(), cameraOffset, sizeof(CameraBlock));
+		}
 
 		model = glm::scale(model, glm::vec3(0.5f, 0.5f, 0.5f));
 
-		// obj 1
-		glUniformMatrix4fv(modelLoc, 1, FALSE, glm::value_ptr(model));
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texID);
+		objectBoxes[0] = meshPool.getMesh(mesh1).bounds.box.transformed(model);
+		sceneBVH.update(0, objectBoxes[0]);
 
-		glBindVertexArray(VAO);
+		PROFILE_ZONE_END(cameraZone);
 
-		shader.setFloat("ka", normalProperties1.ka);
-		shader.setFloat("kd", 0.2);
-		shader.setFloat("ks", normalProperties1.ks);
-		shader.setFloat("q", normalProperties1.q);
+		// Descarte por frustum: pela BVH ou testando cada objeto (SIMD)
+		PROFILE_ZONE_NAMED(frustumZone, "descarte por frustum");
+		frustumCuller.setFrustum(projection * view);
+		int nbObjects = objectBoxes.size(), nbVisible = nbObjects;
+		bool gpuCulling = cullingEnabled && gpuCullingEnabled && gpuCullingReady;
 
-		glDrawArrays(GL_TRIANGLES, 0, finalVertices1.size());
+		if (gpuCulling)
+		{
+			// A suzanne  o nico objeto que se move
+			gpuCuller.updateObject(0, model);
+		}
+		else if (cullingEnabled && bvhEnabled)
+		{
+			bvhVisible.clear();
+			sceneBVH.queryFrustum(frustumCuller.getPlanes(), bvhVisible);
 
-		// obj 2
-		model = glm::mat4(1);
-		model = glm::translate(model, glm::vec3(0.0f, -1.0f, -3.0f));
-		model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-		model = glm::scale(model, glm::vec3(0.8f, 0.8f, 0.8f));
+			visibleFlags.assign(nbObjects, 0);
+			for (size_t v = 0; v < bvhVisible.size(); v++)
+				visibleFlags[bvhVisible[v]] = 1;
 
-		glUniformMatrix4fv(modelLoc, 1, FALSE, glm::value_ptr(model));
+			nbVisible = bvhVisible.size();
+		}
+		else if (cullingEnabled)
+		{
+			frustumCuller.begin();
+			frustumCuller.add(meshPool.getMesh(mesh1).bounds, model);
+			frustumCuller.add(meshPool.getMesh(mesh2).bounds, model2);
 
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texID2);
+			for (size_t s = 0; s < stressModels.size(); s++)
+				frustumCuller.add(meshPool.getMesh(stressMeshes[s]).bounds, stressModels[s]);
 
-		glBindVertexArray(VAO2);
+			frustumCuller.cull();
 
-		shader.setFloat("ka", normalProperties2.ka);
-		shader.setFloat("kd", 0.2);
-		shader.setFloat("ks", normalProperties2.ks);
-		shader.setFloat("q", normalProperties2.q);
+			for (int o = 0; o < nbObjects; o++)
+				visibleFlags[o] = frustumCuller.isVisible(o);
 
-		glDrawArrays(GL_TRIANGLES, 0, finalVertices2.size());
-		
-		glBindVertexArray(0);
+			nbVisible = frustumCuller.getNbVisible();
+		}
+
+		PROFILE_ZONE_END(frustumZone);
 
-		i = (i + 1) % nbCurvePoints;
+		nbOccluded = 0;
 
-		glfwSwapBuffers(window);
+		if (cullingEnabled && occlusionEnabled)
+		{
+			PROFILE_ZONE("descarte por oclusao");
+
+			const vector<GLfloat>& poolVertices = meshPool.getVertices();
+			const vector<GLuint>& poolIndices = meshPool.getIndices();
+
+			occlusionCuller.setViewProjection(projection * view);
+			occlusionCuller.begin();
+			occlusionCuller.addOccluder(&poolVertices[occluder1.baseVertex * MeshPool::FLOATS_PER_VERTEX], MeshPool::FLOATS_PER_VERTEX,
+				&poolIndices[occluder1.firstIndex], occluder1.indexCount, model);
+			occlusionCuller.addOccluder(&poolVertices[occluder2.baseVertex * MeshPool::FLOATS_PER_VERTEX], MeshPool::FLOATS_PER_VERTEX,
+				&poolIndices[occluder2.firstIndex], occluder2.indexCount, model2);
+			occlusionCuller.render();
+
+			if (gpuCulling)
+			{
+				GPUProfiler::Scope scope(gpuProfiler, "envio do Hi-Z");
+				gpuCuller.setHiZ(occlusionCuller);
+			}
+			else
+			{
+				nbOccluded = occlusionCuller.test(objectBoxes, visibleFlags);
+				nbVisible -= nbOccluded;
+			}
+		}
+
+		auto isVisible = [&](int object) { return !cullingEnabled || visibleFlags[object] != 0; };
+
+		int nbCulled = nbObjects - nbVisible;
+
+		if (pickRequested)
+		{
+			PROFILE_ZONE("selecao");
+
+			float distance;
+			int picked = sceneBVH.raycast(cameraPos, cameraFront, 100.0f, distance);
+
+			if (picked < 0)
+				cout << "Nenhum objeto selecionado" << endl;
+			else
+				cout << "Objeto selecionado: " << (picked == 0 ? "suzanne" : picked == 1 ? "cubo" : "cubo de carga " + to_string(picked - 2))
+					<< " a " << distance << endl;
+
+			pickRequested = false;
+		}
+
+		if (window && gpuCulling && shownVisible != -2)
+		{
+			// As contagens ficam na GPU; l-las a cada quadro faria a CPU esperar
+			glfwSetWindowTitle(window, "Trabalho Final - descarte na GPU");
+			shownVisible = shownCulled = -2;
+		}
+		else if (window && !gpuCulling && (nbVisible != shownVisible || nbCulled != shownCulled))
+		{
+			string title = "Trabalho Final - visiveis: " + to_string(nbVisible) + ", descartados: " + to_string(nbCulled);
+			glfwSetWindowTitle(window, title.c_str());
+			shownVisible = nbVisible;
+			shownCulled = nbCulled;
+		}
+
+		PROFILE_ZONE_NAMED(drawZone, "desenho");
+		int nbSubmitted, drawCalls;
+		long long nbTriangles = -1;
+
+		if (gpuCulling)
+		{
+			gpuCuller.setOcclusion(occlusionEnabled);
+			gpuProfiler.begin("descarte (compute)");
+			gpuCuller.cull(projection * view, frustumCuller.getPlanes());
+			gpuProfiler.end();
+
+			shader.Use();
+			GLState::bindTextureUnit(0, GL_TEXTURE_2D_ARRAY, texArray);
+
+			// Todos os objetos saem de um nico draw indireto: no h como separ-los por grupo
+			gpuProfiler.begin("cena");
+			gpuCuller.draw();
+			gpuProfiler.end();
+
+			nbSubmitted = -1;
+			drawCalls = 1;
+		}
+		else if (multiDrawEnabled)
+		{
+			shader.Use();
+			GLState::bindTextureUnit(0, GL_TEXTURE_2D_ARRAY, texArray);
+
+			indirectBatch.setMultiDraw(instancingEnabled);
+			indirectBatch.begin();
+
+			nbSubmitted = drawCalls = 0;
+			nbTriangles = 0;
+
+			// Com o profiler de GPU ligado cada grupo de objetos vira um multi draw prprio, para
+			// que o tempo de cada um seja medido separadamente (custa dois draw calls a mais)
+			bool splitGroups = gpuProfiler.isEnabled();
+			auto drawBatch = [&](const string& group)
+			{
+				GPUProfiler::Scope scope(gpuProfiler, group);
+				indirectBatch.draw(meshPool);
+
+				nbSubmitted += indirectBatch.getNbInstances();
+				drawCalls += indirectBatch.getDrawCalls();
+				nbTriangles += indirectBatch.getNbTriangles();
+				indirectBatch.begin();
+			};
+
+			if (isVisible(0) && meshletCullingEnabled)
+			{
+				meshletCuller.setFrustum(frustumCuller.getPlanes());
+				meshletCuller.setCameraPosition(cameraPos);
+
+				visibleMeshlets.clear();
+				meshletCuller.cull(meshPool, mesh1, model, visibleMeshlets);
+				indirectBatch.addMeshlets(mesh1, model, materialID1, layer1, visibleMeshlets);
+			}
+			else if (isVisible(0))
+				indirectBatch.add(mesh1, model, materialID1, layer1);
+			if (splitGroups)
+				drawBatch("suzanne");
+
+			if (isVisible(1))
+				indirectBatch.add(mesh2, model2, materialID2, layer2);
+			if (splitGroups)
+				drawBatch("cubo");
+
+			for (size_t s = 0; s < stressModels.size(); s++)
+				if (isVisible(2 + s))
+					indirectBatch.add(stressMeshes[s], stressModels[s], materialID2, layer2);
+
+			drawBatch(splitGroups ? "cubos de carga" : "cena");
+		}
+		else
+		{
+			renderQueue.begin(view);
+
+			// obj 1
+			DrawPacket packet;
+			packet.program = shader.ID;
+			packet.vao = VAO;
+			packet.texture = texArray;
+			packet.material = materialID1;
+			packet.layer = layer1;
+			packet.count = finalVertices1.size() / 11;
+			packet.model = model;
+			if (isVisible(0))
+				renderQueue.submit(packet);
+
+			// obj 2
+			packet.vao = VAO2;
+			packet.material = materialID2;
+			packet.layer = layer2;
+			packet.count = finalVertices2.size() / 11;
+			packet.model = model2;
+			if (isVisible(1))
+				renderQueue.submit(packet);
+
+			for (size_t s = 0; s < stressModels.size(); s++)
+			{
+				packet.model = stressModels[s];
+				if (isVisible(2 + s))
+					renderQueue.submit(packet);
+			}
+
+			renderQueue.setBatching(instancingEnabled);
+			renderQueue.sort();
+			gpuProfiler.begin("cena");
+			renderQueue.execute();
+			gpuProfiler.end();
+
+			nbSubmitted = renderQueue.getNbPackets();
+			drawCalls = renderQueue.getDrawCalls();
+			nbTriangles = renderQueue.getNbTriangles();
+		}
+
+		if (pathEnabled && gpuPathReady)
+		{
+			gpuPath.setBackend(pathTessellation ? GPUCurve::TESSELLATION : GPUCurve::VERTEX_PULLING);
+			gpuProfiler.begin("trajetoria");
+			gpuPath.draw(glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
+			gpuProfiler.end();
+		}
+
+		PROFILE_ZONE_END(drawZone);
+
+		statsFrames++;
+		if (stressObjects > 0 && statsFrames == 120)
+		{
+			PROFILE_ZONE("estatisticas");
+
+			double elapsed = now() - statsStart;
+			string path = gpuCulling ? "descarte na GPU" : multiDrawEnabled ? (indirectBatch.getMultiDraw() ? "multi draw indirect" : "um draw por malha")
+				: (instancingEnabled ? "instanciado" : "por objeto");
+
+			if (gpuCulling)
+			{
+				nbSubmitted = gpuCuller.readVisibleCount();
+				nbCulled = nbObjects - nbSubmitted;
+			}
+
+			// Consulta de proximidade: objetos a menos de uma unidade da suzanne
+			nearSuzanne.clear();
+			sceneBVH.querySphere(glm::vec3(model[3]), 1.0f, nearSuzanne);
+			int nbNear = count_if(nearSuzanne.begin(), nearSuzanne.end(), [](int object) { return object != 0; });
+
+			cout << path << ": " << nbSubmitted << " objetos desenhados, " << nbCulled << " descartados ("
+				<< (gpuCulling ? "compute shader" : bvhEnabled ? "BVH" : "por objeto") << ", " << nbOccluded << " ocultos, raster "
+				<< occlusionCuller.getLastRasterMs() << " ms), " << nbNear << " perto da suzanne, "
+				<< drawCalls << " draw calls, " << (elapsed * 1000.0 / statsFrames) << " ms/quadro, "
+				<< (frameData.getTotalWaitMs() / statsFrames) << " ms/quadro esperando fences" << endl;
+
+			if (multiDrawEnabled && meshletCullingEnabled && meshletCuller.getNbMeshlets() > 0)
+				cout << "  meshlets da suzanne: " << meshletCuller.getFrustumCulled() << " fora do frustum, " << meshletCuller.getConeCulled()
+					<< " de costas de " << meshletCuller.getNbMeshlets() << " (" << (100.0 * meshletCuller.getRejectionRate())
+					<< "% dos triangulos descartados)" << endl;
+
+			if (gpuProfiler.isEnabled())
+				gpuProfiler.print();
+
+			meshletCuller.resetStats();
+			frameData.resetWaitTime();
+			statsStart = now();
+			statsFrames = 0;
+		}
+
+		PROFILE_ZONE("fim do quadro");
+		gpuProfiler.endFrame();
+		frameData.endFrame();
+
+		// Com descarte na GPU os tringulos desenhados no so conhecidos na CPU
+		if (benchmarking)
+			benchmark.endFrame(drawCalls, nbTriangles);
+
+		if (headlessFrames > 0)
+		{
+			headless.finishFrame();
+
+			if (!dumpPattern.empty())
+			{
+				formatFramePath(dumpPattern, frame, dumpPath);
+				headless.saveFrame(dumpPath);
+			}
+		}
+		else
+			glfwSwapBuffers(window);
+
+		frame++;
+	}
+
+	if (benchmarking)
+	{
+		benchmark.finish();
+		benchmark.print();
+		if (benchmark.writeJSON(reportPath))
+			cout << "Relatorio do benchmark gravado em " << reportPath << endl;
 	}
 
+	if (gpuProfiler.isEnabled())
+	{
+		gpuProfiler.print();
+		if (!gpuProfilePath.empty() && gpuProfiler.writeJSON(gpuProfilePath))
+			cout << "Tempos de GPU por trecho gravados em " << gpuProfilePath << endl;
+	}
+
+	if (!tracePath.empty())
+	{
+#ifndef PROFILER_ENABLED
+		cout << "Compilado sem PROFILER_ENABLED: o trace nao tera zonas" << endl;
+#endif
+		if (Profiler::writeChromeTrace(tracePath))
+			cout << "Trace de CPU (" << Profiler::getNbEvents() << " zonas, " << Profiler::getNbDropped()
+				<< " perdidas) gravado em " << tracePath << endl;
+	}
+
+	if (headlessFrames > 0)
+	{
+		double elapsed = now() - runStart;
+		cout << "Modo headless: " << frame << " quadros em " << (elapsed * 1000.0) << " ms ("
+			<< (elapsed * 1000.0 / frame) << " ms/quadro)" << endl;
+	}
+
+	GLState::printStats();
+
 	glDeleteVertexArrays(1, &VAO);
 	glDeleteVertexArrays(1, &VAO2);
 
+	shaderWatcher.stop();
+
+	frameData.destroy();
+
+	gpuCuller.destroy();
 
-	glfwTerminate();
+	gpuPath.destroy();
+
+	headless.destroy();
+
+	if (window)
+		glfwTerminate();
 	return 0;
 }
 
@@ -276,6 +994,56 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 		rotateZ = true;
 	}
 
+	if (key == GLFW_KEY_I && action == GLFW_PRESS)
+	{
+		instancingEnabled = !instancingEnabled;
+	}
+
+	if (key == GLFW_KEY_M && action == GLFW_PRESS)
+	{
+		multiDrawEnabled = !multiDrawEnabled;
+	}
+
+	if (key == GLFW_KEY_C && action == GLFW_PRESS)
+	{
+		cullingEnabled = !cullingEnabled;
+	}
+
+	if (key == GLFW_KEY_B && action == GLFW_PRESS)
+	{
+		bvhEnabled = !bvhEnabled;
+	}
+
+	if (key == GLFW_KEY_O && action == GLFW_PRESS)
+	{
+		occlusionEnabled = !occlusionEnabled;
+	}
+
+	if (key == GLFW_KEY_G && action == GLFW_PRESS)
+	{
+		gpuCullingEnabled = !gpuCullingEnabled;
+	}
+
+	if (key == GLFW_KEY_K && action == GLFW_PRESS)
+	{
+		meshletCullingEnabled = !meshletCullingEnabled;
+	}
+
+	if (key == GLFW_KEY_P && action == GLFW_PRESS)
+	{
+		gpuProfilerEnabled = !gpuProfilerEnabled;
+	}
+
+	if (key == GLFW_KEY_L && action == GLFW_PRESS)
+	{
+		pathEnabled = !pathEnabled;
+	}
+
+	if (key == GLFW_KEY_T && action == GLFW_PRESS)
+	{
+		pathTessellation = !pathTessellation;
+	}
+
 	float cameraSpeed = 0.05;
 
 	if (key == GLFW_KEY_W && action == GLFW_REPEAT)
@@ -297,6 +1065,12 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 	}
 }
 
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
+{
+	if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
+		pickRequested = true;
+}
+
 void mouse_callback(GLFWwindow* window, double xpos, double ypos)
 {
 	if (firstMouse)
@@ -325,44 +1099,102 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos)
 	cameraFront = glm::normalize(front);
 }
 
-int loadTexture(string path)
+// Carrega as imagens como camadas de um GL_TEXTURE_2D_ARRAY (todas precisam ter o tamanho da primeira)
+// Troca o nico %d (com largura opcional, ex.: %04d) do padro pelo nmero do quadro e %% por %;
+// qualquer outra converso, ou nenhum ou mais de um %d, torna o padro invlido
+bool formatFramePath(const string& pattern, int frame, string& path)
+{
+	path.clear();
+	int conversions = 0;
+
+	for (size_t i = 0; i < pattern.size(); i++)
+	{
+		if (pattern[i] != '%')
+		{
+			path += pattern[i];
+			continue;
+		}
+
+		if (i + 1 < pattern.size() && pattern[i + 1] == '%')
+		{
+			path += '%';
+			i++;
+			continue;
+		}
+
+		size_t end = i + 1;
+		bool zeros = end < pattern.size() && pattern[end] == '0';
+		if (zeros)
+			end++;
+
+		int width = 0;
+		while (end < pattern.size() && isdigit((unsigned char)pattern[end]) && width < 100)
+			width = width * 10 + (pattern[end++] - '0');
+
+		if (end >= pattern.size() || pattern[end] != 'd' || width >= 100)
+			return false;
+
+		string number = to_string(frame);
+		if ((int)number.size() < width)
+			number.insert(0, width - number.size(), zeros ? '0' : ' ');
+
+		path += number;
+		conversions++;
+		i = end;
+	}
+
+	return conversions == 1;
+}
+
+int loadTextureArray(vector<string> paths)
 {
+	PROFILE_FUNCTION();
+
 	GLuint texID;
 
 	glGenTextures(1, &texID);
-	glBindTexture(GL_TEXTURE_2D, texID);
+	GLState::bindTexture(GL_TEXTURE_2D_ARRAY, texID);
 
 	//Ajusta os parmetros de wrapping e filtering
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-	//Carregamento da imagem
-	int width, height, nrChannels;
-	unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
+	int arrayWidth = 0, arrayHeight = 0;
 
-	if (data)
+	for (size_t layer = 0; layer < paths.size(); layer++)
 	{
-		if (nrChannels == 3) //jpg, bmp
+		//Carregamento da imagem (sempre em RGBA, para todas as camadas terem o mesmo formato)
+		int width, height, nrChannels;
+		unsigned char* data = stbi_load(paths[layer].c_str(), &width, &height, &nrChannels, 4);
+
+		if (!data)
 		{
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+			std::cout << "Failed to load texture " << paths[layer] << std::endl;
+			continue;
 		}
-		else //png
+
+		if (arrayWidth == 0)
 		{
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+			arrayWidth = width;
+			arrayHeight = height;
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, width, height, paths.size(), 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
 		}
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture" << std::endl;
+
+		if (width == arrayWidth && height == arrayHeight)
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		else
+			std::cout << "Textura com tamanho diferente das demais camadas: " << paths[layer] << std::endl;
+
+		stbi_image_free(data);
 	}
 
-	stbi_image_free(data);
+	if (arrayWidth > 0)
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLState::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
 
 	return texID;
 }
@@ -424,6 +1256,8 @@ void getMtlProperties(string filename, NormalProperties& normalProperties)
 
 void readFromObjFile(string filename, vector<Vertex>& vertices, vector<Face>& faces, vector<Texture>& textures, vector<Normal>& normals)
 {
+	PROFILE_FUNCTION();
+
 	string line;
 
 	ifstream file(filename);
@@ -539,6 +1373,8 @@ void setVertexPosition(vector<GLfloat>& finalVertices, int vertexPosition, int t
 }
 
 void buildVertices(vector<Vertex>& vertices, vector<Face>& faces, vector<Texture>& textures, vector<Normal>& normals, vector<GLfloat>& finalVertices) {
+	PROFILE_FUNCTION();
+
 	for (size_t i = 0; i < faces.size(); i++) {
 		int v1Position = stoi(faces[i].v1) - 1;
 		int t1Position = stoi(faces[i].t1) - 1;
@@ -560,6 +1396,16 @@ void buildVertices(vector<Vertex>& vertices, vector<Face>& faces, vector<Texture
 
 std::vector<glm::vec3> generateControlPointsSet()
 {
+	// O texto  convertido para o formato binrio na primeira execuo (e quando for editado); o
+	// binrio  mapeado e copiado sem parse. Se no der para grav-lo, l o texto como antes
+	ControlPointFile file;
+	if (ControlPointFile::importIfNewer("../files/curvePoints.txt", "../files/curvePoints.cpb") && file.open("../files/curvePoints.cpb"))
+	{
+		vector<glm::vec3> curvePoints;
+		file.readAll(curvePoints);
+		return curvePoints;
+	}
+
 	vector<float> points = readFromTxtFile("../files/curvePoints.txt");
 
 	vector <glm::vec3> curvePoints;
@@ -579,6 +1425,8 @@ std::vector<glm::vec3> generateControlPointsSet()
 
 int setupGeometry(string filename, vector<Vertex>& vertices, vector<Face>& faces, vector<Texture>& textures, vector<Normal>& normals, vector<GLfloat>& finalVertices)
 {
+	PROFILE_FUNCTION();
+
 	readFromObjFile(filename, vertices, faces, textures, normals);
 	
 	buildVertices(vertices, faces, textures, normals, finalVertices);
@@ -593,7 +1441,7 @@ int setupGeometry(string filename, vector<Vertex>& vertices, vector<Face>& faces
 
 	glGenVertexArrays(1, &VAO);
 
-	glBindVertexArray(VAO);
+	GLState::bindVertexArray(VAO);
 	
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)0);
 	glEnableVertexAttribArray(0);
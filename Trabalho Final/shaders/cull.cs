@@ -0,0 +1,153 @@
+#version 430
+
+// Descarte na GPU (ver GPUCuller): uma invocação por objeto. Os objetos visíveis têm os dados de
+// instância copiados e um comando de desenho escrito; o contador atômico guarda quantos passaram.
+
+layout (local_size_x = 64) in;
+
+struct Object
+{
+    mat4 model;
+    vec4 params;     // material, camada da textura, malha
+    vec4 sphere;     // centro e raio no espaço do mundo
+    vec4 boxMin;
+    vec4 boxMax;
+};
+
+struct Mesh
+{
+    uint indexCount;
+    uint firstIndex;
+    int baseVertex;
+    uint padding;
+};
+
+struct Instance
+{
+    mat4 model;
+    vec4 params;
+};
+
+struct Command
+{
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout (std430, binding = 0) readonly buffer Objects { Object objects[]; };
+layout (std430, binding = 1) readonly buffer Meshes { Mesh meshes[]; };
+layout (std430, binding = 2) writeonly buffer Instances { Instance instances[]; };
+layout (std430, binding = 3) writeonly buffer Commands { Command commands[]; };
+
+layout (binding = 0, offset = 0) uniform atomic_uint visibleCount;
+
+uniform uint nbObjects;
+uniform vec4 planes[6];
+uniform mat4 viewProjection;
+
+// Com compact os visíveis são compactados no início (a contagem vem do contador atômico);
+// sem ele cada objeto tem um comando fixo, com instanceCount 0 quando descartado
+uniform bool compact;
+
+// Pirâmide Hi-Z (profundidade mais distante de cada região, nível 0 = largura x altura)
+uniform bool occlusion;
+uniform sampler2D hiZ;
+uniform int hiZLevels;
+uniform ivec2 hiZSize;
+
+bool insideFrustum(Object o)
+{
+    vec3 center = (o.boxMin.xyz + o.boxMax.xyz) * 0.5;
+    vec3 extents = (o.boxMax.xyz - o.boxMin.xyz) * 0.5;
+
+    for (int p = 0; p < 6; p++)
+    {
+        if (dot(planes[p].xyz, o.sphere.xyz) + planes[p].w < -o.sphere.w)
+            return false;
+        if (dot(planes[p].xyz, center) + planes[p].w + dot(abs(planes[p].xyz), extents) < 0.0)
+            return false;
+    }
+
+    return true;
+}
+
+bool occluded(Object o)
+{
+    vec2 minScreen = vec2(1e30), maxScreen = vec2(-1e30);
+    float minZ = 1e30;
+
+    for (int corner = 0; corner < 8; corner++)
+    {
+        vec3 p = vec3((corner & 1) != 0 ? o.boxMax.x : o.boxMin.x,
+                      (corner & 2) != 0 ? o.boxMax.y : o.boxMin.y,
+                      (corner & 4) != 0 ? o.boxMax.z : o.boxMin.z);
+        vec4 clip = viewProjection * vec4(p, 1.0);
+
+        // Cruza o plano próximo: não há como garantir que está oculto
+        if (clip.w < 1e-5)
+            return false;
+
+        vec3 ndc = clip.xyz / clip.w * 0.5 + 0.5;
+        vec2 screen = ndc.xy * vec2(hiZSize);
+        minScreen = min(minScreen, screen);
+        maxScreen = max(maxScreen, screen);
+        minZ = min(minZ, ndc.z);
+    }
+
+    ivec2 r0 = max(ivec2(0), ivec2(floor(minScreen)));
+    ivec2 r1 = min(hiZSize - 1, ivec2(floor(maxScreen)));
+
+    if (r0.x > r1.x || r0.y > r1.y)
+        return false;
+
+    // Nível em que o retângulo cobre no máximo 2x2 texels
+    int level = 0;
+    while (level + 1 < hiZLevels && ((r1.x >> level) - (r0.x >> level) > 1 || (r1.y >> level) - (r0.y >> level) > 1))
+        level++;
+
+    // Tamanho do nível calculado aqui, e não com textureSize: com nível diferente entre invocações
+    // o llvmpipe devolve o tamanho do nível de uma só delas
+    ivec2 size = max(ivec2(1), hiZSize >> level);
+    ivec2 t0 = min(size - 1, r0 >> level), t1 = min(size - 1, r1 >> level);
+
+    for (int y = t0.y; y <= t1.y; y++)
+        for (int x = t0.x; x <= t1.x; x++)
+            if (texelFetch(hiZ, ivec2(x, y), level).r >= minZ)
+                return false;
+
+    return true;
+}
+
+void main()
+{
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= nbObjects)
+        return;
+
+    Object o = objects[id];
+    bool visible = insideFrustum(o) && !(occlusion && occluded(o));
+
+    Mesh mesh = meshes[uint(o.params.z)];
+    uint slot = id;
+
+    if (visible)
+    {
+        uint index = atomicCounterIncrement(visibleCount);
+        if (compact)
+            slot = index;
+    }
+    else if (compact)
+        return;
+
+    instances[slot].model = o.model;
+    instances[slot].params = vec4(o.params.xy, 0.0, 0.0);
+
+    commands[slot].count = mesh.indexCount;
+    commands[slot].instanceCount = visible ? 1u : 0u;
+    commands[slot].firstIndex = mesh.firstIndex;
+    commands[slot].baseVertex = mesh.baseVertex;
+    commands[slot].baseInstance = slot;
+}
@@ -0,0 +1,10 @@
+#version 450
+
+uniform vec4 color;
+
+out vec4 fragColor;
+
+void main()
+{
+    fragColor = color;
+}
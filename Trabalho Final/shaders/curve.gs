@@ -0,0 +1,33 @@
+#version 450
+
+// Transforma cada trecho das isolinhas num quadrilátero com lineWidth pixels de espessura (no
+// perfil core glLineWidth maior que 1 é ignorado); a normal de cada ponta vem da derivada exata,
+// então trechos vizinhos se encontram sem fendas
+
+layout (lines) in;
+layout (triangle_strip, max_vertices = 4) out;
+
+uniform float lineWidth;
+uniform vec2 viewport;
+
+in vec4 clipTangent[];
+
+void main()
+{
+    for (int i = 0; i < 2; i++)
+    {
+        vec4 clip = gl_in[i].gl_Position;
+
+        // Derivada da posição na tela (regra do quociente da divisão por w), em pixels
+        vec2 screenTangent = (clipTangent[i].xy * clip.w - clip.xy * clipTangent[i].w) * viewport;
+        vec2 normal = length(screenTangent) > 1e-12 ? normalize(vec2(-screenTangent.y, screenTangent.x)) : vec2(0.0, 1.0);
+        vec2 offset = normal * lineWidth / viewport * clip.w;
+
+        gl_Position = vec4(clip.xy - offset, clip.zw);
+        EmitVertex();
+        gl_Position = vec4(clip.xy + offset, clip.zw);
+        EmitVertex();
+    }
+
+    EndPrimitive();
+}
@@ -0,0 +1,49 @@
+#version 450
+
+// Vertex pulling (ver GPUCurve): sem atributos; a instância é o segmento e gl_VertexID dá a
+// amostra (v / 2) e o lado da curva (v % 2)
+
+// Escrito a cada quadro no ring buffer (ver CameraBlock)
+layout (std140) uniform Camera
+{
+    mat4 view;
+    mat4 projection;
+    vec4 cameraPos;
+};
+
+// Pontos de controle (GL_RGB32F); o segmento i usa os pontos 3i a 3i + 3
+uniform samplerBuffer controlPoints;
+// Leva os 4 pontos de controle aos coeficientes de (t^3, t^2, t, 1)
+uniform mat4 basis;
+uniform int samplesPerSegment;
+// Espessura e viewport em pixels
+uniform float lineWidth;
+uniform vec2 viewport;
+
+void main()
+{
+    int first = 3 * gl_InstanceID;
+    mat4x3 P = mat4x3(texelFetch(controlPoints, first).xyz,
+                      texelFetch(controlPoints, first + 1).xyz,
+                      texelFetch(controlPoints, first + 2).xyz,
+                      texelFetch(controlPoints, first + 3).xyz);
+    mat4x3 C = P * basis;
+
+    float t = float(gl_VertexID / 2) / float(samplesPerSegment);
+    vec3 position = C * vec4(t * t * t, t * t, t, 1.0);
+    vec3 tangent = C * vec4(3.0 * t * t, 2.0 * t, 1.0, 0.0);
+
+    mat4 viewProjection = projection * view;
+    vec4 clip = viewProjection * vec4(position, 1.0);
+    vec4 clipTangent = viewProjection * vec4(tangent, 0.0);
+
+    // Derivada da posição na tela (regra do quociente da divisão por w), em pixels
+    vec2 screenTangent = (clipTangent.xy * clip.w - clip.xy * clipTangent.w) * viewport;
+    vec2 normal = length(screenTangent) > 1e-12 ? normalize(vec2(-screenTangent.y, screenTangent.x)) : vec2(0.0, 1.0);
+
+    // Meia espessura para cada lado: em NDC, lineWidth / viewport; multiplicado por w no espaço de recorte
+    float side = (gl_VertexID & 1) == 0 ? -1.0 : 1.0;
+    clip.xy += side * normal * lineWidth / viewport * clip.w;
+
+    gl_Position = clip;
+}
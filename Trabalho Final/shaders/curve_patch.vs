@@ -0,0 +1,14 @@
+#version 450
+
+// Tesselação (ver GPUCurve): cada patch tem os 4 pontos de controle de um segmento, buscados no
+// texture buffer; o vértice v é o ponto 3 (v / 4) + v % 4
+
+uniform samplerBuffer controlPoints;
+
+out vec3 worldPosition;
+
+void main()
+{
+    int segment = gl_VertexID / 4;
+    worldPosition = texelFetch(controlPoints, 3 * segment + gl_VertexID % 4).xyz;
+}
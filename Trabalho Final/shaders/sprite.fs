@@ -4,27 +4,34 @@ in vec3 outColor;
 in vec2 outTextureCoordinate;
 in vec3 outPosition;
 in vec3 outNormal;
+flat in vec4 outMaterial;
+flat in float outLayer;
 
 out vec4 color;
 
-//Propriedades da superficie
-uniform float ka;
-uniform float kd;
-uniform float ks;
-uniform float q;
-
 //Propriedades da fonte de luz
 uniform vec3 lightPos;
 uniform vec3 lightColor;
 
-// pixels da textura
-uniform sampler2D tex_buffer;
+// pixels das texturas (uma camada por objeto)
+uniform sampler2DArray tex_buffer;
 
 //Posição da Camera
-uniform vec3 cameraPos;
+layout (std140) uniform Camera
+{
+    mat4 view;
+    mat4 projection;
+    vec4 cameraPos;
+};
 
 void main()
 {
+    //Propriedades da superficie (por instância)
+    float ka = outMaterial.x;
+    float kd = outMaterial.y;
+    float ks = outMaterial.z;
+    float q = outMaterial.w;
+
     //Cálculo da parcela de iluminação ambiente
 	vec3 ambient = ka * lightColor;
 
@@ -35,13 +42,13 @@ void main()
 	vec3 diffuse = kd * diff * lightColor;
 
 	//Cálculo da parcela de iluminação especular
-	vec3 V = normalize(cameraPos - outPosition);
+	vec3 V = normalize(cameraPos.xyz - outPosition);
 	vec3 R = normalize(reflect(-L,N));
 	float spec = max(dot(R,V),0.0);
 	spec = pow(spec,q);
 	vec3 specular = ks * spec * lightColor;
 
-	vec3 textureColor = texture(tex_buffer, outTextureCoordinate).xyz;
+	vec3 textureColor = texture(tex_buffer, vec3(outTextureCoordinate, outLayer)).xyz;
 
 	vec3 result = (ambient + diffuse) * textureColor + specular;
 
@@ -5,20 +5,35 @@ layout (location = 1) in vec3 color;
 layout (location = 2) in vec2 tex_coord;
 layout (location = 3) in vec3 normal;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Dados por instância (ver InstanceData): matriz model e (material, camada da textura)
+layout (location = 4) in mat4 instanceModel;
+layout (location = 8) in vec2 instanceParams;
+
+// Escrito a cada quadro no ring buffer (ver CameraBlock)
+layout (std140) uniform Camera
+{
+    mat4 view;
+    mat4 projection;
+    vec4 cameraPos;
+};
+
+// ka, kd, ks, q de cada material
+uniform vec4 materials[16];
 
 out vec3 outColor;
 out vec2 outTextureCoordinate;
 out vec3 outPosition;
 out vec3 outNormal;
+flat out vec4 outMaterial;
+flat out float outLayer;
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(position, 1.0);;
+    gl_Position = projection * view * instanceModel * vec4(position, 1.0);
     outColor = color;
     outTextureCoordinate = vec2(tex_coord.x, 1 - tex_coord.y);
     outNormal = normal;
-    outPosition = vec3(model * vec4(position, 1.0));
+    outPosition = vec3(instanceModel * vec4(position, 1.0));
+    outMaterial = materials[int(instanceParams.x)];
+    outLayer = instanceParams.y;
 }
\ No newline at end of file